@@ -1,10 +1,11 @@
 #include "audio_engine.h"
 #include "eq.h"
+#include <switch.h>
 
 bool AudioEngine::init(int sampleRate, int ch) {
     channels = ch;
-    readPos.store(0);
-    writePos.store(0);
+    ring.init((size_t)sampleRate * channels * BUFFER_MS / 1000);
+    tapData.assign(TAP_FRAMES * channels, 0.0f);
     SDL_AudioSpec want{};
     want.freq = sampleRate;
     want.format = AUDIO_F32SYS;
@@ -16,6 +17,8 @@ bool AudioEngine::init(int sampleRate, int ch) {
     SDL_AudioSpec have{};
     device = SDL_OpenAudioDevice(nullptr, 0, &want, &have, 0);
     if (!device) return false;
+    this->sampleRate = have.freq;
+    deviceTicks = (uint64_t)have.samples * 19200000ULL / (uint64_t)have.freq;
     SDL_PauseAudioDevice(device, 0);
     g_equalizer.setSampleRate(static_cast<float>(have.freq));
 
@@ -38,16 +41,34 @@ void AudioEngine::shutdown() {
     }
 }
 
+// Called from the producer side while the device keeps running; the audio
+// lock makes the reset atomic with respect to the callback.
+void AudioEngine::clear() {
+    if (device) SDL_LockAudioDevice(device);
+    ring.clear();
+    probeRequest.store(0, std::memory_order_relaxed);
+    if (device) SDL_UnlockAudioDevice(device);
+}
+
+void AudioEngine::armLatencyProbe(uint64_t requestTicks) {
+    probeLatency.store(0, std::memory_order_relaxed);
+    probeRequest.store(requestTicks, std::memory_order_release);
+}
+
+bool AudioEngine::takeLatencyMs(double* ms) {
+    uint64_t ticks = probeLatency.exchange(0, std::memory_order_acq_rel);
+    if (!ticks) return false;
+    if (ms) *ms = ticks / 19200.0;
+    return true;
+}
+
 void AudioEngine::setPaused(bool p) {
     paused.store(p);
 }
 
 size_t AudioEngine::availableRead() const
 {
-
-    size_t r = readPos.load(std::memory_order_acquire);
-    size_t w = writePos.load(std::memory_order_acquire);
-    return w - r;
+    return ring.availableRead();
 }
 size_t AudioEngine::getBufferedSamples() const
 {
@@ -55,69 +76,117 @@ size_t AudioEngine::getBufferedSamples() const
 }
 size_t AudioEngine::availableWrite() const
 {
-    size_t r = readPos.load(std::memory_order_acquire);
-    size_t w = writePos.load(std::memory_order_acquire);
-    return BUFFER_SIZE - (w - r);
+    return ring.availableWrite();
 }
 
 void AudioEngine::pushPCM(const float* data, size_t samples)
 {
-    size_t r = readPos.load(std::memory_order_acquire);
-    size_t w = writePos.load(std::memory_order_relaxed);
-
-    size_t freeSpace = BUFFER_SIZE - (w - r);
-    if (samples > freeSpace)
-        samples = freeSpace; // safely drop excess
-
-    for (size_t i = 0; i < samples; ++i)
-        buffer[(w + i) % BUFFER_SIZE] = data[i];
-
-    writePos.store(w + samples, std::memory_order_release);
+    ring.write(data, samples); // excess beyond free space is dropped
 }
 
+// DSP (EQ, limiter, soft clip) already ran on the decode thread, so the
+// callback only copies out of the ring — at most two memcpy spans.
 void AudioEngine::audioCallback(void* userdata, Uint8* stream, int len) {
     auto* engine = static_cast<AudioEngine*>(userdata);
     float* out = reinterpret_cast<float*>(stream);
 
     const size_t samplesRequested = len / sizeof(float);
-    size_t samplesWritten = 0;
 
     if (engine->paused.load(std::memory_order_acquire)) {
         std::memset(stream, 0, len);
+        engine->tapWrite(out, samplesRequested);
         return;
     }
 
-    while (samplesWritten < samplesRequested) {
-        size_t r = engine->readPos.load(std::memory_order_relaxed);
-        size_t w = engine->writePos.load(std::memory_order_acquire);
-
-        size_t available = w - r;
-        if (available == 0) break;
+    size_t toCopy = engine->ring.read(out, samplesRequested);
 
-        size_t toCopy = std::min(available,
-                                 samplesRequested - samplesWritten);
-
-        for (size_t i = 0; i < toCopy; ++i) {
-            float sample =
-                engine->buffer[(r + i) % BUFFER_SIZE];
-
-            int channel = (samplesWritten + i) % engine->channels;
+    // First audio since a seek — it's audible once this buffer has played
+    if (toCopy > 0) {
+        uint64_t req = engine->probeRequest.load(std::memory_order_acquire);
+        if (req && engine->probeRequest.compare_exchange_strong(req, 0))
+            engine->probeLatency.store(svcGetSystemTick() - req + engine->deviceTicks,
+                                       std::memory_order_release);
+    }
 
-            sample = g_equalizer.processSample(sample, channel);
+    // Always fill remainder with silence
+    if (toCopy < samplesRequested) {
+        std::memset(out + toCopy, 0,
+                    (samplesRequested - toCopy) * sizeof(float));
+    }
 
-            // soft clip
-            sample = sample / (1.0f + fabsf(sample));
+    engine->tapWrite(out, samplesRequested);
+}
 
-            out[samplesWritten + i] = sample;
-        }
+/* -------------------------------------------------------
+   Analysis tap
+------------------------------------------------------- */
+// Audio thread: append this buffer to the history, then publish where
+// it ends and when. Wait-free — the reader validates instead of locking.
+void AudioEngine::tapWrite(const float* out, size_t samples)
+{
+    if (tapData.empty()) return;
+
+    uint64_t now    = svcGetSystemTick();
+    size_t   frames = std::min(samples / channels, TAP_FRAMES);
+    uint64_t end    = tapEnd.load(std::memory_order_relaxed);
+
+    size_t start = (size_t)(end & (TAP_FRAMES - 1));
+    size_t first = std::min(frames, TAP_FRAMES - start);
+    std::memcpy(&tapData[start * channels], out, first * channels * sizeof(float));
+    if (frames > first)
+        std::memcpy(&tapData[0], out + first * channels,
+                    (frames - first) * channels * sizeof(float));
+
+    uint32_t seq = tapSeq.load(std::memory_order_relaxed);
+    tapSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    tapEnd.store(end + frames, std::memory_order_relaxed);
+    tapTick.store(now, std::memory_order_relaxed);
+    tapBlock.store((uint32_t)frames, std::memory_order_relaxed);
+    tapSeq.store(seq + 2, std::memory_order_release);
+}
 
-        engine->readPos.store(r + toCopy, std::memory_order_release);
-        samplesWritten += toCopy;
+size_t AudioEngine::readAnalysisWindow(float* mono, size_t frames, uint64_t nowTicks) const
+{
+    if (tapData.empty() || frames == 0) return 0;
+    frames = std::min(frames, TAP_FRAMES / 2);
+
+    uint64_t end, tick;
+    uint32_t block;
+    for (;;)
+    {
+        uint32_t s1 = tapSeq.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        end   = tapEnd.load(std::memory_order_relaxed);
+        tick  = tapTick.load(std::memory_order_relaxed);
+        block = tapBlock.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tapSeq.load(std::memory_order_relaxed) == s1) break;
     }
-
-    // Always fill remainder with silence
-    if (samplesWritten < samplesRequested) {
-        std::memset(out + samplesWritten, 0,
-                    (samplesRequested - samplesWritten) * sizeof(float));
+    if (end < frames) return 0;
+
+    // The buffer written at `tick` starts playing one device buffer
+    // later (the same model as the latency probe); count forward from
+    // there at the output rate
+    double since = ((double)nowTicks - (double)tick - (double)deviceTicks) / 19200000.0;
+    double pos   = (double)(end - block) + since * sampleRate;
+    uint64_t audible = pos >= (double)end    ? end
+                     : pos <= (double)frames ? frames
+                     :                         (uint64_t)pos;
+
+    uint64_t first = audible - frames;
+    if (end - first > TAP_FRAMES) return 0;   // already gone
+
+    const float mix = 1.0f / channels;
+    for (size_t i = 0; i < frames; i++)
+    {
+        const float* f = &tapData[((first + i) & (TAP_FRAMES - 1)) * channels];
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) sum += f[c];
+        mono[i] = sum * mix;
     }
+
+    // Torn if the callback lapped the window while we copied
+    if (tapEnd.load(std::memory_order_acquire) - first > TAP_FRAMES) return 0;
+    return frames;
 }
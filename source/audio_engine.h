@@ -3,7 +3,10 @@
 #include <atomic>
 #include <cstddef>
 #include <cstring>
+#include <cstdint>
 #include <algorithm>
+#include <vector>
+#include "ring_buffer.h"
 
 
 // bool audioEngineInit(int sampleRate, int channels);
@@ -14,6 +17,9 @@ size_t audioEngineAvailable();
 
 bool audioEngineIsStarved();
 
+// The device is opened once at this rate; every decoder is resampled to it.
+#define AUDIO_OUTPUT_RATE 48000
+
 class AudioEngine {
 public:
     bool init(int sampleRate, int channels);
@@ -23,21 +29,53 @@ public:
     void stop();
 
     void pushPCM(const float* data, size_t samples);
+    void clear();               // drop everything queued (stop / track change / seek)
     void setPaused(bool p);
+    int  getSampleRate() const { return sampleRate; }
     size_t getBufferedSamples() const;
     size_t availableRead() const;
     size_t availableWrite() const;
 
+    // Seek latency probe. Arm it right after clear() with the tick the
+    // request was made at; the callback stamps the first buffer it plays
+    // after that, plus one device buffer of output delay. takeLatencyMs()
+    // hands the result to the decode thread once.
+    void armLatencyProbe(uint64_t requestTicks);
+    bool takeLatencyMs(double* ms);
+
+    // Analysis tap. The callback keeps a history of exactly what it
+    // handed the device (post-DSP, all channels, silence included) and
+    // publishes, per buffer, the running frame count and the tick it
+    // ran at. This returns the `frames` mono-mixed frames that end at
+    // what is audible at nowTicks, so a visualiser at any frame rate
+    // shows what is being heard. Lock-free on both sides; returns 0
+    // if nothing has played yet or the window was overwritten while
+    // being copied.
+    size_t readAnalysisWindow(float* mono, size_t frames, uint64_t nowTicks) const;
+
 private:
     static void audioCallback(void* userdata, Uint8* stream, int len);
 
-    static constexpr size_t BUFFER_SIZE = 44100 * 2; // ~1 sec stereo
-    float buffer[BUFFER_SIZE]{};
+    static constexpr int BUFFER_MS = 1000;   // ring length, rounded up to 2^n
+    RingBuffer<float> ring;                  // interleaved output samples
 
-    std::atomic<size_t> readPos{0};
-    std::atomic<size_t> writePos{0};
     std::atomic<bool> paused{false};
 
+    std::atomic<uint64_t> probeRequest{0};   // request tick, 0 = disarmed
+    std::atomic<uint64_t> probeLatency{0};   // ticks, 0 = nothing new
+    uint64_t deviceTicks = 0;                // one device buffer
+
+    static constexpr size_t TAP_FRAMES = 16384;   // history, 2^n, ~340 ms at 48 kHz
+    std::vector<float> tapData;                   // TAP_FRAMES * channels, interleaved
+    // Published by the callback under a sequence counter (odd = writing)
+    std::atomic<uint32_t> tapSeq{0};
+    std::atomic<uint64_t> tapEnd{0};         // frames written so far
+    std::atomic<uint64_t> tapTick{0};        // when the last buffer was written
+    std::atomic<uint32_t> tapBlock{0};       // frames in the last buffer
+
+    void tapWrite(const float* out, size_t samples);
+
     SDL_AudioDeviceID device = 0;
     int channels = 2;
+    int sampleRate = AUDIO_OUTPUT_RATE;
 };
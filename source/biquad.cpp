@@ -1,9 +1,20 @@
 #include "biquad.h"
+#include <algorithm>
+#include <string.h>
 
-void Biquad::setupPeaking(float sampleRate,
-                          float frequency,
-                          float q,
-                          float gainDB)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BIQUAD_NEON 1
+#elif defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define BIQUAD_SSE 1
+#endif
+
+void Biquad::computePeaking(float sampleRate,
+                            float frequency,
+                            float q,
+                            float gainDB,
+                            float out[5])
 {
     float A  = std::pow(10.0f, gainDB / 40.0f);
     float w0 = 2.0f * M_PI * frequency / sampleRate;
@@ -17,11 +28,25 @@ void Biquad::setupPeaking(float sampleRate,
     float a1_ = -2 * cosw0;
     float a2_ = 1 - alpha / A;
 
-    b0 = b0_ / a0_;
-    b1 = b1_ / a0_;
-    b2 = b2_ / a0_;
-    a1 = a1_ / a0_;
-    a2 = a2_ / a0_;
+    out[0] = b0_ / a0_;
+    out[1] = b1_ / a0_;
+    out[2] = b2_ / a0_;
+    out[3] = a1_ / a0_;
+    out[4] = a2_ / a0_;
+}
+
+void Biquad::setupPeaking(float sampleRate,
+                          float frequency,
+                          float q,
+                          float gainDB)
+{
+    float c[5];
+    computePeaking(sampleRate, frequency, q, gainDB, c);
+    b0 = c[0];
+    b1 = c[1];
+    b2 = c[2];
+    a1 = c[3];
+    a2 = c[4];
 }
 
 float Biquad::process(float in)
@@ -53,3 +78,134 @@ float Biquad::getMagnitude(float freq, float sampleRate) const
 
     return numMag / denMag;
 }
+
+/* ---------------------------------------------------- */
+/* STEREO FILTER BANK                                   */
+/* ---------------------------------------------------- */
+// Frames per inner pass: 256 stereo frames = 2 KB, so the block stays in L1
+// while every active band runs over it.
+static constexpr int BANK_CHUNK_FRAMES = 256;
+
+void BiquadBank::setBand(int band, float sampleRate, float frequency, float q, float gainDB)
+{
+    if (band < 0 || band >= MAX_BANDS)
+        return;
+
+    float c[5];
+    Biquad::computePeaking(sampleRate, frequency, q, gainDB, c);
+    for (int i = 0; i < 5; ++i)
+        coef[i][band] = c[i];
+
+    // A 0 dB peaking filter is an identity — leave it out of the cascade
+    // (same as the old per-sample path, state is kept for when it returns).
+    active[band] = (gainDB != 0.0f);
+}
+
+void BiquadBank::repack()
+{
+    activeCount = 0;
+    for (int band = 0; band < MAX_BANDS; ++band)
+    {
+        if (!active[band])
+            continue;
+        int j = activeCount++;
+        activeBand[j] = band;
+        b0[j] = coef[0][band];
+        b1[j] = coef[1][band];
+        b2[j] = coef[2][band];
+        a1[j] = coef[3][band];
+        a2[j] = coef[4][band];
+    }
+}
+
+void BiquadBank::reset()
+{
+    memset(z1, 0, sizeof(z1));
+    memset(z2, 0, sizeof(z2));
+}
+
+// Transposed direct form II, L and R in lanes 0/1:
+//   y  = b0*x + z1
+//   z1 = b1*x - a1*y + z2
+//   z2 = b2*x - a2*y
+void BiquadBank::processBlock(float* samples, int frames)
+{
+    if (activeCount == 0)
+        return;
+
+    for (int start = 0; start < frames; start += BANK_CHUNK_FRAMES)
+    {
+        const int n = std::min(BANK_CHUNK_FRAMES, frames - start);
+        float* s = samples + start * 2;
+
+        for (int j = 0; j < activeCount; ++j)
+        {
+            float* st1 = z1[activeBand[j]];
+            float* st2 = z2[activeBand[j]];
+#if defined(BIQUAD_NEON)
+            const float32x2_t vb0 = vdup_n_f32(b0[j]);
+            const float32x2_t vb1 = vdup_n_f32(b1[j]);
+            const float32x2_t vb2 = vdup_n_f32(b2[j]);
+            const float32x2_t va1 = vdup_n_f32(a1[j]);
+            const float32x2_t va2 = vdup_n_f32(a2[j]);
+            float32x2_t s1 = vld1_f32(st1);
+            float32x2_t s2 = vld1_f32(st2);
+
+            for (int f = 0; f < n; ++f)
+            {
+                float32x2_t x = vld1_f32(s + f * 2);
+                float32x2_t y = vfma_f32(s1, vb0, x);
+                s1 = vfms_f32(vfma_f32(s2, vb1, x), va1, y);
+                s2 = vfms_f32(vmul_f32(vb2, x), va2, y);
+                vst1_f32(s + f * 2, y);
+            }
+
+            vst1_f32(st1, s1);
+            vst1_f32(st2, s2);
+#elif defined(BIQUAD_SSE)
+            const __m128 vb0 = _mm_set1_ps(b0[j]);
+            const __m128 vb1 = _mm_set1_ps(b1[j]);
+            const __m128 vb2 = _mm_set1_ps(b2[j]);
+            const __m128 va1 = _mm_set1_ps(a1[j]);
+            const __m128 va2 = _mm_set1_ps(a2[j]);
+            const __m128 zero = _mm_setzero_ps();
+            __m128 s1 = _mm_loadl_pi(zero, (const __m64*)st1);
+            __m128 s2 = _mm_loadl_pi(zero, (const __m64*)st2);
+
+            for (int f = 0; f < n; ++f)
+            {
+                __m128 x = _mm_loadl_pi(zero, (const __m64*)(s + f * 2));
+                __m128 y = _mm_add_ps(_mm_mul_ps(vb0, x), s1);
+                s1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vb1, x), _mm_mul_ps(va1, y)), s2);
+                s2 = _mm_sub_ps(_mm_mul_ps(vb2, x), _mm_mul_ps(va2, y));
+                _mm_storel_pi((__m64*)(s + f * 2), y);
+            }
+
+            _mm_storel_pi((__m64*)st1, s1);
+            _mm_storel_pi((__m64*)st2, s2);
+#else
+            const float cb0 = b0[j], cb1 = b1[j], cb2 = b2[j];
+            const float ca1 = a1[j], ca2 = a2[j];
+            float l1 = st1[0], r1 = st1[1];
+            float l2 = st2[0], r2 = st2[1];
+
+            for (int f = 0; f < n; ++f)
+            {
+                float xl = s[f * 2];
+                float xr = s[f * 2 + 1];
+                float yl = cb0 * xl + l1;
+                float yr = cb0 * xr + r1;
+                l1 = cb1 * xl - ca1 * yl + l2;
+                r1 = cb1 * xr - ca1 * yr + r2;
+                l2 = cb2 * xl - ca2 * yl;
+                r2 = cb2 * xr - ca2 * yr;
+                s[f * 2]     = yl;
+                s[f * 2 + 1] = yr;
+            }
+
+            st1[0] = l1; st1[1] = r1;
+            st2[0] = l2; st2[1] = r2;
+#endif
+        }
+    }
+}
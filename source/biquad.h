@@ -12,6 +12,13 @@ public:
     float process(float in);
 
     float getMagnitude(float freq, float sampleRate) const;
+
+    // RBJ peaking EQ, normalised by a0: out = { b0, b1, b2, a1, a2 }
+    static void computePeaking(float sampleRate,
+                               float frequency,
+                               float q,
+                               float gainDB,
+                               float out[5]);
     
 private:
     float a0 = 1, a1 = 0, a2 = 0;
@@ -19,3 +26,39 @@ private:
 
     float z1 = 0, z2 = 0;
 };
+
+// Stereo cascade of peaking filters for the equalizer.
+// Coefficients are kept structure-of-arrays and left/right run together in
+// two SIMD lanes (NEON on Switch, SSE on x86 hosts, plain floats otherwise).
+// Flat (0 dB) bands are left out of the packed cascade, so the block loop
+// never branches per band. setBand() only stores coefficients; call repack()
+// once after a batch of them.
+class BiquadBank
+{
+public:
+    static constexpr int MAX_BANDS = 10;
+
+    void setBand(int band, float sampleRate, float frequency, float q, float gainDB);
+    void repack();                                 // rebuild the cascade after setBand()
+    void processBlock(float* samples, int frames); // interleaved stereo, in place
+    void reset();                                  // clear filter state
+
+private:
+
+    // Per-band coefficients, band order
+    float coef[5][MAX_BANDS] = {};  // b0, b1, b2, a1, a2
+    bool  active[MAX_BANDS]  = {};
+
+    // Packed cascade of active bands
+    int   activeCount = 0;
+    int   activeBand[MAX_BANDS] = {};
+    alignas(16) float b0[MAX_BANDS] = {};
+    alignas(16) float b1[MAX_BANDS] = {};
+    alignas(16) float b2[MAX_BANDS] = {};
+    alignas(16) float a1[MAX_BANDS] = {};
+    alignas(16) float a2[MAX_BANDS] = {};
+
+    // Filter state per band (band order), one lane each for L and R
+    alignas(16) float z1[MAX_BANDS][2] = {};
+    alignas(16) float z2[MAX_BANDS][2] = {};
+};
@@ -24,6 +24,14 @@ struct ScrubState
 
 static ScrubState g_scrub;
 
+// Also drops a touch scrub: its lift would otherwise seek from under
+// the overlay
+void controllerCancelScrub()
+{
+    g_scrub.active = false;
+    playerScrubCancel();
+}
+
 void controllerInit()
 {
     padConfigureInput(
@@ -112,11 +120,18 @@ void controllerHandlePlayerControls()
         g_scrub = { true, false, now };
     }
 
+    // The player drops a scrub when the track stops or changes; stop
+    // walking it then, rather than starting a new one on the next track
+    if (g_scrub.active && !(down & (HidNpadButton_R | HidNpadButton_L)) &&
+        !playerIsScrubbing())
+        g_scrub.active = false;
+
     if (g_scrub.active)
     {
         if ((up & HidNpadButton_R) || (up & HidNpadButton_L))
         {
             g_scrub.active = false;
+            playerScrubEnd();   // the one real seek
         }
         else
         {
@@ -127,13 +142,13 @@ void controllerHandlePlayerControls()
             if (heldSec > 2.0f)      step = 8.0f;
             else if (heldSec > 0.5f) step = 3.0f;
 
+            // While scrubbing this is the scrub target, so holding
+            // the button walks the target rather than the playhead
             float pos = playerGetPosition();
 
             pos += g_scrub.forward ? step : -step;
 
-            if (pos < 0.0f) pos = 0.0f;
-
-            playerSeek(pos);
+            playerScrubTo(pos);
         }
     }
 
@@ -7,3 +7,6 @@ void controllerUpdate();
 PadState* controllerGetPad();
 
 void controllerHandlePlayerControls();
+
+// An overlay took input: forget any L/R scrub in progress
+void controllerCancelScrub();
@@ -3,11 +3,20 @@
 #include "ui.h"
 #include "settings.h"
 #include "settings_state.h"
+#include "spectrum.h"
 #include <algorithm>
 #include <cmath>
 
 Equalizer g_equalizer;
 
+// Auto-EQ moves smaller than this aren't worth a band change
+#define AUTOEQ_MIN_STEP_DB 0.01f
+
+static std::atomic<uint32_t> g_eqBandChanges{0};
+static std::atomic<uint32_t> g_eqBatches{0};
+static std::atomic<uint32_t> g_eqRecomputes{0};
+static std::atomic<uint32_t> g_eqSkipped{0};
+
 //static float autoEQBuffer[1024];
 //static int autoEQIndex = 0;
 //static float replayGain = 1.0f;
@@ -21,8 +30,6 @@ static const float TARGET_LOUDNESS = 0.15f; // tweak later
 //static float g_replayGainLinear = 1.0f;
 static float autoGainLinear = 1.0f;   // NEW
 static float replayGainLinear = 1.0f;
-#define SPECTRUM_BARS 20
-extern float bandValues[SPECTRUM_BARS];
 static float limiterThreshold = 0.90f;  // start limiting near full scale
 static float limiterSoftness  = 4.0f;   // higher = softer curve
 static float g_replayGainPreampDb = 0.0f;
@@ -92,28 +99,30 @@ void Equalizer::setReplayGainDb(float db)
     replayGainLinear = powf(10.0f, totalDb / 20.0f);
 }
 
+// Every band is recomputed for the new rate on the next block
 void Equalizer::setSampleRate(float sr)
 {
     sampleRate = sr;
-
-    for (int i = 1; i < 10; ++i)
-        updateBandFilter(i);
+    rebuildAll.store(true, std::memory_order_release);
 }
 
 void Equalizer::setPreamp(float db)
 {
     db = std::clamp(db, -12.0f, 12.0f);
+    if (db == preampDb)
+        return;
 
     preampDb = db;
     preampLinear = std::pow(10.0f, db / 20.0f);
+    version.fetch_add(1, std::memory_order_release);
 }
 
-void Equalizer::updateBandFilter(int index)
+// Decode thread; the caller repacks the bank
+void Equalizer::updateBandFilter(int index, float gain)
 {
     if (index < 1 || index > 10)
         return;
 
-    float gain = bands[index];
     int biquadIndex = index - 1;
 
     float freq = bandFrequencies[biquadIndex];
@@ -122,8 +131,44 @@ void Equalizer::updateBandFilter(int index)
     if (freq > nyquist * 0.9f)
         freq = nyquist * 0.9f;
 
-    filtersL[biquadIndex].setupPeaking(sampleRate, freq, q, gain);
-    filtersR[biquadIndex].setupPeaking(sampleRate, freq, q, gain);
+    filters.setBand(biquadIndex, sampleRate, freq, q, gain);
+    g_eqRecomputes.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Decode thread, at the top of each block: brings the filters up to
+// the bands the UI has set. A band that moved less than
+// EQ_COEF_THRESHOLD_DB since its coefficients were computed keeps them,
+// and the bank is repacked once for the whole batch.
+void Equalizer::applyPendingBands()
+{
+    bool all = rebuildAll.exchange(false, std::memory_order_acquire);
+    uint32_t v = version.load(std::memory_order_acquire);
+    if (!all && v == appliedVersion)
+        return;
+    appliedVersion = v;
+
+    bool changed = false;
+    for (int b = 0; b < 10; ++b)
+    {
+        float gain  = pendingGain[b].load(std::memory_order_relaxed);
+        float moved = std::fabs(gain - appliedGain[b]);
+        bool  flat  = (gain == 0.0f) != (appliedGain[b] == 0.0f);   // joins/leaves the cascade
+
+        if (!all && !flat && moved < EQ_COEF_THRESHOLD_DB)
+        {
+            if (moved > 0.0f)
+                g_eqSkipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        updateBandFilter(b + 1, gain);
+        appliedGain[b] = gain;
+        changed = true;
+    }
+
+    if (changed)
+        filters.repack();
+    g_eqBatches.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Equalizer::setReplayGainPreamp(float db)
@@ -147,9 +192,14 @@ void Equalizer::setBand(int index, float value)
     if (index < 1 || index > 10)
         return;
 
-    bands[index] = std::clamp(value, -12.0f, 12.0f);
+    value = std::clamp(value, -12.0f, 12.0f);
+    if (value == bands[index])
+        return;
 
-    updateBandFilter(index);
+    bands[index] = value;
+    pendingGain[index - 1].store(value, std::memory_order_relaxed);
+    version.fetch_add(1, std::memory_order_release);
+    g_eqBandChanges.fetch_add(1, std::memory_order_relaxed);
 }
 
 void Equalizer::setReplayGain(float db, float peak, bool isAlbum)
@@ -175,7 +225,9 @@ void updateAutoEQ()
         return;
 
     const int EQ_BANDS = 10;
-    const int BARS_PER_BAND = SPECTRUM_BARS / EQ_BANDS;
+    const int BARS_PER_BAND = spectrumEngineBars() / EQ_BANDS;
+    if (BARS_PER_BAND < 1)
+        return;   // analyser not running yet
 
     static float smoothed[EQ_BANDS] = {0};
 
@@ -212,82 +264,66 @@ void updateAutoEQ()
         float diff = db - current;
 
         diff = std::clamp(diff, -0.3f, 0.3f);
+        if (std::fabs(diff) < AUTOEQ_MIN_STEP_DB)
+            continue;
 
         g_equalizer.setBand(b + 1, current + diff);
     }
 }
 
-float Equalizer::processSample(float sample, int channel)
+// DSP chain for interleaved stereo, run on the decode thread before samples
+// enter the ring. Each stage is a flat loop over the block; the band filters
+// run as one SIMD cascade. Also applies the output soft clip that used to
+// live in the audio callback, so the callback only has to copy.
+void Equalizer::processBlock(float* samples, int frames)
 {
+    const int count = frames * 2;
+
+    applyPendingBands();
+
     // -------------------------
-    // ReplayGain stage (ALWAYS active if enabled)
-    // -------------------------
-    // -------------------------
-    // ReplayGain (metadata-based)
+    // AutoGain (dynamic) + clamp
     // -------------------------
-    float gainLinear = 1.0f;
-
-    switch (g_settings.replayGainMode)
+    if (g_settings.autoGainEnabled)
     {
-        case REPLAYGAIN_OFF:
-            gainLinear = 1.0f;
-            break;
-
-        case REPLAYGAIN_TRACK:
-            gainLinear = g_replayGainTrackLinear;
-            break;
-
-        case REPLAYGAIN_ALBUM:
-            gainLinear = g_replayGainAlbumLinear;
-            break;
+        for (int i = 0; i < count; ++i)
+        {
+            updateAutoGain(samples[i]);
+            samples[i] = std::clamp(samples[i] * autoGainLinear, -1.0f, 1.0f);
+        }
     }
-
-    // Apply ReplayGain preamp (if you keep it)
-    gainLinear *= g_replayGainPreampLinear;
-
-    // Apply ReplayGain
-    // Apply ReplayGain (static)
-    //sample *= replayGainLinear;
-
-    // Apply AutoGain (dynamic)
-    if (g_settings.autoGainEnabled)
+    else
     {
-        updateAutoGain(sample);
-        sample *= autoGainLinear;
+        for (int i = 0; i < count; ++i)
+            samples[i] = std::clamp(samples[i], -1.0f, 1.0f);
     }
-    sample = std::clamp(sample, -1.0f, 1.0f);
-    // -------------------------
-    // If EQ disabled → skip filters but KEEP ReplayGain
-    // -------------------------
-    if (!enabled)
-        return sample;
-
-    // -------------------------
-    // EQ preamp (separate from ReplayGain)
-    // -------------------------
-    sample *= (preampLinear * 0.85f); // keep your headroom
 
-    // -------------------------
-    // Filters
-    // -------------------------
-    for (int i = 0; i < 10; ++i)
+    if (enabled)
     {
-        if (bands[i + 1] == 0.0f)
-            continue;
-
-        if (channel == 0)
-            sample = filtersL[i].process(sample);
-        else
-            sample = filtersR[i].process(sample);
+        // -------------------------
+        // EQ preamp
+        // -------------------------
+        const float pre = preampLinear * 0.85f;
+        for (int i = 0; i < count; ++i)
+            samples[i] *= pre;
+
+        // -------------------------
+        // Filters (flat bands are skipped inside the bank)
+        // -------------------------
+        filters.processBlock(samples, frames);
+
+        // -------------------------
+        // Soft clip + limiter
+        // -------------------------
+        for (int i = 0; i < count; ++i)
+            samples[i] = softLimiter(std::tanh(samples[i]));
     }
 
     // -------------------------
-    // Soft clip + limiter
+    // Output soft clip (was in the audio callback)
     // -------------------------
-    sample = std::tanh(sample);
-    sample = softLimiter(sample);
-
-    return sample;
+    for (int i = 0; i < count; ++i)
+        samples[i] = samples[i] / (1.0f + fabsf(samples[i]));
 }
 
 float Equalizer::getBand(int index) const
@@ -323,11 +359,23 @@ bool Equalizer::isEnabled() const
     return enabled;
 }
 
+uint32_t Equalizer::getVersion() const
+{
+    return version.load(std::memory_order_acquire);
+}
+
 void Equalizer::reset()
 {
-    for (int i = 0; i < 10; i++)
-    {
-        bands[i] = 0.0f;
-        updateBandFilter(i);
-    }
+    for (int i = 1; i <= 10; i++)
+        setBand(i, 0.0f);
+}
+
+EqCoefStats eqTakeCoefStats()
+{
+    EqCoefStats s;
+    s.bandChanges = g_eqBandChanges.exchange(0);
+    s.batches     = g_eqBatches.exchange(0);
+    s.recomputes  = g_eqRecomputes.exchange(0);
+    s.skipped     = g_eqSkipped.exchange(0);
+    return s;
 }
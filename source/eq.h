@@ -1,8 +1,23 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <stdint.h>
 #include "biquad.h"
 
 constexpr int EQ_BAND_COUNT = 11;
+
+// A band's filter keeps its coefficients until its gain has moved at
+// least this far from the gain they were computed for (or to/from 0 dB)
+constexpr float EQ_COEF_THRESHOLD_DB = 0.05f;
+
+// Band changes from the UI and coefficient work on the decode thread
+struct EqCoefStats
+{
+    uint32_t bandChanges = 0;   // setBand() calls that changed a gain
+    uint32_t batches     = 0;   // audio blocks that picked changes up
+    uint32_t recomputes  = 0;   // band coefficient sets computed
+    uint32_t skipped     = 0;   // band moves left below the threshold
+};
 extern bool autoEQEnabled;
 class Equalizer
 {
@@ -22,9 +37,12 @@ public:
 
     void reset();
 
+    // Bumped by every band or preamp change; anything drawn from the
+    // EQ state can key its cache on this
+    uint32_t getVersion() const;
+
     float getPreampLinear() const;
-    float processSample(float sample, int channel);
-    const Biquad& getFilter(int index) const { return filtersL[index]; }
+    void processBlock(float* samples, int frames); // interleaved stereo, in place
     void setSampleRate(float sr);
 
 private:
@@ -36,11 +54,25 @@ private:
 
     float q = 1.0f;
 
-    Biquad filtersL[10];
-    Biquad filtersR[10];
+    BiquadBank filters;   // bands 1..10 → filter bank slots 0..9
+
+    // UI thread → decode thread. setBand() stores the gain and bumps
+    // the version; processBlock() applies everything that moved, once
+    // per block, so coefficients are never rewritten mid-block.
+    std::atomic<uint32_t> version{0};
+    std::atomic<bool>     rebuildAll{true};
+    std::atomic<float>    pendingGain[10] = {};
+
+    // Decode thread only
+    uint32_t appliedVersion  = 0;
+    float    appliedGain[10] = {};
 
     void updatePreamp();
-    void updateBandFilter(int index);
+    void updateBandFilter(int index, float gain);
+    void applyPendingBands();
 };
 void updateAutoEQ();
+
+// Counters since the last call, then reset
+EqCoefStats eqTakeCoefStats();
 extern Equalizer g_equalizer;
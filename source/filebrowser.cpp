@@ -5,6 +5,9 @@
 #include "ogg.h"
 #include "wav.h"
 #include "ui.h"
+#include "player.h"
+#include "metacache.h"
+#include "scanpool.h"
 
 #include <switch.h>
 #include <SDL.h>
@@ -176,15 +179,16 @@ static void commitFolder(const char* path){
 }
 static void doCommit(){
     if(g_pendFolders.empty()&&g_pendFiles.empty()){g_screen=FB_NONE;return;}
-    mp3CancelAllScans(); flacCancelAllScans(); oggCancelAllScans(); wavCancelAllScans();
+    scanPoolCancelAll();
+    playerStop(); // decode thread must let go of the old playlist first
     playlistClear();
     mp3ClearMetadata(); flacClearMetadata(); oggClearMetadata(); wavClearMetadata();
-    for(auto& f:g_pendFolders){
-        char k[512]; snprintf(k,sizeof(k),"%s/",f.c_str());
-        mp3LoadCache(k); flacLoadCache(k); oggLoadCache(k); wavLoadCache(k);
-    }
+    metaCacheLoad(); // one journal for every format; no-op after the first commit
+    u64 t0=svcGetSystemTick();
     for(auto& f:g_pendFolders) commitFolder(f.c_str());
     for(auto& f:g_pendFiles)   commitFile(f.c_str());
+    printf("[PLAYLIST] Imported %d tracks in %.1f ms (%d known)\n",
+           playlistGetCount(),(svcGetSystemTick()-t0)/19200.0,trackCount());
     playlistScroll=0;
     g_pendFolders.clear(); g_pendFiles.clear();
     g_screen=FB_NONE;
@@ -1,6 +1,8 @@
 #include "flac.h"
 #include "playlist.h"
 #include "player.h"
+#include "metacache.h"
+#include "scanpool.h"
 #include <FLAC/stream_decoder.h>
 #include <FLAC/metadata.h>
 #include <switch.h>
@@ -16,141 +18,23 @@
 #include <unordered_map>
 #include <unordered_set>
 
-/* -------------------------------------------------------
-   Cache
-------------------------------------------------------- */
-#define FLAC_CACHE_VERSION 1
-#define FLAC_CACHE_PATH     "sdmc:/config/winamp/flac_cache.bin"
-#define FLAC_CACHE_TMP_PATH "sdmc:/config/winamp/flac_cache.bin.tmp"
-
-struct FlacCacheHeader {
-    uint32_t magic;    // 'FLCC'
-    uint32_t version;
-};
-
-struct FlacCacheEntry {
-    char             path[512];
-    time_t           mtime;
-    Mp3MetadataEntry meta;
-};
-
-static std::unordered_map<std::string, FlacCacheEntry> g_flacCache;
-static bool g_flacCacheLoaded = false;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FLAC_CONVERT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FLAC_CONVERT_SSE 1
+#endif
 
 /* -------------------------------------------------------
-   Background scanner state
+   Scanner state
 ------------------------------------------------------- */
-static Thread g_flacThread;
-static bool   g_flacThreadRunning = false;
-static Mutex  g_flacMetaMutex;
-static Mutex  g_flacScanMutex;
 static char   g_flacLoadedFolder[512] = {0};
-
-struct FlacScanJob {
-    std::string path;
-    int         index;
-    int         generation;
-};
-
-static std::vector<FlacScanJob>            g_flacScanQueue;
-static std::unordered_set<std::string>     g_flacScanQueued;
-static std::vector<RuntimeMetadata>        g_flacPlaylistMeta;
-static int                                 g_flacScanGeneration = 0;
+static int    g_flacTrackCount = 0;
 
 /* -------------------------------------------------------
    Helpers
 ------------------------------------------------------- */
-static bool flacCacheValid(const FlacCacheEntry& e)
-{
-    struct stat st;
-    if (stat(e.path, &st) != 0) return false;
-    return st.st_mtime == e.mtime;
-}
-
-static bool flacPlaylistHasPath(const char* path)
-{
-    for (auto& m : g_flacPlaylistMeta)
-        if (strcmp(m.path, path) == 0) return true;
-    return false;
-}
-
-static void ensureCacheDir()
-{
-    mkdir("sdmc:/config",        0777);
-    mkdir("sdmc:/config/winamp", 0777);
-}
-
-/* -------------------------------------------------------
-   Cache I/O
-------------------------------------------------------- */
-void flacLoadCache(const char* /*folderKey*/)
-{
-    if (g_flacCacheLoaded) return;
-    ensureCacheDir();
-
-    FILE* f = fopen(FLAC_CACHE_PATH, "rb");
-    if (!f) { g_flacCacheLoaded = true; return; }
-
-    FlacCacheHeader h{};
-    if (fread(&h, sizeof(h), 1, f) != 1 ||
-        h.magic   != 0x464C4343 ||          // 'FLCC'
-        h.version != FLAC_CACHE_VERSION)
-    {
-        fclose(f);
-        g_flacCacheLoaded = true;
-        return;
-    }
-
-    FlacCacheEntry e;
-    while (fread(&e, sizeof(e), 1, f) == 1)
-        if (flacCacheValid(e))
-            g_flacCache[e.path] = e;
-
-    fclose(f);
-    g_flacCacheLoaded = true;
-}
-
-static void flacAppendCache(const char* path, const Mp3MetadataEntry& meta)
-{
-    if (!path || strncmp(path, "romfs:/", 7) == 0) return;
-    if (strstr(path, ".tmp")) return;
-
-    struct stat st;
-    if (stat(path, &st) != 0) return;
-
-    // Write throttle — SD cards hate hammering
-    static time_t lastWrite = 0;
-    time_t now = time(nullptr);
-    if (now - lastWrite < 1) return;
-    lastWrite = now;
-
-    FlacCacheEntry& e = g_flacCache[path];
-    strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path)-1] = '\0';
-    e.meta  = meta;
-    e.mtime = st.st_mtime;
-
-    FILE* f = fopen(FLAC_CACHE_TMP_PATH, "wb");
-    if (!f) return;
-
-    FlacCacheHeader h{ 0x464C4343, FLAC_CACHE_VERSION };
-    if (fwrite(&h, sizeof(h), 1, f) != 1) goto fail;
-
-    for (auto& [_, entry] : g_flacCache)
-        if (fwrite(&entry, sizeof(entry), 1, f) != 1) goto fail;
-
-    fflush(f);
-    fsync(fileno(f));
-    fclose(f);
-    remove(FLAC_CACHE_PATH);
-    rename(FLAC_CACHE_TMP_PATH, FLAC_CACHE_PATH);
-    return;
-
-fail:
-    fclose(f);
-    remove(FLAC_CACHE_TMP_PATH);
-}
-
 /* -------------------------------------------------------
    Vorbis comment (FLAC tag) parsing
    FLAC stores tags as UTF-8 KEY=VALUE Vorbis comments.
@@ -287,52 +171,38 @@ static void readFlacMetadata(const char* path, Mp3MetadataEntry& entry)
 }
 
 /* -------------------------------------------------------
-   Background scanner thread
+   Scan job (runs on the scanner pool)
 ------------------------------------------------------- */
-static void flacScanThread(void*)
+void flacScanJob(const ScanJob& job)
 {
-    while (g_flacThreadRunning)
-    {
-        FlacScanJob job;
+    // Don't scan the track that's currently playing
+    if (playerIsPlaying() &&
+        playlistGetTrackId(playlistGetCurrentIndex()) == job.id)
+        return;
 
-        mutexLock(&g_flacScanMutex);
-        if (g_flacScanQueue.empty())
-        {
-            mutexUnlock(&g_flacScanMutex);
-            svcSleepThread(50'000'000); // 50 ms
-            continue;
-        }
-        job = g_flacScanQueue.front();
-        g_flacScanQueue.erase(g_flacScanQueue.begin());
-        mutexUnlock(&g_flacScanMutex);
-
-        // Cancel check
-        mutexLock(&g_flacScanMutex);
-        bool canceled = (job.generation != g_flacScanGeneration);
-        mutexUnlock(&g_flacScanMutex);
-        if (canceled) continue;
-
-        // Don't scan the track that's currently playing
-        // Compare by path since job.index is a LOCAL metadata index,
-        // not a global playlist index.
-        if (playerIsPlaying())
-        {
-            int globalIdx = playlistGetCurrentIndex();
-            const char* playingPath = playlistGetTrack(globalIdx);
-            if (playingPath && job.path == playingPath)
-                continue;
-        }
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
 
-        Mp3MetadataEntry entry{};
-        readFlacMetadata(job.path.c_str(), entry);
+    Mp3MetadataEntry entry{};
+    readFlacMetadata(path, entry);
 
-        mutexLock(&g_flacMetaMutex);
-        if (job.index < (int)g_flacPlaylistMeta.size())
-            g_flacPlaylistMeta[job.index].meta = entry;
-        mutexUnlock(&g_flacMetaMutex);
+    if (scanJobCanceled(job)) return;
+    trackSetMetadata(job.id, entry);
+    metaCachePut(path, entry);
+}
 
-        flacAppendCache(job.path.c_str(), entry);
-    }
+// Seek points for a track that was played before it had any
+void flacSeekJob(const ScanJob& job)
+{
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
+
+    FlacSeekPoints sp;
+    if (flacSeekPointsLoad(path, &sp)) return;   // built meanwhile
+
+    // A file with its own SEEKTABLE is saved as such, so it's never probed again
+    if (flacBuildSeekPoints(path, &sp) && !scanJobCanceled(job))
+        flacSeekPointsSave(path, sp);
 }
 
 /* -------------------------------------------------------
@@ -350,122 +220,101 @@ void flacSetLoadedFolder(const char* path)
     g_flacLoadedFolder[sizeof(g_flacLoadedFolder)-1] = '\0';
 }
 
-static bool g_flacMutexInited = false;
-
-static void flacEnsureMutexInited()
-{
-    if (!g_flacMutexInited)
-    {
-        mutexInit(&g_flacMetaMutex);
-        mutexInit(&g_flacScanMutex);
-        g_flacMutexInited = true;
-    }
-}
-
-void flacCancelAllScans()
-{
-    flacEnsureMutexInited();
-    mutexLock(&g_flacScanMutex);
-    g_flacScanQueue.clear();
-    g_flacScanQueued.clear();
-    g_flacScanGeneration++;
-    mutexUnlock(&g_flacScanMutex);
-}
-
-void flacStartBackgroundScanner()
-{
-    flacEnsureMutexInited();
-    g_flacThreadRunning = true;
-    threadCreate(&g_flacThread,
-                 flacScanThread,
-                 nullptr, nullptr,
-                 0x4000, 0x2B, -2);
-    threadStart(&g_flacThread);
-}
-
-void flacStopBackgroundScanner()
-{
-    if (!g_flacThreadRunning) return;
-    g_flacThreadRunning = false;
-    threadWaitForExit(&g_flacThread);
-    threadClose(&g_flacThread);
-}
-
 void flacClearMetadata()
 {
-    flacEnsureMutexInited();
-    mutexLock(&g_flacMetaMutex);
-    g_flacPlaylistMeta.clear();
-    mutexUnlock(&g_flacMetaMutex);
+    g_flacTrackCount = 0;   // metadata itself stays in the track table
 }
 
 bool flacAddToPlaylist(const char* path)
 {
     if (!path) return false;
-    flacEnsureMutexInited();
-    if (flacPlaylistHasPath(path)) return false;
 
-    playlistAdd(path);
-    // NOTE: We use the LOCAL index into g_flacPlaylistMeta, not the global
-    // playlist index. This is critical for mixed MP3+FLAC folders where the
-    // global playlist index != the FLAC metadata vector index.
-    int localIndex = (int)g_flacPlaylistMeta.size();
+    // NOTE: Metadata is keyed by track ID, which is the same whatever else
+    // is in the playlist — mixed MP3+FLAC folders need no local index.
+    TrackId id = playlistAdd(path);
+    if (id == TRACK_ID_NONE) return false;   // already in the playlist
+    g_flacTrackCount++;
 
     Mp3MetadataEntry meta{};
     strncpy(meta.title, "Scanning...", sizeof(meta.title) - 1);
+    trackSetMetadata(id, meta);
 
-    RuntimeMetadata r{};
-    strncpy(r.path, path, sizeof(r.path) - 1);
-    r.path[sizeof(r.path)-1] = '\0';
-    r.meta = meta;
-    g_flacPlaylistMeta.push_back(r);
-
-    printf("[FLAC] Adding to playlist (localIdx=%d): %s\n", localIndex, path);
+    printf("[FLAC] Adding to playlist (id=%u): %s\n", id, path);
 
     // Try cache first
-    auto it = g_flacCache.find(path);
-    if (it != g_flacCache.end() && flacCacheValid(it->second))
+    Mp3MetadataEntry cached;
+    if (metaCacheLookup(path, &cached))
     {
-        mutexLock(&g_flacMetaMutex);
-        g_flacPlaylistMeta[localIndex].meta = it->second.meta;
-        mutexUnlock(&g_flacMetaMutex);
+        trackSetMetadata(id, cached);
         printf("[FLAC] Cache hit: %s\n", path);
         return true;
     }
 
-    // Queue background scan using the LOCAL index
-    mutexLock(&g_flacScanMutex);
-    if (g_flacScanQueued.insert(path).second)
-        g_flacScanQueue.push_back({ path, localIndex, g_flacScanGeneration });
-    mutexUnlock(&g_flacScanMutex);
+    // Queue background scan
+    scanPoolSubmit(id, SCAN_JOB_FLAC, scanPoolToken());
 
     return true;
 }
 
-// Look up FLAC metadata by path rather than global playlist index,
-// so it works correctly in mixed MP3+FLAC playlists.
-const Mp3MetadataEntry* flacGetTrackMetadata(int globalIndex)
-{
-    if (globalIndex < 0 || globalIndex >= playlistGetCount()) return nullptr;
-    const char* path = playlistGetTrack(globalIndex);
-    if (!path) return nullptr;
-
-    for (auto& r : g_flacPlaylistMeta)
-        if (strcmp(r.path, path) == 0)
-            return &r.meta;
-
-    return nullptr;
-}
-
 int flacGetPlaylistCount()
 {
-    return (int)g_flacPlaylistMeta.size();
+    return g_flacTrackCount;
 }
 
 /* =======================================================
    DECODER  (used by player.cpp at playback time)
 ======================================================= */
 
+/* -------------------------------------------------------
+   int32 planar → float32 interleaved stereo
+   `r` may alias `l` for mono. Four frames per iteration on
+   NEON/SSE2, scalar tail (and scalar fallback elsewhere).
+------------------------------------------------------- */
+static void flacConvertStereo(const FLAC__int32* l,
+                              const FLAC__int32* r,
+                              float*             out,
+                              uint32_t           n,
+                              float              scale)
+{
+    uint32_t i = 0;
+#if defined(FLAC_CONVERT_NEON)
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4x2_t v;
+        v.val[0] = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(l + i)), scale);
+        v.val[1] = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(r + i)), scale);
+        vst2q_f32(out + i * 2, v);
+    }
+#elif defined(FLAC_CONVERT_SSE)
+    const __m128 vs = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 vl = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(l + i))), vs);
+        __m128 vr = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(r + i))), vs);
+        _mm_storeu_ps(out + i * 2,     _mm_unpacklo_ps(vl, vr));
+        _mm_storeu_ps(out + i * 2 + 4, _mm_unpackhi_ps(vl, vr));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        out[i * 2]     = (float)l[i] * scale;
+        out[i * 2 + 1] = (float)r[i] * scale;
+    }
+}
+
+// Make room for `samples` more floats in the overflow ring without
+// dropping what's already there (only hit by unusually large blocks).
+static bool flacGrowOverflow(FlacDecoder* fd, size_t samples)
+{
+    if (fd->overflow.availableWrite() >= samples) return true;
+
+    std::vector<float> keep(fd->overflow.availableRead());
+    fd->overflow.read(keep.data(), keep.size());
+    if (!fd->overflow.init(keep.size() + samples)) return false;
+    fd->overflow.write(keep.data(), keep.size());
+    return true;
+}
+
 /* -------------------------------------------------------
    libFLAC callbacks
 ------------------------------------------------------- */
@@ -482,39 +331,99 @@ static FLAC__StreamDecoderWriteStatus flacWriteCallback(
     uint32_t ch        = frame->header.channels;
     uint32_t bps       = frame->header.bits_per_sample;
 
-    // Clamp to stereo — player.cpp expects 2-channel int16
-    if (ch > 2) ch = 2;
+    // Seek-point landing: drop everything in front of the target
+    uint32_t skip = 0;
+    if (fd->seeking)
+    {
+        uint64_t first = frame->header.number.sample_number;
+        if (first + blockSize <= fd->seekTarget)
+            return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+        if (fd->seekTarget > first)
+            skip = (uint32_t)(fd->seekTarget - first);
+        fd->seeking = false;
+    }
 
-    // Scale factor: convert bps → int16_t range
-    int shift = (int)bps - 16;
+    // Scale straight from the decoder's int32 to float: full precision for
+    // 24-bit files, no intermediate int16 step. Channels past 2 are ignored.
+    const float scale = 1.0f / (float)(1u << (bps - 1));
+    const FLAC__int32* srcL = buffer[0] + skip;
+    const FLAC__int32* srcR = ((ch > 1) ? buffer[1] : buffer[0]) + skip;
+    blockSize -= skip;
 
-    for (uint32_t i = 0; i < blockSize; i++)
+    // As much as fits goes directly into the caller's buffer...
+    uint32_t direct = 0;
+    if (fd->dst && fd->dstFill < fd->dstCap)
     {
-        int32_t l = buffer[0][i];
-        int32_t r = (frame->header.channels > 1) ? buffer[1][i] : l;
-
-        // Scale to 16-bit
-        int16_t sl, sr;
-        if (shift > 0)       { sl = (int16_t)(l >> shift); sr = (int16_t)(r >> shift); }
-        else if (shift < 0)  { sl = (int16_t)(l << -shift); sr = (int16_t)(r << -shift); }
-        else                 { sl = (int16_t)l; sr = (int16_t)r; }
-
-        // Write into ring buffer — drop frames if full (shouldn't happen with
-        // the 8192-frame buffer and the read loop draining it promptly)
-        if (fd->pcmCount < FlacDecoder::BUF_FRAMES)
+        direct = std::min(blockSize, fd->dstCap - fd->dstFill);
+        flacConvertStereo(srcL, srcR, fd->dst + fd->dstFill * 2, direct, scale);
+        fd->dstFill += direct;
+    }
+
+    // ...and the rest is parked for the next flacRead. Nothing is dropped.
+    uint32_t spill = blockSize - direct;
+    if (spill > 0)
+    {
+        if (!flacGrowOverflow(fd, (size_t)spill * 2))
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
+        const uint32_t CHUNK = 512;
+        float tmp[CHUNK * 2];
+        for (uint32_t base = direct; base < blockSize; base += CHUNK)
         {
-            int writePos = fd->pcmTail;
-            fd->pcmBuf[writePos * 2]     = sl;
-            fd->pcmBuf[writePos * 2 + 1] = sr;
-            fd->pcmTail  = (fd->pcmTail + 1) % FlacDecoder::BUF_FRAMES;
-            fd->pcmCount++;
-            fd->samplesRead++;
+            uint32_t n = std::min(CHUNK, blockSize - base);
+            flacConvertStereo(srcL + base, srcR + base, tmp, n, scale);
+            fd->overflow.write(tmp, (size_t)n * 2);
         }
     }
 
+    fd->samplesRead   += blockSize;
+    fd->framesDecoded += blockSize;
     return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
 }
 
+// Compressed input comes from the shared read-ahead service
+static FLAC__StreamDecoderReadStatus flacIoRead(
+    const FLAC__StreamDecoder* /*decoder*/,
+    FLAC__byte                 buffer[],
+    size_t*                    bytes,
+    void*                      clientData)
+{
+    FlacDecoder* fd = (FlacDecoder*)clientData;
+    if (*bytes == 0) return FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+
+    *bytes = readAheadRead(fd->io, buffer, *bytes);
+    return (*bytes == 0) ? FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM
+                         : FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+}
+
+static FLAC__StreamDecoderSeekStatus flacIoSeek(
+    const FLAC__StreamDecoder* /*decoder*/, FLAC__uint64 offset, void* clientData)
+{
+    FlacDecoder* fd = (FlacDecoder*)clientData;
+    return readAheadSeek(fd->io, (int64_t)offset, SEEK_SET)
+         ? FLAC__STREAM_DECODER_SEEK_STATUS_OK
+         : FLAC__STREAM_DECODER_SEEK_STATUS_ERROR;
+}
+
+static FLAC__StreamDecoderTellStatus flacIoTell(
+    const FLAC__StreamDecoder* /*decoder*/, FLAC__uint64* offset, void* clientData)
+{
+    *offset = (FLAC__uint64)readAheadTell(((FlacDecoder*)clientData)->io);
+    return FLAC__STREAM_DECODER_TELL_STATUS_OK;
+}
+
+static FLAC__StreamDecoderLengthStatus flacIoLength(
+    const FLAC__StreamDecoder* /*decoder*/, FLAC__uint64* length, void* clientData)
+{
+    *length = (FLAC__uint64)readAheadSize(((FlacDecoder*)clientData)->io);
+    return FLAC__STREAM_DECODER_LENGTH_STATUS_OK;
+}
+
+static FLAC__bool flacIoEof(const FLAC__StreamDecoder* /*decoder*/, void* clientData)
+{
+    return readAheadEof(((FlacDecoder*)clientData)->io);
+}
+
 static void flacMetadataCallback(
     const FLAC__StreamDecoder* /*decoder*/,
     const FLAC__StreamMetadata* metadata,
@@ -530,6 +439,14 @@ static void flacMetadataCallback(
         fd->bitsPerSample = metadata->data.stream_info.bits_per_sample;
         fd->totalSamples  = metadata->data.stream_info.total_samples;
     }
+    else if (metadata->type == FLAC__METADATA_TYPE_SEEKTABLE)
+    {
+        // Only real points count — encoders often leave placeholders
+        const FLAC__StreamMetadata_SeekTable& st = metadata->data.seek_table;
+        for (uint32_t i = 0; i < st.num_points && !fd->hasSeekTable; i++)
+            if (st.points[i].sample_number != UINT64_MAX)
+                fd->hasSeekTable = true;
+    }
 }
 
 static void flacErrorCallback(
@@ -550,20 +467,30 @@ FlacDecoder* flacOpen(const char* path)
 {
     FlacDecoder* fd = new FlacDecoder();
 
+    fd->io = readAheadOpen(path);
+    if (!fd->io) { delete fd; return nullptr; }
+
     fd->decoder = FLAC__stream_decoder_new();
-    if (!fd->decoder) { delete fd; return nullptr; }
+    if (!fd->decoder) { flacClose(fd); return nullptr; }
 
     // Enable MD5 checking is optional; skip for performance on Switch
     FLAC__stream_decoder_set_md5_checking(fd->decoder, false);
 
-    // We want STREAMINFO so the metadata callback fires
+    // We want STREAMINFO so the metadata callback fires, and SEEKTABLE
+    // to know whether libFLAC can seek well on its own
     FLAC__stream_decoder_set_metadata_respond(
         fd->decoder, FLAC__METADATA_TYPE_STREAMINFO);
+    FLAC__stream_decoder_set_metadata_respond(
+        fd->decoder, FLAC__METADATA_TYPE_SEEKTABLE);
 
     FLAC__StreamDecoderInitStatus status =
-        FLAC__stream_decoder_init_file(
+        FLAC__stream_decoder_init_stream(
             fd->decoder,
-            path,
+            flacIoRead,
+            flacIoSeek,
+            flacIoTell,
+            flacIoLength,
+            flacIoEof,
             flacWriteCallback,
             flacMetadataCallback,
             flacErrorCallback,
@@ -572,38 +499,56 @@ FlacDecoder* flacOpen(const char* path)
 
     if (status != FLAC__STREAM_DECODER_INIT_STATUS_OK)
     {
-        FLAC__stream_decoder_delete(fd->decoder);
-        delete fd;
+        flacClose(fd);
         return nullptr;
     }
 
     // Process metadata blocks (fires flacMetadataCallback → sets sampleRate etc.)
     if (!FLAC__stream_decoder_process_until_end_of_metadata(fd->decoder))
     {
-        FLAC__stream_decoder_delete(fd->decoder);
-        delete fd;
+        flacClose(fd);
         return nullptr;
     }
 
     if (fd->sampleRate == 0)
     {
         // Metadata callback never fired — not a valid FLAC
-        FLAC__stream_decoder_delete(fd->decoder);
-        delete fd;
+        flacClose(fd);
         return nullptr;
     }
 
+    // No SEEKTABLE: use cached seek points, or have them built
+    if (!fd->hasSeekTable && !flacSeekPointsLoad(path, &fd->seekPoints))
+    {
+        fd->seekPending = trackFind(path);
+        if (fd->seekPending != TRACK_ID_NONE)
+            scanPoolSubmit(fd->seekPending, SCAN_JOB_FLAC_SEEK, scanPoolToken());
+    }
+
     return fd;
 }
 
 void flacClose(FlacDecoder* fd)
 {
     if (!fd) return;
+
+    // Throughput of the decode loop only (excludes the player's DSP),
+    // handy for comparing 16- vs 24-bit files on hardware.
+    if (fd->decodeTicks > 0 && fd->framesDecoded > 0)
+    {
+        double sec = fd->decodeTicks / 19200000.0;
+        printf("[FLAC] %u-bit: %llu frames in %.2fs decode → %.0f frames/s\n",
+               fd->bitsPerSample,
+               (unsigned long long)fd->framesDecoded, sec,
+               fd->framesDecoded / sec);
+    }
+
     if (fd->decoder)
     {
         FLAC__stream_decoder_finish(fd->decoder);
         FLAC__stream_decoder_delete(fd->decoder);
     }
+    readAheadClose(fd->io);
     delete fd;
 }
 
@@ -618,13 +563,20 @@ FlacReadResult flacRead(FlacDecoder* fd,
     *bytesRead = 0;
     if (!fd || fd->error) return FLAC_READ_ERR;
 
-    // How many int16_t stereo frames fit in bufBytes?
-    int maxFrames = (int)(bufBytes / (sizeof(int16_t) * 2));
+    // How many float stereo frames fit in bufBytes?
+    int maxFrames = (int)(bufBytes / (sizeof(float) * 2));
     if (maxFrames <= 0) return FLAC_READ_OK;
 
-    // Decode blocks from libFLAC until the ring buffer has enough data
-    // or the stream ends.
-    while (fd->pcmCount < maxFrames && !fd->eof && !fd->error)
+    // Leftovers from the previous frame go first. If they don't fill the
+    // request, the overflow ring is now empty and new frames are decoded
+    // directly into the caller's buffer by flacWriteCallback.
+    float* out = (float*)buffer;
+    fd->dst     = out;
+    fd->dstCap  = (uint32_t)maxFrames;
+    fd->dstFill = (uint32_t)(fd->overflow.read(out, (size_t)maxFrames * 2) / 2);
+
+    u64 t0 = svcGetSystemTick();
+    while (fd->dstFill < fd->dstCap && !fd->eof && !fd->error)
     {
         FLAC__StreamDecoderState state =
             FLAC__stream_decoder_get_state(fd->decoder);
@@ -645,20 +597,14 @@ FlacReadResult flacRead(FlacDecoder* fd,
             break;
         }
     }
+    fd->decodeTicks += svcGetSystemTick() - t0;
 
-    // Drain ring buffer into caller's buffer
-    int framesAvail  = std::min(fd->pcmCount, maxFrames);
-    int16_t* outBuf  = (int16_t*)buffer;
+    int framesAvail = (int)fd->dstFill;
+    fd->dst     = nullptr;
+    fd->dstCap  = 0;
+    fd->dstFill = 0;
 
-    for (int i = 0; i < framesAvail; i++)
-    {
-        outBuf[i * 2]     = fd->pcmBuf[fd->pcmHead * 2];
-        outBuf[i * 2 + 1] = fd->pcmBuf[fd->pcmHead * 2 + 1];
-        fd->pcmHead = (fd->pcmHead + 1) % FlacDecoder::BUF_FRAMES;
-        fd->pcmCount--;
-    }
-
-    *bytesRead = (size_t)(framesAvail * sizeof(int16_t) * 2);
+    *bytesRead = (size_t)(framesAvail * sizeof(float) * 2);
 
     if (fd->error)                        return FLAC_READ_ERR;
     if (framesAvail == 0 && fd->eof)      return FLAC_READ_DONE;
@@ -668,18 +614,57 @@ FlacReadResult flacRead(FlacDecoder* fd,
 /* -------------------------------------------------------
    flacSeek
 ------------------------------------------------------- */
+// Hop headers from the nearest seek point to the target frame, restart
+// the decoder there and decode just that frame (into the overflow)
+static bool flacSeekViaPoints(FlacDecoder* fd, uint64_t targetSample)
+{
+    uint64_t offset, first;
+    if (fd->seekPoints.points.empty() ||
+        !flacSeekFindFrame(fd->io, fd->seekPoints, targetSample, &offset, &first))
+        return false;
+
+    FLAC__stream_decoder_flush(fd->decoder);
+    if (!readAheadSeek(fd->io, (int64_t)offset, SEEK_SET))
+        return false;
+
+    fd->seekTarget = targetSample;
+    fd->seeking    = true;
+    for (int i = 0; i < 4 && fd->seeking && !fd->error; i++)
+    {
+        if (!FLAC__stream_decoder_process_single(fd->decoder) ||
+            FLAC__stream_decoder_get_state(fd->decoder) == FLAC__STREAM_DECODER_END_OF_STREAM)
+            break;
+    }
+
+    bool ok = !fd->seeking && !fd->error;
+    fd->seeking = false;
+    if (!ok)
+    {
+        fd->overflow.reset();
+        fd->error = false;
+    }
+    return ok;
+}
+
 bool flacSeek(FlacDecoder* fd, uint64_t targetSample)
 {
     if (!fd || !fd->decoder || fd->error) return false;
 
-    // Clear the ring buffer — stale data is invalid after seek
-    fd->pcmHead  = 0;
-    fd->pcmTail  = 0;
-    fd->pcmCount = 0;
+    // Clear the overflow — stale data is invalid after seek. The target
+    // frame that seek_absolute decodes lands there (dst is null).
+    fd->overflow.reset();
     fd->eof      = false;
     fd->error    = false;
 
-    if (!FLAC__stream_decoder_seek_absolute(fd->decoder, targetSample))
+    u64 t0 = svcGetSystemTick();
+
+    // Points may have been built since the track was opened
+    if (fd->seekPending != TRACK_ID_NONE &&
+        flacSeekPointsLoad(trackGetPath(fd->seekPending), &fd->seekPoints))
+        fd->seekPending = TRACK_ID_NONE;
+
+    bool viaPoints = flacSeekViaPoints(fd, targetSample);
+    if (!viaPoints && !FLAC__stream_decoder_seek_absolute(fd->decoder, targetSample))
     {
         // Some files don't support fast seek; reset and re-decode from 0
         FLAC__stream_decoder_reset(fd->decoder);
@@ -688,6 +673,12 @@ bool flacSeek(FlacDecoder* fd, uint64_t targetSample)
         return false;
     }
 
+    // Latency per path, to compare files with and without seek points
+    printf("[FLAC] Seek to %.1f s via %s in %.1f ms\n",
+           fd->sampleRate ? (double)targetSample / fd->sampleRate : 0.0,
+           viaPoints ? "seek point" : (fd->hasSeekTable ? "SEEKTABLE" : "bisection"),
+           (svcGetSystemTick() - t0) / 19200.0);
+
     fd->samplesRead = targetSample;
     return true;
 }
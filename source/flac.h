@@ -4,16 +4,20 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <FLAC/stream_decoder.h>
+#include "ring_buffer.h"
+#include "readahead.h"
+#include "flacseek.h"
+#include "tracktable.h"
 
 /* -------------------------------------------------------
    FLAC decoder handle
    Wraps a libFLAC stream decoder and exposes PCM in the
-   same int16_t stereo format player.cpp expects.
+   same float32 stereo format player.cpp expects.
 ------------------------------------------------------- */
 struct FlacDecoder
 {
     FLAC__StreamDecoder* decoder = nullptr;
-    FILE*                file    = nullptr;
+    ReadAheadStream*     io      = nullptr;   // compressed input
 
     // Format info (filled after first metadata callback)
     uint32_t sampleRate   = 0;
@@ -22,14 +26,32 @@ struct FlacDecoder
     uint64_t totalSamples = 0;   // total PCM frames in file
     uint64_t samplesRead  = 0;   // frames decoded so far
 
-    // Decoded PCM ring-buffer (int16_t interleaved stereo)
-    static constexpr int BUF_FRAMES = 8192;
-    int16_t  pcmBuf[BUF_FRAMES * 2]; // stereo → *2
-    int      pcmHead  = 0;  // read position
-    int      pcmTail  = 0;  // write position
-    int      pcmCount = 0;  // frames available
+    // Zero-copy target: flacRead points these at the caller's buffer
+    // for the duration of the call, and the write callback decodes
+    // straight into it (float32 interleaved stereo).
+    float*   dst      = nullptr;
+    uint32_t dstCap   = 0;       // frames
+    uint32_t dstFill  = 0;       // frames
+
+    // Whatever part of a FLAC frame didn't fit in dst. Holds at most
+    // one block between reads; grows if a file uses a bigger block.
+    static constexpr int OVERFLOW_FRAMES = 8192;
+    RingBuffer<float> overflow{ OVERFLOW_FRAMES * 2 }; // stereo → *2
     bool     eof      = 0;
     bool     error    = false;
+
+    // Seeking. Without a SEEKTABLE in the file, seekPoints (flacseek.h)
+    // get the decoder to the target frame; seekPending is the track
+    // whose points are still being built, retried on each seek.
+    bool           hasSeekTable = false;
+    FlacSeekPoints seekPoints;
+    TrackId        seekPending  = TRACK_ID_NONE;
+    bool           seeking      = false;   // write callback drops samples before seekTarget
+    uint64_t       seekTarget   = 0;
+
+    // Decode throughput, logged by flacClose
+    uint64_t decodeTicks   = 0;
+    uint64_t framesDecoded = 0;
 };
 
 /* -------------------------------------------------------
@@ -45,7 +67,7 @@ void flacClose(FlacDecoder* fd);
    Decoding
    Mirrors the mpg123_read() interface used in player.cpp:
      - fills `buffer` with up to `bufBytes` bytes of
-       int16_t stereo PCM at the file's native sample rate.
+       float32 stereo PCM at the file's native sample rate.
      - sets *bytesRead to actual bytes written.
      - returns FLAC_READ_OK, FLAC_READ_DONE, or FLAC_READ_ERR.
 ------------------------------------------------------- */
@@ -69,16 +91,11 @@ bool flacSeek(FlacDecoder* fd, uint64_t targetSample);
 // Folder tracking (shared concept with mp3 layer)
 bool flacIsFolderLoaded(const char* path);
 void flacSetLoadedFolder(const char* path);
-void flacCancelAllScans();
 
-// Background scanner lifecycle
-void flacStartBackgroundScanner();
-void flacStopBackgroundScanner();
+// Scanning runs on the shared scanner pool (scanpool.h)
 
 // Playlist
 bool flacAddToPlaylist(const char* path);
 void flacClearMetadata();
-void flacLoadCache(const char* folderKey);
 
-const Mp3MetadataEntry* flacGetTrackMetadata(int index);
-int                     flacGetPlaylistCount();
+int flacGetPlaylistCount();   // per-track metadata: playlistGetMetadata()
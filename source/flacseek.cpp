@@ -0,0 +1,403 @@
+#include "flacseek.h"
+#include "metacache.h"
+#include <switch.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#define FLAC_SEEKPOINT_WINDOW   (16 * 1024)        // per probe; grown to fit two max frames
+#define FLAC_SEEKPOINT_WINDOW_UNKNOWN (64 * 1024)  // STREAMINFO has no max frame size
+#define FLAC_HOP_BUFFER_BYTES   (64 * 1024)
+#define FLAC_HOP_MAX_BYTES      (16 * 1024 * 1024)  // give up and let libFLAC search
+#define FLAC_MAX_HEADER_BYTES   16
+#define FLAC_SEEKPOINT_VERSION  1
+
+/* -------------------------------------------------------
+   Frame headers
+------------------------------------------------------- */
+struct FlacFrameHeader
+{
+    uint64_t sample      = 0;   // first sample of the frame
+    uint32_t blockSize   = 0;
+    uint32_t headerBytes = 0;   // including the CRC-8
+};
+
+static inline uint32_t be16(const uint8_t* b) { return ((uint32_t)b[0] << 8) | b[1]; }
+static inline uint32_t be24(const uint8_t* b) { return ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2]; }
+
+static inline uint64_t be64(const uint8_t* b)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | b[i];
+    return v;
+}
+
+// CRC-8, polynomial x^8 + x^2 + x + 1, over the header bytes
+static uint8_t crc8(const uint8_t* p, size_t n)
+{
+    uint8_t crc = 0;
+    while (n--)
+    {
+        crc ^= *p++;
+        for (int b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static const uint32_t kFlacRates[12] = {
+    0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000
+};
+static const uint32_t kFlacBits[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+
+// True only for a complete, CRC-valid header that agrees with
+// STREAMINFO. Stray sync patterns in the audio rarely get past all of it.
+static bool parseFrameHeader(const uint8_t* p, size_t avail, const FlacSeekPoints& sp,
+                             FlacFrameHeader* out)
+{
+    if (avail < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8) return false;
+
+    bool     variable = (p[1] & 0x01) != 0;
+    uint32_t bsCode   = p[2] >> 4;
+    uint32_t srCode   = p[2] & 0x0F;
+    uint32_t chCode   = p[3] >> 4;
+    uint32_t bpsCode  = (p[3] >> 1) & 0x07;
+
+    if (bsCode == 0 || srCode == 15 || chCode > 10 || bpsCode == 3 || (p[3] & 0x01))
+        return false;
+    if (bpsCode && kFlacBits[bpsCode] != sp.bitsPerSample)
+        return false;
+    if (!variable && sp.blockSize == 0)
+        return false;
+
+    // Frame or sample number, UTF-8 style
+    size_t   pos = 4;
+    uint64_t num = p[pos++];
+    int      extra;
+    if      (!(num & 0x80))          { extra = 0; }
+    else if ((num & 0xE0) == 0xC0)   { extra = 1; num &= 0x1F; }
+    else if ((num & 0xF0) == 0xE0)   { extra = 2; num &= 0x0F; }
+    else if ((num & 0xF8) == 0xF0)   { extra = 3; num &= 0x07; }
+    else if ((num & 0xFC) == 0xF8)   { extra = 4; num &= 0x03; }
+    else if ((num & 0xFE) == 0xFC)   { extra = 5; num &= 0x01; }
+    else if (num == 0xFE && variable){ extra = 6; num  = 0;    }
+    else return false;
+
+    if (avail < pos + extra) return false;
+    for (int i = 0; i < extra; i++, pos++)
+    {
+        if ((p[pos] & 0xC0) != 0x80) return false;
+        num = (num << 6) | (p[pos] & 0x3F);
+    }
+
+    uint32_t blockSize;
+    if      (bsCode == 1) blockSize = 192;
+    else if (bsCode <= 5) blockSize = 576u << (bsCode - 2);
+    else if (bsCode == 6) { if (avail < pos + 1) return false; blockSize = p[pos] + 1u;        pos += 1; }
+    else if (bsCode == 7) { if (avail < pos + 2) return false; blockSize = be16(p + pos) + 1u; pos += 2; }
+    else                  blockSize = 256u << (bsCode - 8);
+
+    uint32_t rate;
+    if      (srCode == 12) { if (avail < pos + 1) return false; rate = p[pos] * 1000u;      pos += 1; }
+    else if (srCode == 13) { if (avail < pos + 2) return false; rate = be16(p + pos);       pos += 2; }
+    else if (srCode == 14) { if (avail < pos + 2) return false; rate = be16(p + pos) * 10u; pos += 2; }
+    else                   rate = kFlacRates[srCode];
+    if (rate && rate != sp.sampleRate) return false;
+
+    if (avail < pos + 1 || crc8(p, pos) != p[pos]) return false;
+
+    out->sample      = variable ? num : num * sp.blockSize;
+    out->blockSize   = blockSize;
+    out->headerBytes = (uint32_t)(pos + 1);
+    return sp.totalSamples == 0 || out->sample < sp.totalSamples;
+}
+
+#define FLAC_ANY_SAMPLE UINT64_MAX
+
+// First header starting in [from, end) of buf[0..len) whose first
+// sample is `want` (or any). Returns its index, or -1.
+static long findHeader(const uint8_t* buf, size_t len, size_t from, size_t end,
+                       const FlacSeekPoints& sp, uint64_t want, FlacFrameHeader* out)
+{
+    if (end > len) end = len;
+    size_t i = from;
+    while (i + 1 < end)
+    {
+        const uint8_t* hit = (const uint8_t*)memchr(buf + i, 0xFF, end - i - 1);
+        if (!hit) break;
+        i = (size_t)(hit - buf);
+
+        if ((buf[i + 1] & 0xFE) == 0xF8 &&
+            parseFrameHeader(buf + i, len - i, sp, out) &&
+            (want == FLAC_ANY_SAMPLE || out->sample == want))
+            return (long)i;
+        i++;
+    }
+    return -1;
+}
+
+// A header only counts once the frame after it is found where it
+// should be — the sample numbers must line up.
+static long findConfirmedHeader(const uint8_t* buf, size_t len, size_t from,
+                                const FlacSeekPoints& sp, FlacFrameHeader* out)
+{
+    FlacFrameHeader next;
+    long i = (long)from;
+    while ((i = findHeader(buf, len, (size_t)i, len, sp, FLAC_ANY_SAMPLE, out)) >= 0)
+    {
+        size_t skip = std::max<size_t>(out->headerBytes + 1, sp.minFrameBytes);
+        if (findHeader(buf, len, (size_t)i + skip, len, sp, out->sample + out->blockSize, &next) >= 0)
+            return i;
+        i++;
+    }
+    return -1;
+}
+
+/* -------------------------------------------------------
+   Building
+------------------------------------------------------- */
+bool flacBuildSeekPoints(const char* path, FlacSeekPoints* out)
+{
+    if (!path || !out) return false;
+    *out = FlacSeekPoints{};
+
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    u64 t0 = svcGetSystemTick();
+    uint8_t b[34];
+
+    // Tolerate an ID3v2 tag in front of the stream
+    if (fread(b, 1, 4, f) != 4) { fclose(f); return false; }
+    if (memcmp(b, "ID3", 3) == 0)
+    {
+        if (fread(b + 4, 1, 6, f) != 6) { fclose(f); return false; }
+        long tagBytes = 10 + (long)(((b[6] & 0x7F) << 21) | ((b[7] & 0x7F) << 14) |
+                                    ((b[8] & 0x7F) << 7)  |  (b[9] & 0x7F));
+        if (b[5] & 0x10) tagBytes += 10;   // footer
+        if (fseek(f, tagBytes, SEEK_SET) != 0 || fread(b, 1, 4, f) != 4) { fclose(f); return false; }
+    }
+    if (memcmp(b, "fLaC", 4) != 0) { fclose(f); return false; }
+
+    // Metadata blocks: STREAMINFO and whether a SEEKTABLE is worth anything
+    bool     haveInfo   = false;
+    bool     last       = false;
+    uint32_t channels   = 0;
+    uint32_t maxFrame   = 0;
+    while (!last)
+    {
+        if (fread(b, 1, 4, f) != 4) { fclose(f); return false; }
+        last = (b[0] & 0x80) != 0;
+        uint32_t type = b[0] & 0x7F;
+        uint32_t len  = be24(b + 1);
+        if (type == 127) { fclose(f); return false; }
+
+        if (type == 0 && len >= 34 && fread(b, 1, 34, f) == 34)
+        {
+            uint32_t maxBlock = be16(b + 2);
+            out->minFrameBytes = be24(b + 4);
+            maxFrame           = be24(b + 7);
+            out->sampleRate    = (be24(b + 10) >> 4);
+            channels           = ((b[12] >> 1) & 0x07) + 1;
+            out->bitsPerSample = (((b[12] & 0x01) << 4) | (b[13] >> 4)) + 1;
+            out->totalSamples  = ((uint64_t)(b[13] & 0x0F) << 32) |
+                                 ((uint64_t)b[14] << 24) | ((uint64_t)b[15] << 16) |
+                                 ((uint64_t)b[16] << 8)  |  (uint64_t)b[17];
+            out->blockSize     = maxBlock;
+            haveInfo           = out->sampleRate > 0;
+            len -= 34;
+        }
+        else if (type == 3)
+        {
+            // 18 bytes per point; placeholders have sample 0xFFFF...
+            uint8_t pt[18];
+            for (; len >= 18; len -= 18)
+            {
+                if (fread(pt, 1, 18, f) != 18) { fclose(f); return false; }
+                if (be64(pt) != UINT64_MAX) out->hasSeekTable = true;
+            }
+        }
+        if (len && fseek(f, (long)len, SEEK_CUR) != 0) { fclose(f); return false; }
+    }
+
+    if (!haveInfo) { fclose(f); return false; }
+    if (out->hasSeekTable) { fclose(f); return true; }
+
+    long audioStart = ftell(f);
+    fseek(f, 0, SEEK_END);
+    long fileBytes = ftell(f);
+    if (audioStart <= 0 || fileBytes <= audioStart) { fclose(f); return false; }
+    uint64_t audioBytes = (uint64_t)(fileBytes - audioStart);
+
+    size_t window = maxFrame
+        ? std::max<size_t>(FLAC_SEEKPOINT_WINDOW, (size_t)maxFrame * 2 + FLAC_MAX_HEADER_BYTES)
+        : FLAC_SEEKPOINT_WINDOW_UNKNOWN;
+    std::vector<uint8_t> buf(window);
+
+    // Probes are spread evenly over the bytes, one per FLAC_SEEKPOINT_SECONDS
+    // of audio (estimated at 60% of PCM size when the length is unknown)
+    uint64_t seconds = out->totalSamples
+        ? out->totalSamples / out->sampleRate
+        : audioBytes / ((uint64_t)out->sampleRate * channels * out->bitsPerSample / 8 * 6 / 10 + 1);
+    uint64_t probes = std::max<uint64_t>(1, seconds / FLAC_SEEKPOINT_SECONDS);
+
+    uint64_t bytesRead = 0;
+    for (uint64_t k = 0; k < probes; k++)
+    {
+        uint64_t at = (uint64_t)audioStart + audioBytes * k / probes;
+        if (!out->points.empty() && at <= out->points.back().offset) continue;
+
+        if (fseek(f, (long)at, SEEK_SET) != 0) break;
+        size_t n = fread(buf.data(), 1, window, f);
+        bytesRead += n;
+
+        FlacFrameHeader h;
+        long i = findConfirmedHeader(buf.data(), n, 0, *out, &h);
+        if (i < 0) continue;
+
+        // The first frame must be exactly where the metadata ends
+        if (k == 0 && i != 0) { fclose(f); out->points.clear(); return false; }
+        if (!out->points.empty() && h.sample <= out->points.back().sample) continue;
+
+        out->points.push_back({ h.sample, at + (uint64_t)i });
+    }
+    fclose(f);
+
+    double ms = (svcGetSystemTick() - t0) / 19200.0;
+    printf("[FLAC] Seek points: %zu from %llu probes in %.1f ms (%llu KB read)\n",
+           out->points.size(), (unsigned long long)probes, ms,
+           (unsigned long long)(bytesRead / 1024));
+    return !out->points.empty();
+}
+
+/* -------------------------------------------------------
+   Metadata cache blob
+------------------------------------------------------- */
+struct FlacSeekBlob
+{
+    uint32_t version;
+    uint32_t hasSeekTable;
+    uint32_t sampleRate;
+    uint32_t bitsPerSample;
+    uint32_t blockSize;
+    uint32_t minFrameBytes;
+    uint64_t totalSamples;
+    uint32_t count;
+    uint32_t reserved;
+    // FlacSeekPoint points[count] follow
+};
+
+void flacSeekPointsSave(const char* path, const FlacSeekPoints& sp)
+{
+    if (!path) return;
+
+    size_t bytes = sizeof(FlacSeekBlob) + sp.points.size() * sizeof(FlacSeekPoint);
+    std::vector<uint8_t> blob(bytes);
+    FlacSeekBlob hdr{};
+    hdr.version       = FLAC_SEEKPOINT_VERSION;
+    hdr.hasSeekTable  = sp.hasSeekTable ? 1 : 0;
+    hdr.sampleRate    = sp.sampleRate;
+    hdr.bitsPerSample = sp.bitsPerSample;
+    hdr.blockSize     = sp.blockSize;
+    hdr.minFrameBytes = sp.minFrameBytes;
+    hdr.totalSamples  = sp.totalSamples;
+    hdr.count         = (uint32_t)sp.points.size();
+
+    memcpy(blob.data(), &hdr, sizeof(hdr));
+    if (!sp.points.empty())
+        memcpy(blob.data() + sizeof(hdr), sp.points.data(), sp.points.size() * sizeof(FlacSeekPoint));
+    metaCachePutBlob(path, FLAC_SEEKPOINT_BLOB_TAG, blob.data(), blob.size());
+}
+
+bool flacSeekPointsLoad(const char* path, FlacSeekPoints* out)
+{
+    if (!path || !out) return false;
+
+    std::vector<uint8_t> blob;
+    if (!metaCacheGetBlob(path, FLAC_SEEKPOINT_BLOB_TAG, &blob) || blob.size() < sizeof(FlacSeekBlob))
+        return false;
+
+    FlacSeekBlob hdr;
+    memcpy(&hdr, blob.data(), sizeof(hdr));
+    if (hdr.version != FLAC_SEEKPOINT_VERSION ||
+        blob.size() != sizeof(hdr) + (size_t)hdr.count * sizeof(FlacSeekPoint))
+        return false;
+
+    *out = FlacSeekPoints{};
+    out->hasSeekTable  = hdr.hasSeekTable != 0;
+    out->sampleRate    = hdr.sampleRate;
+    out->bitsPerSample = hdr.bitsPerSample;
+    out->blockSize     = hdr.blockSize;
+    out->minFrameBytes = hdr.minFrameBytes;
+    out->totalSamples  = hdr.totalSamples;
+    out->points.resize(hdr.count);
+    if (hdr.count)
+        memcpy(out->points.data(), blob.data() + sizeof(hdr), (size_t)hdr.count * sizeof(FlacSeekPoint));
+    return true;
+}
+
+/* -------------------------------------------------------
+   Seeking
+------------------------------------------------------- */
+bool flacSeekFindFrame(ReadAheadStream* io, const FlacSeekPoints& sp, uint64_t target,
+                       uint64_t* frameOffset, uint64_t* frameSample)
+{
+    if (!io || sp.points.empty()) return false;
+
+    auto it = std::upper_bound(sp.points.begin(), sp.points.end(), target,
+                               [](uint64_t t, const FlacSeekPoint& p) { return t < p.sample; });
+    if (it == sp.points.begin()) return false;
+    --it;
+
+    std::vector<uint8_t> buf(FLAC_HOP_BUFFER_BYTES);
+    uint64_t bufStart = 0;
+    size_t   bufLen   = 0;
+    auto fill = [&](uint64_t at) -> bool {
+        if (!readAheadSeek(io, (int64_t)at, SEEK_SET)) return false;
+        bufStart = at;
+        bufLen   = readAheadRead(io, buf.data(), buf.size());
+        return bufLen > 0;
+    };
+
+    FlacFrameHeader cur;
+    if (!fill(it->offset) ||
+        !parseFrameHeader(buf.data(), bufLen, sp, &cur) || cur.sample != it->sample)
+        return false;   // stale point — the file changed under the cache
+    uint64_t curOffset = it->offset;
+
+    // Hop header to header; nothing is decoded
+    while (target >= cur.sample + cur.blockSize)
+    {
+        uint64_t want = cur.sample + cur.blockSize;
+        uint64_t from = curOffset + std::max<uint64_t>(cur.headerBytes + 1, sp.minFrameBytes);
+
+        while (true)
+        {
+            if (from - it->offset > FLAC_HOP_MAX_BYTES) return false;
+
+            bool   atEof = bufLen < buf.size();
+            size_t limit = atEof ? bufLen : bufLen - FLAC_MAX_HEADER_BYTES;   // whole header in view
+            if (from < bufStart || from >= bufStart + limit)
+            {
+                if (atEof && from >= bufStart) return false;
+                if (!fill(from)) return false;
+                continue;
+            }
+
+            FlacFrameHeader next;
+            long i = findHeader(buf.data(), bufLen, (size_t)(from - bufStart), limit, sp, want, &next);
+            if (i >= 0)
+            {
+                curOffset = bufStart + (uint64_t)i;
+                cur       = next;
+                break;
+            }
+            if (atEof) return false;
+            from = bufStart + limit;
+        }
+    }
+
+    *frameOffset = curOffset;
+    *frameSample = cur.sample;
+    return true;
+}
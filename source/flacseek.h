@@ -0,0 +1,57 @@
+#pragma once
+#include "readahead.h"
+#include <stdint.h>
+#include <vector>
+
+/* -------------------------------------------------------
+   FLAC seek points
+   Files without a SEEKTABLE block make libFLAC's
+   seek_absolute() bisect the whole stream, decoding a frame
+   at every probe. This builds a sparse table instead: one
+   (sample, byte offset) pair about every
+   FLAC_SEEKPOINT_SECONDS of audio, found by reading a small
+   window at each interpolated byte position and parsing the
+   FLAC frame headers in it (CRC-8 checked, and confirmed by
+   the frame that follows). Nothing is decoded.
+
+   At seek time the point at or before the target is the
+   starting line; flacSeekFindFrame() hops frame header to
+   frame header from there to the frame holding the target,
+   and only that frame is decoded.
+
+   Files that do carry a SEEKTABLE are recorded as such and
+   left to libFLAC.
+------------------------------------------------------- */
+#define FLAC_SEEKPOINT_SECONDS  2
+#define FLAC_SEEKPOINT_BLOB_TAG 0x4B53464Cu   // 'LFSK' — metacache blob tag
+
+struct FlacSeekPoint
+{
+    uint64_t sample;   // first sample of the frame
+    uint64_t offset;   // byte offset of its header
+};
+
+struct FlacSeekPoints
+{
+    bool     hasSeekTable  = false;   // the file has its own; use libFLAC
+    uint32_t sampleRate    = 0;
+    uint32_t bitsPerSample = 0;
+    uint32_t blockSize     = 0;       // STREAMINFO max, for fixed-blocksize streams
+    uint32_t minFrameBytes = 0;       // STREAMINFO, 0 = unknown
+    uint64_t totalSamples  = 0;
+    std::vector<FlacSeekPoint> points;   // ascending; points[0] is the first frame
+};
+
+// Reads the file's metadata blocks and, when there is no
+// SEEKTABLE, probes for seek points. False if it isn't FLAC.
+bool flacBuildSeekPoints(const char* path, FlacSeekPoints* out);
+
+// Seek points <-> metadata cache blob
+void flacSeekPointsSave(const char* path, const FlacSeekPoints& sp);
+bool flacSeekPointsLoad(const char* path, FlacSeekPoints* out);
+
+// Byte offset and first sample of the frame holding `target`,
+// found by walking frame headers from the nearest seek point.
+// Moves the stream's read position.
+bool flacSeekFindFrame(ReadAheadStream* io, const FlacSeekPoints& sp, uint64_t target,
+                       uint64_t* frameOffset, uint64_t* frameSample);
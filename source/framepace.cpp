@@ -0,0 +1,121 @@
+#include "framepace.h"
+
+#define TICKS_PER_SEC      19200000ULL
+#define INTERACTIVE_HOLD   (TICKS_PER_SEC)        // stay at 60 fps this long after input
+#define POLL_TICKS         (TICKS_PER_SEC / 60)   // one loop pass in focus
+#define POLL_TICKS_BG      (TICKS_PER_SEC / 10)   // out of focus
+
+/* -------------------------------------------------------
+   State (main thread)
+------------------------------------------------------- */
+static const u64 g_frameInterval[FRAME_PACE_MODES] =
+{
+    TICKS_PER_SEC / 60,   // interactive
+    TICKS_PER_SEC / 15,   // spectrum
+    TICKS_PER_SEC,        // idle
+    0,                    // background: never
+};
+
+static FramePaceMode  g_mode       = FRAME_PACE_INTERACTIVE;
+static u64            g_lastInput  = 0;
+static u64            g_lastFrame  = 0;
+static bool           g_wake       = true;    // draw on the next pass
+static u64            g_statsStart = 0;
+static FramePaceStats g_fpStats;
+
+/* -------------------------------------------------------
+   Mode
+------------------------------------------------------- */
+void framePaceInput(u64 now)
+{
+    g_lastInput = now;
+    g_wake      = true;
+}
+
+FramePaceMode framePaceSelect(u64 now, bool playing, bool overlayOpen,
+                              bool scrubbing, bool inFocus)
+{
+    FramePaceMode mode;
+    if (!inFocus)
+        mode = FRAME_PACE_BACKGROUND;
+    else if (scrubbing || (g_lastInput && now - g_lastInput < INTERACTIVE_HOLD))
+        mode = FRAME_PACE_INTERACTIVE;
+    else if (playing || overlayOpen)
+        mode = FRAME_PACE_SPECTRUM;
+    else
+        mode = FRAME_PACE_IDLE;
+
+    if (!g_statsStart) g_statsStart = now;
+
+    // Back in focus: draw straight away rather than on the next interval
+    if (mode != g_mode && g_mode == FRAME_PACE_BACKGROUND)
+        g_wake = true;
+
+    g_mode = mode;
+    return mode;
+}
+
+bool framePaceFrameDue(u64 now)
+{
+    if (g_mode == FRAME_PACE_BACKGROUND) return false;
+    if (g_wake) return true;
+
+    // Half a pass of slack, so 15 fps lands on every fourth
+    // 60 Hz pass instead of drifting to every fifth
+    return now - g_lastFrame + POLL_TICKS / 2 >= g_frameInterval[g_mode];
+}
+
+void framePaceFramePresented(u64 now)
+{
+    g_lastFrame = now;
+    g_wake      = false;
+    g_fpStats.frames[g_mode]++;
+}
+
+void framePaceSleep(u64 loopStart)
+{
+    u64 pass = (g_mode == FRAME_PACE_BACKGROUND) ? POLL_TICKS_BG : POLL_TICKS;
+    u64 now  = svcGetSystemTick();
+
+    // A vsynced present usually uses up the pass by itself
+    if (now - loopStart < pass)
+    {
+        u64 rest = pass - (now - loopStart);
+        svcSleepThread((s64)(rest * 1000000000ULL / TICKS_PER_SEC));
+        g_fpStats.ticks[FRAME_PHASE_SLEEP] += svcGetSystemTick() - now;
+    }
+
+    g_fpStats.loops++;
+}
+
+/* -------------------------------------------------------
+   Stats
+------------------------------------------------------- */
+void framePaceAddPhase(FramePhase phase, u64 ticks)
+{
+    g_fpStats.ticks[phase] += ticks;
+}
+
+const char* framePaceModeName(FramePaceMode mode)
+{
+    switch (mode)
+    {
+        case FRAME_PACE_INTERACTIVE: return "interactive";
+        case FRAME_PACE_SPECTRUM:    return "spectrum";
+        case FRAME_PACE_IDLE:        return "idle";
+        case FRAME_PACE_BACKGROUND:  return "background";
+        default:                     return "?";
+    }
+}
+
+FramePaceStats framePaceTakeStats()
+{
+    u64 now = svcGetSystemTick();
+
+    FramePaceStats s = g_fpStats;
+    s.windowTicks = g_statsStart ? now - g_statsStart : 0;
+
+    g_fpStats    = FramePaceStats{};
+    g_statsStart = now;
+    return s;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <switch.h>
+#include <stdint.h>
+
+/* -------------------------------------------------------
+   Frame pacing
+   The main loop reads input and runs its updates on every
+   pass (about 60 Hz), but renders and presents only when
+   the current mode's frame interval has passed:
+
+     interactive  60 fps  input in the last second, or a
+                          scrub in progress
+     spectrum     15 fps  playing, or an overlay open
+     idle          1 fps  stopped or paused, nothing moving
+     background    0 fps  out of focus (HOME menu, screen
+                          off); input is polled at 10 Hz
+
+   Input switches to interactive before that pass renders,
+   so a press is drawn on the pass that read it. Decoding
+   runs on its own thread and is not affected.
+------------------------------------------------------- */
+enum FramePaceMode
+{
+    FRAME_PACE_INTERACTIVE = 0,
+    FRAME_PACE_SPECTRUM,
+    FRAME_PACE_IDLE,
+    FRAME_PACE_BACKGROUND,
+    FRAME_PACE_MODES
+};
+
+enum FramePhase
+{
+    FRAME_PHASE_INPUT = 0,
+    FRAME_PHASE_UPDATE,
+    FRAME_PHASE_RENDER,
+    FRAME_PHASE_PRESENT,
+    FRAME_PHASE_SLEEP,
+    FRAME_PHASES
+};
+
+struct FramePaceStats
+{
+    uint32_t loops                    = 0;
+    uint32_t frames[FRAME_PACE_MODES] = {};   // presented, by mode
+    u64      ticks[FRAME_PHASES]      = {};
+    u64      windowTicks              = 0;    // wall time covered
+};
+
+// Any button, stick or touch this pass
+void framePaceInput(u64 now);
+
+// Picks the mode for this pass
+FramePaceMode framePaceSelect(u64 now, bool playing, bool overlayOpen,
+                              bool scrubbing, bool inFocus);
+
+// True when this pass should render and present
+bool framePaceFrameDue(u64 now);
+void framePaceFramePresented(u64 now);
+
+// Sleeps out the rest of the pass that started at loopStart
+void framePaceSleep(u64 loopStart);
+
+void framePaceAddPhase(FramePhase phase, u64 ticks);
+
+const char* framePaceModeName(FramePaceMode mode);
+
+// Counters since the last call, then reset
+FramePaceStats framePaceTakeStats();
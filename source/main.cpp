@@ -2,6 +2,7 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
+#include <stdio.h>
 #include "ui.h"
 #include "mp3.h"
 #include "flac.h"
@@ -11,16 +12,24 @@
 #include "filebrowser.h"
 #include "playlist.h"
 #include "player.h"
+#include "metacache.h"
+#include "scanpool.h"
 #include "player_state.h"
 #include "controller.h"
 
 #include "settings.h"
 #include "settings_state.h"
 #include "touchscreen.h"
+#include "textatlas.h"
+#include "spectrum_view.h"
+#include "spectrum.h"
+#include "framepace.h"
 
 #define FB_W 1920
 #define FB_H 1080
 
+#define FRAME_STATS_TICKS (10ULL * 19200000ULL)   // log render time every 10 s
+
 static u64 lastPlaybackActivityTick = 0;
 static bool stayAwakeActive = true;
 int selectedBand = 1;
@@ -37,6 +46,88 @@ struct ScrubState
 
 static ScrubState g_scrub;
 
+// Render-time stats (clear → just before present), per stats window
+struct FrameStats
+{
+    uint32_t frames      = 0;
+    u64      ticks       = 0;
+    u64      maxTicks    = 0;
+    u64      windowStart = 0;
+};
+
+static FrameStats g_frameStats;
+
+static void frameStatsAdd(u64 ticks)
+{
+    FrameStats& f = g_frameStats;
+    f.frames++;
+    f.ticks += ticks;
+    if (ticks > f.maxTicks) f.maxTicks = ticks;
+}
+
+// Logs once per window of wall time; frames per window depend on pacing
+static void frameStatsLog(u64 now)
+{
+    FrameStats& f = g_frameStats;
+    if (!f.windowStart) f.windowStart = now;
+    if (now - f.windowStart < FRAME_STATS_TICKS) return;
+
+    FramePaceStats ps = framePaceTakeStats();
+    if (ps.loops)
+    {
+        uint32_t presented = 0;
+        for (int m = 0; m < FRAME_PACE_MODES; m++) presented += ps.frames[m];
+
+        printf("[UI] pacing: %u frames / %u loops (%u %s, %u %s, %u %s); "
+               "input %.3f, update %.3f ms/loop; render %.2f, present %.2f ms/frame; "
+               "asleep %.0f%%\n",
+               presented, ps.loops,
+               ps.frames[FRAME_PACE_INTERACTIVE], framePaceModeName(FRAME_PACE_INTERACTIVE),
+               ps.frames[FRAME_PACE_SPECTRUM],    framePaceModeName(FRAME_PACE_SPECTRUM),
+               ps.frames[FRAME_PACE_IDLE],        framePaceModeName(FRAME_PACE_IDLE),
+               ps.ticks[FRAME_PHASE_INPUT]  / 19200.0 / ps.loops,
+               ps.ticks[FRAME_PHASE_UPDATE] / 19200.0 / ps.loops,
+               presented ? ps.ticks[FRAME_PHASE_RENDER]  / 19200.0 / presented : 0.0,
+               presented ? ps.ticks[FRAME_PHASE_PRESENT] / 19200.0 / presented : 0.0,
+               ps.windowTicks ? 100.0 * ps.ticks[FRAME_PHASE_SLEEP] / ps.windowTicks : 0.0);
+    }
+
+    if (f.frames)
+    {
+        const char* screen = fileBrowserIsActive() ? "file browser"
+                           : settingsIsOpen()      ? "settings"
+                           :                         "player + playlist";
+        TextAtlasStats    ts = textAtlasTakeStats();
+        SpectrumViewStats ss = spectrumViewTakeStats();
+        printf("[UI] %s: render avg %.2f ms, max %.2f ms; text %u strings, %u glyphs, "
+               "%u rasterised per %u frames\n",
+               screen, f.ticks / 19200.0 / f.frames, f.maxTicks / 19200.0,
+               ts.strings, ts.glyphs, ts.rasterised, f.frames);
+        SpectrumEngineStats es = spectrumEngineTakeStats();
+        if (ss.frames)
+            printf("[UI] spectrum: analysis %.3f ms/frame, %.1f draw calls/frame (%.1f quads), "
+                   "per-column fill was %.1f\n",
+                   es.runs ? es.ticks / 19200.0 / es.runs : 0.0,
+                   (double)ss.drawCalls / ss.frames, (double)ss.quads / ss.frames,
+                   (double)ss.legacyCalls / ss.frames);
+        UiRenderStats us = uiTakeRenderStats();
+        if (us.frames)
+            printf("[UI] base layer: %u rebuilds, %u region redraws; %.1f draw calls/frame "
+                   "for skin + widgets, direct drawing was %.1f; EQ curve baked %u times\n",
+                   us.baseRebuilds, us.regionRedraws,
+                   (double)us.baseDraws / us.frames, (double)us.directDraws / us.frames,
+                   us.eqCurveBuilds);
+    }
+
+    EqCoefStats qs = eqTakeCoefStats();
+    if (qs.bandChanges || qs.recomputes)
+        printf("[EQ] %u band changes, %u coefficient sets in %u blocks, %u moves under %.2f dB kept\n",
+               qs.bandChanges, qs.recomputes, qs.batches, qs.skipped, EQ_COEF_THRESHOLD_DB);
+
+    f = FrameStats{};
+    f.windowStart = now;
+}
+
 void updateStayAwakeLogic()
 {
     u64 now = svcGetSystemTick();
@@ -66,10 +157,7 @@ void updateStayAwakeLogic()
 int main()
 {
     romfsInit();
-    mp3StartBackgroundScanner();
-    flacStartBackgroundScanner();
-    oggStartBackgroundScanner();
-    wavStartBackgroundScanner();
+    scanPoolStart(0); // one worker per core
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
     TTF_Init();
     IMG_Init(IMG_INIT_PNG);
@@ -81,7 +169,7 @@ int main()
         SDL_WINDOW_SHOWN | SDL_WINDOW_FULLSCREEN_DESKTOP
     );
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
     TTF_Font* font = TTF_OpenFont("romfs:/fonts/arial.ttf", 32);
@@ -104,7 +192,8 @@ int main()
 
     while (appletMainLoop())
     {
-        updateStayAwakeLogic();
+        u64 loopStart = svcGetSystemTick();
+
         //New controller inputs
         controllerUpdate();
         PadState* pad = controllerGetPad();
@@ -125,12 +214,14 @@ int main()
         if (fileBrowserIsActive())
         {
             // Filebrowser owns ALL input — player and settings get nothing.
+            controllerCancelScrub();
             fileBrowserUpdate(pad);
         }
         else if (settingsIsOpen())
         {
             // Settings owns ALL input — player gets nothing.
             // StickL while settings is open is ignored (already open).
+            controllerCancelScrub();
             settingsHandleInput(pad);
         }
         else
@@ -139,12 +230,14 @@ int main()
             // Open filebrowser with B.
             if (down & HidNpadButton_B)
             {
+                controllerCancelScrub();
                 playerStop();
                 fileBrowserOpen();
             }
             // Open settings with StickL.
             else if (down & HidNpadButton_StickL)
             {
+                controllerCancelScrub();
                 settingsOpen();
             }
             else
@@ -156,43 +249,75 @@ int main()
         }
         touchUpdate();
         touchHandleInput(fileBrowserIsActive(), settingsIsOpen());
+
+        // Held buttons include stick deflection
+        if (down || up || padGetButtons(pad) || touchIsActive())
+            framePaceInput(now);
+
+        u64 updateStart = svcGetSystemTick();
+        framePaceAddPhase(FRAME_PHASE_INPUT, updateStart - loopStart);
+
+        updateStayAwakeLogic();
         updateAutoEQ();
-        playerUpdate();
 
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        u64 renderStart = svcGetSystemTick();
+        framePaceAddPhase(FRAME_PHASE_UPDATE, renderStart - updateStart);
+
+        framePaceSelect(renderStart,
+                        playerIsPlaying() && !playerIsPaused(),
+                        fileBrowserIsActive() || settingsIsOpen(),
+                        playerIsScrubbing(),
+                        appletGetFocusState() == AppletFocusState_InFocus);
 
-        char songText[256] = "WINamp By DcNigma";
-        int idx = playerGetCurrentTrackIndex();
-        if (idx >= 0)
+        if (framePaceFrameDue(renderStart))
         {
-            const Mp3MetadataEntry* md = mp3GetTrackMetadata(idx);
-            if (!md) md = flacGetTrackMetadata(idx);
-            if (!md) md = oggGetTrackMetadata(idx);
-            if (!md) md = wavGetTrackMetadata(idx);
-            if (md)
-                snprintf(songText, sizeof(songText), "%d. %s - %s",
-                         idx + 1,
-                         md->artist[0] ? md->artist : "Unknown",
-                         md->title[0]  ? md->title  : "Unknown");
-        }
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+
+            char songText[256] = "WINamp By DcNigma";
+            int idx = playerGetCurrentTrackIndex();
+            if (idx >= 0)
+            {
+                const Mp3MetadataEntry* md = playlistGetMetadata(idx);
+                if (md)
+                    snprintf(songText, sizeof(songText), "%d. %s - %s",
+                             idx + 1,
+                             md->artist[0] ? md->artist : "Unknown",
+                             md->title[0]  ? md->title  : "Unknown");
+            }
+
+            uiRender(renderer, font, fontBig, skin,
+                     texProgIndicator, texVolume, texPan,
+                     texPlaylistKnob, texCbuttons, texSHUFREP,texEQMAIN,
+                     songText);
 
-        uiRender(renderer, font, fontBig, skin,
-                 texProgIndicator, texVolume, texPan,
-                 texPlaylistKnob, texCbuttons, texSHUFREP,texEQMAIN,
-                 songText);
+            renderPlaylist(renderer, font);
+            fileBrowserRender(renderer, font);
+            settingsRender(renderer, font);
+
+            u64 presentStart = svcGetSystemTick();
+            frameStatsAdd(presentStart - renderStart);
+            framePaceAddPhase(FRAME_PHASE_RENDER, presentStart - renderStart);
+
+            SDL_RenderPresent(renderer);
+
+            u64 presented = svcGetSystemTick();
+            framePaceAddPhase(FRAME_PHASE_PRESENT, presented - presentStart);
+            framePaceFramePresented(presented);
+        }
 
-        renderPlaylist(renderer, font);
-        fileBrowserRender(renderer, font);
-        settingsRender(renderer, font);
-        SDL_RenderPresent(renderer);
+        frameStatsLog(svcGetSystemTick());
+        framePaceSleep(loopStart);
     }
 
-    mp3StopBackgroundScanner();
-    flacStopBackgroundScanner();
-    oggStopBackgroundScanner();
-    wavStopBackgroundScanner();
-    playerStop();
+    // The decode thread submits scan jobs and writes the cache, so it
+    // goes first
+    playerShutdown();
+    scanPoolStop();
+    metaCacheShutdown();
+    uiShutdown();
+    textAtlasShutdown();
+    spectrumViewShutdown();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     IMG_Quit();
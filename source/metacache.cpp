@@ -0,0 +1,597 @@
+#include "metacache.h"
+#include <switch.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#include <string>
+#include <unordered_map>
+
+/* -------------------------------------------------------
+   Journal layout
+     JournalHeader, then records back to back:
+       RecordHeader | path bytes (no NUL) | payload
+     payload = FileStamp, then
+       REC_META: Mp3MetadataEntry
+       REC_BLOB: uint32 tag, blob bytes
+   The CRC covers everything in the record after the crc
+   field itself. A later record for the same key wins.
+------------------------------------------------------- */
+#define METACACHE_MAGIC        0x4A43434D   // 'MCCJ'
+#define METACACHE_VERSION      1
+#define METACACHE_BATCH        64           // records per append
+#define METACACHE_BATCH_SECS   2            // max age of a pending record
+#define METACACHE_COMPACT_MIN  1024         // dead records before compacting
+#define METACACHE_MAX_PAYLOAD  (16u << 20)  // sanity bound when loading
+
+enum RecordType : uint16_t { REC_META = 1, REC_BLOB = 2 };
+
+struct JournalHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t metaSize;    // sizeof(Mp3MetadataEntry) — layout guard
+};
+
+struct RecordHeader
+{
+    uint32_t crc;
+    uint16_t type;
+    uint16_t pathLen;
+    uint32_t payloadLen;
+};
+
+struct FileStamp
+{
+    int64_t mtime;
+    int64_t size;
+};
+
+struct CacheBlob
+{
+    uint32_t             tag;
+    FileStamp            stamp;
+    std::vector<uint8_t> data;
+};
+
+struct CacheEntry
+{
+    bool                   hasMeta = false;
+    FileStamp              stamp{};
+    Mp3MetadataEntry       meta{};
+    std::vector<CacheBlob> blobs;
+};
+
+/* -------------------------------------------------------
+   State
+   g_mcMutex guards the map and the pending batch;
+   g_mcFileMutex serialises journal writes so batches land
+   in order while lookups carry on.
+------------------------------------------------------- */
+static std::unordered_map<std::string, CacheEntry> g_mcEntries;
+static std::vector<uint8_t> g_mcPending;           // serialised records
+static size_t               g_mcPendingCount = 0;
+static time_t               g_mcPendingSince = 0;
+static time_t               g_mcRetryAt      = 0;  // no automatic flush before this
+static size_t               g_mcRecords      = 0;  // records in the journal file
+static size_t               g_mcLive         = 0;  // metas + blobs in memory
+static bool                 g_mcLoaded       = false;
+static bool                 g_mcTorn         = false;  // journal ends in a partial record
+static Mutex                g_mcMutex;
+static Mutex                g_mcFileMutex;
+
+/* -------------------------------------------------------
+   CRC-32 (IEEE 802.3, reflected)
+------------------------------------------------------- */
+static uint32_t g_crcTable[256];
+
+static void crcInit()
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        g_crcTable[i] = c;
+    }
+}
+
+static uint32_t crcUpdate(uint32_t crc, const void* data, size_t len)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (len--)
+        crc = g_crcTable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t recordCrc(const RecordHeader& h, const char* path, const uint8_t* payload)
+{
+    uint32_t crc = crcUpdate(0, (const uint8_t*)&h + sizeof(h.crc), sizeof(h) - sizeof(h.crc));
+    crc = crcUpdate(crc, path, h.pathLen);
+    return crcUpdate(crc, payload, h.payloadLen);
+}
+
+/* -------------------------------------------------------
+   Helpers
+------------------------------------------------------- */
+static void ensureCacheDir()
+{
+    mkdir("sdmc:/config",        0777);
+    mkdir("sdmc:/config/winamp", 0777);
+}
+
+static bool statStamp(const char* path, FileStamp* out)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    out->mtime = (int64_t)st.st_mtime;
+    out->size  = (int64_t)st.st_size;
+    return true;
+}
+
+static bool sameStamp(const FileStamp& a, const FileStamp& b)
+{
+    return a.mtime == b.mtime && a.size == b.size;
+}
+
+// Append one serialised record to `out`
+static void serialiseRecord(std::vector<uint8_t>& out, RecordType type,
+                            const std::string& path, const FileStamp& stamp,
+                            const void* body, size_t bodyLen,
+                            const void* extra = nullptr, size_t extraLen = 0)
+{
+    RecordHeader h{};
+    h.type       = type;
+    h.pathLen    = (uint16_t)path.size();
+    h.payloadLen = (uint32_t)(sizeof(FileStamp) + bodyLen + extraLen);
+
+    size_t base = out.size();
+    out.resize(base + sizeof(h) + h.pathLen + h.payloadLen);
+    uint8_t* p       = out.data() + base;
+    uint8_t* payload = p + sizeof(h) + h.pathLen;
+
+    memcpy(p + sizeof(h), path.data(), h.pathLen);
+    memcpy(payload, &stamp, sizeof(stamp));
+    memcpy(payload + sizeof(stamp), body, bodyLen);
+    if (extraLen)
+        memcpy(payload + sizeof(stamp) + bodyLen, extra, extraLen);
+
+    h.crc = recordCrc(h, path.data(), payload);
+    memcpy(p, &h, sizeof(h));
+}
+
+static void serialiseEntry(std::vector<uint8_t>& out, const std::string& path,
+                           const CacheEntry& e)
+{
+    if (e.hasMeta)
+        serialiseRecord(out, REC_META, path, e.stamp, &e.meta, sizeof(e.meta));
+    for (const CacheBlob& b : e.blobs)
+        serialiseRecord(out, REC_BLOB, path, b.stamp, &b.tag, sizeof(b.tag),
+                        b.data.data(), b.data.size());
+}
+
+// Apply a record to the in-memory map (g_mcMutex held, or load time)
+static void applyMeta(const std::string& path, const FileStamp& stamp,
+                      const Mp3MetadataEntry& meta)
+{
+    CacheEntry& e = g_mcEntries[path];
+    if (!e.hasMeta) g_mcLive++;
+    e.hasMeta = true;
+    e.stamp   = stamp;
+    e.meta    = meta;
+}
+
+static void applyBlob(const std::string& path, const FileStamp& stamp,
+                      uint32_t tag, const uint8_t* data, size_t len)
+{
+    CacheEntry& e = g_mcEntries[path];
+    for (CacheBlob& b : e.blobs)
+    {
+        if (b.tag != tag) continue;
+        b.stamp = stamp;
+        b.data.assign(data, data + len);
+        return;
+    }
+    e.blobs.push_back({ tag, stamp, std::vector<uint8_t>(data, data + len) });
+    g_mcLive++;
+}
+
+/* -------------------------------------------------------
+   Journal writes  (g_mcFileMutex held)
+------------------------------------------------------- */
+static bool writeHeader(FILE* f)
+{
+    JournalHeader h{ METACACHE_MAGIC, METACACHE_VERSION, (uint32_t)sizeof(Mp3MetadataEntry) };
+    return fwrite(&h, sizeof(h), 1, f) == 1;
+}
+
+// True once the batch is on disk. On failure the journal is cut back to
+// where it was, so a later append can't land behind a partial record.
+static bool appendBatch(const std::vector<uint8_t>& batch, size_t count)
+{
+    if (batch.empty()) return true;
+
+    FILE* f = fopen(METACACHE_PATH, "ab");
+    if (!f) return false;
+
+    // Unbuffered, so nothing is left to reach the file after a truncate
+    setvbuf(f, nullptr, _IONBF, 0);
+    fseek(f, 0, SEEK_END);
+    long start = ftell(f);
+
+    // A fresh (or just-deleted) journal needs its header first
+    bool ok = start >= 0 &&
+              (start > 0 || writeHeader(f)) &&
+              fwrite(batch.data(), 1, batch.size(), f) == batch.size() &&
+              fflush(f) == 0 &&
+              fsync(fileno(f)) == 0;
+
+    if (!ok && start >= 0 && ftruncate(fileno(f), (off_t)start) != 0)
+    {
+        printf("[CACHE] Can't cut a failed append off the journal\n");
+        g_mcTorn = true;
+    }
+    fclose(f);
+
+    if (ok) g_mcRecords += count;
+    return ok;
+}
+
+// Rewrite the journal with only the live records. Nothing is lost if a
+// step fails: the pending batch is only dropped once the new journal is
+// in place, and once the old journal is gone the tmp file is the cache.
+static bool compactLocked()
+{
+    std::vector<uint8_t> all;
+    size_t count;
+    size_t pendingBytes, pendingCount;
+
+    mutexLock(&g_mcMutex);
+    all.reserve(g_mcLive * (sizeof(RecordHeader) + 96 + sizeof(FileStamp) + sizeof(Mp3MetadataEntry)));
+    for (auto& [path, e] : g_mcEntries)
+        serialiseEntry(all, path, e);
+    count = g_mcLive;
+    // Everything pending so far is part of the snapshot
+    pendingBytes = g_mcPending.size();
+    pendingCount = g_mcPendingCount;
+    mutexUnlock(&g_mcMutex);
+
+    FILE* f = fopen(METACACHE_TMP_PATH, "wb");
+    if (!f)
+    {
+        printf("[CACHE] Compaction skipped: can't create %s\n", METACACHE_TMP_PATH);
+        return false;
+    }
+
+    bool ok = writeHeader(f) &&
+              fwrite(all.data(), 1, all.size(), f) == all.size() &&
+              fflush(f) == 0 &&
+              fsync(fileno(f)) == 0;
+    if (fclose(f) != 0) ok = false;
+    if (!ok)
+    {
+        // The old journal is untouched and the batch is still pending.
+        // Without a journal (recovering from the tmp file) whatever is
+        // left of it is still the best copy on disk.
+        if (access(METACACHE_PATH, F_OK) == 0)
+            remove(METACACHE_TMP_PATH);
+        printf("[CACHE] Compaction skipped: writing %s failed\n", METACACHE_TMP_PATH);
+        return false;
+    }
+
+    // Some filesystems won't rename over an existing file. From the
+    // moment the old journal is removed the tmp file holds everything,
+    // so it stays even if the rename still fails; load picks it up.
+    if (rename(METACACHE_TMP_PATH, METACACHE_PATH) != 0)
+    {
+        remove(METACACHE_PATH);
+        if (rename(METACACHE_TMP_PATH, METACACHE_PATH) != 0)
+        {
+            printf("[CACHE] Compaction left in %s: rename failed\n", METACACHE_TMP_PATH);
+            return false;
+        }
+    }
+
+    // The snapshot is durable: drop what it covered, keep anything
+    // queued since
+    mutexLock(&g_mcMutex);
+    g_mcPending.erase(g_mcPending.begin(), g_mcPending.begin() + pendingBytes);
+    g_mcPendingCount -= pendingCount;
+    mutexUnlock(&g_mcMutex);
+
+    g_mcRecords = count;
+    g_mcTorn    = false;
+    printf("[CACHE] Compacted journal to %zu records\n", count);
+    return true;
+}
+
+static bool compactionDue()
+{
+    size_t dead = (g_mcRecords > g_mcLive) ? g_mcRecords - g_mcLive : 0;
+    return dead >= METACACHE_COMPACT_MIN && dead > g_mcLive;
+}
+
+/* -------------------------------------------------------
+   Load
+------------------------------------------------------- */
+void metaCacheLoad()
+{
+    if (g_mcLoaded) return;
+    g_mcLoaded = true;
+
+    mutexInit(&g_mcMutex);
+    mutexInit(&g_mcFileMutex);
+    crcInit();
+    ensureCacheDir();
+
+    // The per-format caches this replaces
+    remove("sdmc:/config/winamp/mp3_cache.bin");
+    remove("sdmc:/config/winamp/flac_cache.bin");
+    remove("sdmc:/config/winamp/ogg_cache.bin");
+    remove("sdmc:/config/winamp/wav_cache.bin");
+
+    u64 t0 = svcGetSystemTick();
+    bool rewrite = false;
+
+    // A compaction interrupted between removing the journal and renaming
+    // its replacement leaves only the tmp file, which is complete (it was
+    // fsynced first). With the journal present, a tmp file is a partial
+    // write and the journal is authoritative.
+    FILE* f = fopen(METACACHE_PATH, "rb");
+    if (f)
+        remove(METACACHE_TMP_PATH);
+    else if ((f = fopen(METACACHE_TMP_PATH, "rb")) != nullptr)
+    {
+        fclose(f);
+        if (rename(METACACHE_TMP_PATH, METACACHE_PATH) == 0)
+            f = fopen(METACACHE_PATH, "rb");
+        else
+        {
+            f = fopen(METACACHE_TMP_PATH, "rb");
+            rewrite = true;   // compaction writes a proper journal from it
+        }
+        printf("[CACHE] Recovering journal from %s\n", METACACHE_TMP_PATH);
+    }
+
+    if (f)
+    {
+        setvbuf(f, nullptr, _IOFBF, 256 * 1024);
+
+        JournalHeader jh{};
+        if (fread(&jh, sizeof(jh), 1, f) != 1 ||
+            jh.magic    != METACACHE_MAGIC ||
+            jh.version  != METACACHE_VERSION ||
+            jh.metaSize != sizeof(Mp3MetadataEntry))
+        {
+            rewrite = true; // unknown/old layout — start over
+        }
+        else
+        {
+            std::string          path;
+            std::vector<uint8_t> payload;
+            RecordHeader         h;
+
+            while (fread(&h, sizeof(h), 1, f) == 1)
+            {
+                if (h.payloadLen < sizeof(FileStamp) ||
+                    h.payloadLen > METACACHE_MAX_PAYLOAD)
+                { rewrite = true; break; }
+
+                path.resize(h.pathLen);
+                payload.resize(h.payloadLen);
+                if (fread(&path[0], 1, h.pathLen, f) != h.pathLen ||
+                    fread(payload.data(), 1, h.payloadLen, f) != h.payloadLen ||
+                    recordCrc(h, path.data(), payload.data()) != h.crc)
+                {
+                    // Torn or corrupt tail — keep everything before it
+                    rewrite = true;
+                    break;
+                }
+
+                FileStamp stamp;
+                memcpy(&stamp, payload.data(), sizeof(stamp));
+                const uint8_t* body    = payload.data() + sizeof(stamp);
+                size_t         bodyLen = h.payloadLen - sizeof(stamp);
+
+                if (h.type == REC_META && bodyLen == sizeof(Mp3MetadataEntry))
+                {
+                    Mp3MetadataEntry meta;
+                    memcpy(&meta, body, sizeof(meta));
+                    applyMeta(path, stamp, meta);
+                }
+                else if (h.type == REC_BLOB && bodyLen >= sizeof(uint32_t))
+                {
+                    uint32_t tag;
+                    memcpy(&tag, body, sizeof(tag));
+                    applyBlob(path, stamp, tag, body + sizeof(tag), bodyLen - sizeof(tag));
+                }
+                g_mcRecords++;
+            }
+        }
+        fclose(f);
+    }
+
+    printf("[CACHE] Loaded %zu tracks (%zu records) in %.1f ms\n",
+           g_mcEntries.size(), g_mcRecords,
+           (svcGetSystemTick() - t0) / 19200.0);
+
+    if (rewrite || compactionDue())
+    {
+        mutexLock(&g_mcFileMutex);
+        compactLocked();
+        mutexUnlock(&g_mcFileMutex);
+    }
+}
+
+/* -------------------------------------------------------
+   Flush / shutdown
+------------------------------------------------------- */
+void metaCacheFlush()
+{
+    if (!g_mcLoaded) return;
+
+    mutexLock(&g_mcFileMutex);
+
+    std::vector<uint8_t> batch;
+    size_t count;
+    mutexLock(&g_mcMutex);
+    batch.swap(g_mcPending);
+    count = g_mcPendingCount;
+    g_mcPendingCount = 0;
+    mutexUnlock(&g_mcMutex);
+
+    // Behind a tear that couldn't be cut off, an append would be lost on
+    // the next load; rewriting the live set puts the batch on disk instead
+    bool ok;
+    if (g_mcTorn)
+    {
+        mutexLock(&g_mcMutex);
+        g_mcPending.insert(g_mcPending.begin(), batch.begin(), batch.end());
+        g_mcPendingCount += count;
+        mutexUnlock(&g_mcMutex);
+        batch.clear();
+        ok = compactLocked();
+    }
+    else
+        ok = appendBatch(batch, count);
+
+    if (!ok)
+    {
+        // Back in front of anything queued meanwhile, so order is kept
+        mutexLock(&g_mcMutex);
+        if (!batch.empty())
+        {
+            g_mcPending.insert(g_mcPending.begin(), batch.begin(), batch.end());
+            g_mcPendingCount += count;
+        }
+        g_mcPendingSince = time(nullptr);
+        g_mcRetryAt      = g_mcPendingSince + METACACHE_BATCH_SECS;
+        count            = g_mcPendingCount;
+        mutexUnlock(&g_mcMutex);
+        printf("[CACHE] Journal write failed, %zu records kept pending\n", count);
+    }
+    mutexUnlock(&g_mcFileMutex);
+}
+
+void metaCacheShutdown()
+{
+    if (!g_mcLoaded) return;
+
+    metaCacheFlush();
+
+    mutexLock(&g_mcFileMutex);
+    if (compactionDue())
+        compactLocked();
+    mutexUnlock(&g_mcFileMutex);
+}
+
+/* -------------------------------------------------------
+   Lookup / put
+------------------------------------------------------- */
+bool metaCacheLookup(const char* path, Mp3MetadataEntry* out)
+{
+    if (!g_mcLoaded || !path) return false;
+
+    FileStamp now;
+    if (!statStamp(path, &now)) return false;
+
+    bool hit = false;
+    mutexLock(&g_mcMutex);
+    auto it = g_mcEntries.find(path);
+    if (it != g_mcEntries.end() && it->second.hasMeta && sameStamp(it->second.stamp, now))
+    {
+        *out = it->second.meta;
+        hit  = true;
+    }
+    mutexUnlock(&g_mcMutex);
+    return hit;
+}
+
+bool metaCacheGetBlob(const char* path, uint32_t tag, std::vector<uint8_t>* out)
+{
+    if (!g_mcLoaded || !path) return false;
+
+    FileStamp now;
+    if (!statStamp(path, &now)) return false;
+
+    bool hit = false;
+    mutexLock(&g_mcMutex);
+    auto it = g_mcEntries.find(path);
+    if (it != g_mcEntries.end())
+    {
+        for (const CacheBlob& b : it->second.blobs)
+        {
+            if (b.tag != tag || !sameStamp(b.stamp, now)) continue;
+            *out = b.data;
+            hit  = true;
+            break;
+        }
+    }
+    mutexUnlock(&g_mcMutex);
+    return hit;
+}
+
+static bool cacheablePath(const char* path)
+{
+    // romfs is read-only and always rescanned; temp files come and go
+    return path && path[0] &&
+           strncmp(path, "romfs:/", 7) != 0 &&
+           !strstr(path, ".tmp") &&
+           strlen(path) < 0xFFFF;
+}
+
+// Queue a serialised record; flush when the batch is full or stale
+static void queueRecord(std::vector<uint8_t>& rec)
+{
+    bool due;
+    mutexLock(&g_mcMutex);
+    if (g_mcPendingCount == 0) g_mcPendingSince = time(nullptr);
+    g_mcPending.insert(g_mcPending.end(), rec.begin(), rec.end());
+    g_mcPendingCount++;
+    time_t now = time(nullptr);
+    due = (g_mcPendingCount >= METACACHE_BATCH ||
+           now - g_mcPendingSince >= METACACHE_BATCH_SECS) &&
+          now >= g_mcRetryAt;
+    mutexUnlock(&g_mcMutex);
+
+    if (due) metaCacheFlush();
+}
+
+void metaCachePut(const char* path, const Mp3MetadataEntry& meta)
+{
+    if (!g_mcLoaded || !cacheablePath(path)) return;
+
+    FileStamp stamp;
+    if (!statStamp(path, &stamp)) return;
+
+    std::string key(path);
+    std::vector<uint8_t> rec;
+    serialiseRecord(rec, REC_META, key, stamp, &meta, sizeof(meta));
+
+    mutexLock(&g_mcMutex);
+    applyMeta(key, stamp, meta);
+    mutexUnlock(&g_mcMutex);
+
+    queueRecord(rec);
+}
+
+void metaCachePutBlob(const char* path, uint32_t tag, const void* data, size_t bytes)
+{
+    if (!g_mcLoaded || !cacheablePath(path)) return;
+    if (bytes > METACACHE_MAX_PAYLOAD - sizeof(FileStamp) - sizeof(tag)) return;
+
+    FileStamp stamp;
+    if (!statStamp(path, &stamp)) return;
+
+    std::string key(path);
+    std::vector<uint8_t> rec;
+    serialiseRecord(rec, REC_BLOB, key, stamp, &tag, sizeof(tag), data, bytes);
+
+    mutexLock(&g_mcMutex);
+    applyBlob(key, stamp, tag, (const uint8_t*)data, bytes);
+    mutexUnlock(&g_mcMutex);
+
+    queueRecord(rec);
+}
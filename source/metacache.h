@@ -0,0 +1,51 @@
+#pragma once
+#include "mp3.h"      // Mp3MetadataEntry — shared by every format
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/* -------------------------------------------------------
+   Unified metadata cache
+   One append-only journal for every format, replacing the
+   four per-format cache files that were rewritten in full
+   on every update.
+
+   - Each record carries a CRC-32; a torn tail from a crash
+     or power loss is dropped on load, never misread.
+   - Puts are batched in memory and appended in one write,
+     either when the batch fills, when it gets old, or when
+     a caller flushes (scanners do so whenever they go idle).
+     Nothing is ever dropped: a batch that fails to write is
+     cut back off the journal and queued again in front, and
+     retried a couple of seconds later or on the next flush.
+   - Superseded records are reclaimed by compaction, which
+     writes the live set to a tmp file, fsyncs it and renames
+     it over the journal. Pending records stay queued until
+     that has succeeded. The journal is removed first only
+     if the rename can't replace it, and the tmp file is
+     never deleted after that; load falls back to the tmp
+     file when the journal is missing.
+   - Besides the metadata entry, a track may carry tagged
+     binary blobs (seek tables, frame indexes, ...).
+
+   Entries are keyed by path and checked against the file's
+   mtime and size on lookup. Thread-safe.
+------------------------------------------------------- */
+#define METACACHE_PATH      "sdmc:/config/winamp/metadata.journal"
+#define METACACHE_TMP_PATH  "sdmc:/config/winamp/metadata.journal.tmp"
+
+// Load the journal once (later calls are no-ops)
+void metaCacheLoad();
+
+// Flush pending records and compact if worthwhile (call at exit)
+void metaCacheShutdown();
+
+// Append whatever is pending right now
+void metaCacheFlush();
+
+bool metaCacheLookup(const char* path, Mp3MetadataEntry* out);
+void metaCachePut(const char* path, const Mp3MetadataEntry& meta);
+
+// Blobs are independent of the metadata entry and validated the same way
+bool metaCacheGetBlob(const char* path, uint32_t tag, std::vector<uint8_t>* out);
+void metaCachePutBlob(const char* path, uint32_t tag, const void* data, size_t bytes);
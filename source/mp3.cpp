@@ -5,6 +5,10 @@
 #include <string.h>
 #include <sys/stat.h>
 #include "player.h"
+#include "metacache.h"
+#include "tracktable.h"
+#include "scanpool.h"
+#include "mp3probe.h"
 #include <mpg123.h>
 #include <vector>
 #include <string>
@@ -15,35 +19,11 @@
 #include <unordered_map>
 #include <unistd.h>
 
-static Thread g_mp3Thread;
-static bool   g_mp3ThreadRunning = false;
-
-static Mutex  g_metaMutex;
-static Mutex  g_scanMutex;
-
-static bool mp3CacheValid(const Mp3CacheEntry& entry);
 static char g_loadedFolder[512] = {0};
 
-//static std::vector<Mp3CacheEntry> g_mp3Cache;
-static std::unordered_map<std::string, Mp3CacheEntry> g_mp3Cache;
-static bool g_cacheLoaded = false;
-
-static std::unordered_set<std::string> g_scanQueuedPaths;
-
-static std::vector<RuntimeMetadata> playlistMetadata;
-static int g_scanGeneration = 0;
-
-static const char* MP3_CACHE_PATH     = "sdmc:/config/winamp/mp3_cache.bin";
-static const char* MP3_CACHE_TMP_PATH = "sdmc:/config/winamp/mp3_cache.bin.tmp";
+static int g_mp3TrackCount = 0;   // MP3 entries in the current playlist
 
-static void readMp3Metadata(const char* path, Mp3MetadataEntry& entry);
-static void readID3v1Fallback(const char* path, Mp3MetadataEntry& entry);
-static void readMp3BitrateAndRate(const char* path,
-                                  int& outBitrateKbps,
-                                  int& outSampleRateKHz,
-                                  int& outChannels);
 int getMp3DurationSeconds(const char* path, int& bitrateKbps, int id3TagBytes);
-void mp3AppendCache(const char* path, const Mp3MetadataEntry& meta);
 
 /* ---------- Helpers ---------- */
 
@@ -60,108 +40,6 @@ void mp3SetLoadedFolder(const char* path)
     g_loadedFolder[sizeof(g_loadedFolder) - 1] = '\0';
 }
 
-static void parseReplayGain(const char* key, const char* value, Mp3MetadataEntry& entry)
-{
-    if (!key || !value) return;
-        printf("[RG] %s = %s\n", key, value);
-    if (strcasecmp(key, "REPLAYGAIN_TRACK_GAIN") == 0)
-    {
-        float db = 0.0f;
-        if (sscanf(value, "%f", &db) == 1)
-        {
-            entry.replayGainDb = db;
-            entry.hasTrackReplayGain = true;
-        }
-    }
-    else if (strcasecmp(key, "REPLAYGAIN_ALBUM_GAIN") == 0)
-    {
-        float db = 0.0f;
-        if (sscanf(value, "%f", &db) == 1)
-        {
-            entry.replayGainAlbumDb = db;
-            entry.hasAlbumReplayGain = true;
-        }
-
-    }
-}
-
-enum ScanPhase {
-    SCAN_FAST,
-    SCAN_ACCURATE
-};
-
-struct ScanJob {
-    std::string path;
-    int index;
-    int generation;
-    ScanPhase phase;
-};
-
-static std::vector<ScanJob> g_scanQueue;
-
-static void ensureCacheDir()
-{
-    mkdir("sdmc:/config", 0777);
-    mkdir("sdmc:/config/winamp", 0777);
-}
-
-static bool playlistHasPath(const char* path)
-{
-    for (auto& m : playlistMetadata)
-    {
-        if (strcmp(m.path, path) == 0)
-            return true;
-    }
-    return false;
-}
-
-void mp3LoadCache(const char* folderKey)
-{
-    if (g_cacheLoaded)
-        return;
-
-    ensureCacheDir();
-
-    FILE* f = fopen("sdmc:/config/winamp/mp3_cache.bin", "rb");
-    if (!f)
-    {
-        g_cacheLoaded = true;
-        return;
-    }
-
-    Mp3CacheHeader h{};
-    if (fread(&h, sizeof(h), 1, f) != 1 ||
-        h.magic != 0x4D503343 ||
-        h.version != MP3_CACHE_VERSION)
-    {
-        fclose(f);
-        g_cacheLoaded = true;
-        return;
-    }
-
-    Mp3CacheEntry e;
-    while (fread(&e, sizeof(e), 1, f) == 1)
-    {
-        if (!mp3CacheValid(e))
-            continue;
-
-        g_mp3Cache[e.path] = e;
-    }
-
-    fclose(f);
-    g_cacheLoaded = true;
-}
-
-void mp3StopBackgroundScanner()
-{
-    if (!g_mp3ThreadRunning)
-        return;
-
-    g_mp3ThreadRunning = false;
-    threadWaitForExit(&g_mp3Thread);
-    threadClose(&g_mp3Thread);
-}
-
 void debugLog(const char* fmt, ...)
 {
     static bool initialized = false;
@@ -178,147 +56,76 @@ void debugLog(const char* fmt, ...)
     fflush(stdout);
 }
 
-static void mp3ScanThread(void*)
-{
-    while (g_mp3ThreadRunning)
-    {
-        ScanJob job;
-
-        mutexLock(&g_scanMutex);
-        if (g_scanQueue.empty())
-        {
-            mutexUnlock(&g_scanMutex);
-            svcSleepThread(50'000'000);
-            continue;
-        }
-
-        job = g_scanQueue.front();
-        g_scanQueue.erase(g_scanQueue.begin());
-        mutexUnlock(&g_scanMutex);
-
-        // Cancel check
-        mutexLock(&g_scanMutex);
-        bool canceled = (job.generation != g_scanGeneration);
-        mutexUnlock(&g_scanMutex);
-
-        if (canceled)
-            continue;
-
-        Mp3MetadataEntry entry{};
-
-        // -------------------------
-        // PHASE 1 — FAST SCAN
-        // -------------------------
-        if (job.phase == SCAN_FAST)
-        {
-            readMp3Metadata(job.path.c_str(), entry);
-            readID3v1Fallback(job.path.c_str(), entry);
-            readMp3BitrateAndRate(
-                job.path.c_str(),
-                entry.bitrateKbps,
-                entry.sampleRateKHz,
-                entry.channels
-            );
+/* ---------- Scan jobs (run on the scanner pool) ---------- */
 
-            // FAST duration only
-            struct stat st;
-            if (stat(job.path.c_str(), &st) == 0 && entry.bitrateKbps > 0)
-            {
-                long audioBytes = st.st_size - entry.id3TagBytes;
-                if (audioBytes < 0) audioBytes = st.st_size;
-
-                entry.durationSeconds =
-                    (int)((audioBytes * 8.0) /
-                    (entry.bitrateKbps * 1000.0));
-            }
-
-            mutexLock(&g_metaMutex);
-            if (job.index < (int)playlistMetadata.size())
-            {
-                playlistMetadata[job.index].meta = entry;
-            }
-            mutexUnlock(&g_metaMutex);
+// PHASE 1 — FAST SCAN: one-open probe of tags, headers and duration
+void mp3ScanFastJob(const ScanJob& job)
+{
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
 
-            mp3AppendCache(job.path.c_str(), entry);
+    Mp3MetadataEntry entry{};
+    Mp3ProbeInfo info;
+    mp3Probe(path, entry, &info);
 
-            // Queue accurate scan ONLY if duration looks suspicious
-            if (entry.bitrateKbps <= 192)
-            {
-                mutexLock(&g_scanMutex);
-                g_scanQueue.push_back({
-                    job.path,
-                    job.index,
-                    g_scanGeneration,
-                    SCAN_ACCURATE
-                });
-                mutexUnlock(&g_scanMutex);
-            }
+    if (scanJobCanceled(job)) return;
+    trackSetMetadata(job.id, entry);
+    metaCachePut(path, entry);
 
-            continue;
-        }
+    // Queue accurate scan ONLY if duration looks suspicious — a Xing or
+    // VBRI frame count is already exact
+    if (!info.exactLength && entry.bitrateKbps <= 192)
+        scanPoolSubmit(job.id, SCAN_JOB_MP3_ACCURATE, job.token);
+}
 
-        // -------------------------
-        // PHASE 2 — ACCURATE
-        // -------------------------
-        if (job.phase == SCAN_ACCURATE)
-        {
-            // Do NOT disturb currently playing track
-            if (playerIsPlaying() &&
-                playlistGetCurrentIndex() == job.index)
-            {
-                continue;
-            }
+// PHASE 2 — ACCURATE: walk every frame header (no decoding) for the
+// exact duration, and keep the frame-offset table for seeking
+void mp3ScanAccurateJob(const ScanJob& job)
+{
+    // Do NOT disturb currently playing track
+    if (playerIsPlaying() &&
+        playlistGetTrackId(playlistGetCurrentIndex()) == job.id)
+        return;
 
-            int bitrate = 0;
-            int duration =
-                getMp3DurationSeconds(
-                    job.path.c_str(),
-                    bitrate,
-                    entry.id3TagBytes
-                );
+    const char* path = trackGetPath(job.id);
+    Mp3MetadataEntry updated{};
+    if (!path || !trackCopyMetadata(job.id, &updated))
+        return;
 
-            if (duration > 0)
-            {
-                mutexLock(&g_metaMutex);
-                if (job.index < (int)playlistMetadata.size())
-                {
-                    playlistMetadata[job.index].meta.durationSeconds = duration;
-                    playlistMetadata[job.index].meta.bitrateKbps = bitrate;
-                }
-                mutexUnlock(&g_metaMutex);
+    Mp3MetadataEntry probed;
+    Mp3ProbeInfo probe;
+    Mp3FrameWalk walk;
+    if (!mp3Probe(path, probed, &probe) || !mp3WalkFrames(path, probe, &walk))
+        return;
 
-                mp3AppendCache(
-                    job.path.c_str(),
-                    playlistMetadata[job.index].meta
-                );
-            }
-        }
+    if (walk.seconds > 0.0 && !scanJobCanceled(job))
+    {
+        updated.durationSeconds = (int)walk.seconds;
+        updated.bitrateKbps     = (int)(walk.audioBytes * 8.0 / walk.seconds / 1000.0);
+        trackSetMetadata(job.id, updated);
+        metaCachePut(path, updated);
+        mp3IndexSave(path, walk);
     }
 }
 
-void mp3StartBackgroundScanner()
+// SEEK INDEX: walk only, for files whose duration was already exact
+// (Xing/VBRI) but that have no frame-offset table yet. Queued by the
+// player when such a track starts playing.
+void mp3ScanIndexJob(const ScanJob& job)
 {
-    mutexInit(&g_metaMutex);
-    mutexInit(&g_scanMutex);
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
 
-    g_mp3ThreadRunning = true;
-    threadCreate(&g_mp3Thread,
-                 mp3ScanThread,
-                 nullptr,
-                 nullptr,
-                 0x4000,
-                 0x2B,
-                 -2);
-    threadStart(&g_mp3Thread);
-}
+    Mp3FrameWalk walk;
+    if (mp3IndexLoad(path, &walk)) return;   // built meanwhile
 
-bool mp3CacheValid(const Mp3CacheEntry& entry)
-{
-    struct stat st;
-    if (stat(entry.path, &st) != 0)
-        return false;
+    Mp3MetadataEntry probed;
+    Mp3ProbeInfo probe;
+    if (!mp3Probe(path, probed, &probe) || !mp3WalkFrames(path, probe, &walk))
+        return;
 
-    return st.st_mtime == entry.mtime;
+    if (!scanJobCanceled(job))
+        mp3IndexSave(path, walk);
 }
 
 bool mp3SeekSamples(mpg123_handle* mh, off_t sampleOffset)
@@ -331,386 +138,6 @@ bool mp3SeekSamples(mpg123_handle* mh, off_t sampleOffset)
 }
 
 
-// Convert ID3v2 syncsafe integer to int
-static unsigned int syncsafeToInt(unsigned char* b)
-{
-    return (b[0] << 21) | (b[1] << 14) | (b[2] << 7) | b[3];
-}
-
-// Read a text frame from ID3v2
-static void readTextFrame(FILE* f, unsigned int size, char* out, size_t outSize)
-{
-    if (size < 1 || outSize == 0) return;
-
-    unsigned char encoding;
-    fread(&encoding, 1, 1, f);
-    size--;
-
-    if (encoding == 0) // ISO-8859-1 / ASCII
-    {
-        size_t toRead = (size < outSize - 1) ? size : outSize - 1;
-        fread(out, 1, toRead, f);
-        out[toRead] = 0;
-
-        if (size > toRead)
-            fseek(f, size - toRead, SEEK_CUR);
-    }
-    else if (encoding == 3) // UTF-8
-    {
-        size_t toRead = (size < outSize - 1) ? size : outSize - 1;
-        fread(out, 1, toRead, f);
-        out[toRead] = 0;
-
-        if (size > toRead)
-            fseek(f, size - toRead, SEEK_CUR);
-    }
-    else if (encoding == 1 || encoding == 2) // UTF-16 (with or without BOM)
-    {
-        // Read full UTF-16 string into temp buffer
-        unsigned char buf[512];
-        size_t toRead = (size < sizeof(buf)) ? size : sizeof(buf);
-        fread(buf, 1, toRead, f);
-
-        bool bigEndian = (encoding == 2);
-
-        // Check BOM for encoding==1
-        size_t offset = 0;
-        if (encoding == 1 && toRead >= 2)
-        {
-            if (buf[0] == 0xFF && buf[1] == 0xFE) { bigEndian = false; offset = 2; }
-            else if (buf[0] == 0xFE && buf[1] == 0xFF) { bigEndian = true; offset = 2; }
-        }
-
-        // Convert UTF-16 → UTF-8 (basic BMP only, enough for tags)
-        size_t outPos = 0;
-        for (size_t i = offset; i + 1 < toRead && outPos < outSize - 1; i += 2)
-        {
-            unsigned short ch = bigEndian
-                ? (buf[i] << 8) | buf[i+1]
-                : (buf[i+1] << 8) | buf[i];
-
-            if (ch == 0) break; // string end
-
-            if (ch < 0x80)
-            {
-                out[outPos++] = (char)ch;
-            }
-            else if (ch < 0x800 && outPos < outSize - 2)
-            {
-                out[outPos++] = 0xC0 | (ch >> 6);
-                out[outPos++] = 0x80 | (ch & 0x3F);
-            }
-            else if (outPos < outSize - 3)
-            {
-                out[outPos++] = 0xE0 | (ch >> 12);
-                out[outPos++] = 0x80 | ((ch >> 6) & 0x3F);
-                out[outPos++] = 0x80 | (ch & 0x3F);
-            }
-        }
-
-        out[outPos] = 0;
-
-        if (size > toRead)
-            fseek(f, size - toRead, SEEK_CUR);
-    }
-    else
-    {
-        // Unknown encoding → skip
-        fseek(f, size, SEEK_CUR);
-        out[0] = 0;
-    }
-}
-
-static void readID3v1Fallback(const char* path, Mp3MetadataEntry& entry)
-{
-    if (entry.artist[0] && entry.title[0]) return;
-
-    FILE* f = fopen(path, "rb");
-    if (!f) return;
-
-    if (fseek(f, -128, SEEK_END) != 0) { fclose(f); return; }
-
-    char tag[128];
-    if (fread(tag, 1, 128, f) != 128) { fclose(f); return; }
-
-    if (memcmp(tag, "TAG", 3) == 0)
-    {
-        if (entry.title[0] == 0)
-        {
-            memcpy(entry.title, tag + 3, 30);
-            entry.title[30] = 0;
-        }
-
-        if (entry.artist[0] == 0)
-        {
-            memcpy(entry.artist, tag + 33, 30);
-            entry.artist[30] = 0;
-        }
-    }
-
-    fclose(f);
-}
-
-// Read ID3v2 metadata from MP3
-static void readMp3Metadata(const char* path, Mp3MetadataEntry& entry)
-{
-    memset(&entry, 0, sizeof(entry));
-    entry.replayGainPeak = 1.0f;
-    entry.replayGainAlbumPeak = 1.0f;
-    entry.id3TagBytes = 0;
-
-    FILE* f = fopen(path, "rb");
-    if (!f) return;
-
-    unsigned char header[10];
-    if (fread(header, 1, 10, f) != 10) { fclose(f); return; }
-
-    if (memcmp(header, "ID3", 3) != 0) { fclose(f); return; }
-
-    int version = header[3];   // 2, 3 or 4
-    unsigned int tagSize = syncsafeToInt(&header[6]);
-    entry.id3TagBytes = tagSize + 10;//
-    long tagEnd = 10 + tagSize;
-    //printf("[ID3] Frame: %s Size: %u\n", frameId, frameSize);
-
-    debugLog("ID3v2.%d tag detected in %s\n", version, path, entry.id3TagBytes);
-    debugLog("ID3 Total tag bytes: %d\n",  entry.id3TagBytes);
-
-    while (ftell(f) < tagEnd)
-    {
-        if (version == 2)
-        {
-            // -------- ID3v2.2 (3-char frame IDs) --------
-            char frameId[4] = {0};
-            unsigned char sizeBytes[3];
-
-            if (fread(frameId, 1, 3, f) != 3) break;
-            if (frameId[0] == 0) break;
-
-            if (fread(sizeBytes, 1, 3, f) != 3) break;
-
-            unsigned int frameSize =
-                (sizeBytes[0] << 16) | (sizeBytes[1] << 8) | sizeBytes[2];
-
-            printf("Frame (v2.2): %s Size: %u\n", frameId, frameSize);
-
-
-            if (frameSize == 0) break;
-
-            if (strcmp(frameId,"TT2")==0)           // Title
-                readTextFrame(f, frameSize, entry.title, sizeof(entry.title));
-            else if (strcmp(frameId,"TP1")==0)      // Artist
-                readTextFrame(f, frameSize, entry.artist, sizeof(entry.artist));
-            else if (strcmp(frameId,"TP2")==0 && entry.artist[0]==0) // Album artist fallback
-                readTextFrame(f, frameSize, entry.artist, sizeof(entry.artist));
-            else if (strcmp(frameId, "TXXX") == 0)
-            {
-                char buffer[256] = {0};
-                readTextFrame(f, frameSize, buffer, sizeof(buffer));
-
-                char* sep = strchr(buffer, '=');
-                if (sep)
-                {
-                    *sep = 0;
-                    parseReplayGain(buffer, sep + 1, entry);
-                }
-            }
-            else
-            {
-                fseek(f, frameSize, SEEK_CUR);
-            }
-        }
-        else
-        {
-            // -------- ID3v2.3 / 2.4 (4-char IDs) --------
-            char frameId[5] = {0};
-            unsigned char sizeBytes[4];
-
-            if (fread(frameId, 1, 4, f) != 4) break;
-            if (frameId[0] == 0) break;
-
-            if (fread(sizeBytes, 1, 4, f) != 4) break;
-
-            fseek(f, 2, SEEK_CUR); // flags
-
-            unsigned int frameSize =
-                (version == 4)
-                ? syncsafeToInt(sizeBytes)
-                : (sizeBytes[0]<<24)|(sizeBytes[1]<<16)|(sizeBytes[2]<<8)|sizeBytes[3];
-
-            printf("Frame: %s Size: %u\n", frameId, frameSize);
-
-            if (frameSize == 0) break;
-
-            if (strcmp(frameId,"TIT2")==0)
-                readTextFrame(f, frameSize, entry.title, sizeof(entry.title));
-            else if (strcmp(frameId,"TPE1")==0)
-                readTextFrame(f, frameSize, entry.artist, sizeof(entry.artist));
-            else if (strcmp(frameId,"TPE2")==0 && entry.artist[0]==0)
-                readTextFrame(f, frameSize, entry.artist, sizeof(entry.artist));
-            else if (strcmp(frameId, "TXXX") == 0)
-            {
-                char buffer[256] = {0};
-                readTextFrame(f, frameSize, buffer, sizeof(buffer));
-
-                // Format: "KEY\0VALUE" OR "KEY=VALUE"
-                // TXXX = "key\0value"
-                char* key = buffer;
-                char* value = buffer + strlen(buffer) + 1;
-
-                if (value < buffer + frameSize)
-                {
-                    parseReplayGain(key, value, entry);
-                }
-
-                else
-                {
-                    char* sep = strchr(buffer, '=');
-                    if (sep)
-                    {
-                        *sep = 0;
-                        parseReplayGain(buffer, sep + 1, entry);
-                    }
-                }
-            }
-            else
-            {
-                fseek(f, frameSize, SEEK_CUR);
-            }
-
-        }
-    }
-
-    fclose(f);
-}
-
-// --- Read bitrate & sample rate from first MPEG frame ---
-static int readBigEndian32(unsigned char* b)
-{
-    return (b[0]<<24)|(b[1]<<16)|(b[2]<<8)|b[3];
-}
-
-
-static void readMp3BitrateAndRate(const char* path,
-                                  int& outBitrateKbps,
-                                  int& outSampleRateKHz,
-                                  int& outChannels)
-{
-    outBitrateKbps = 0;
-    outSampleRateKHz = 0;
-    outChannels = 0;
-
-    FILE* f = fopen(path, "rb");
-    if (!f) return;
-
-    unsigned char h[4];
-
-    // --- Skip ID3v2 ---
-    unsigned char id3[10];
-    if (fread(id3,1,10,f)==10 && memcmp(id3,"ID3",3)==0)
-    {
-        int tagSize = (id3[6]<<21)|(id3[7]<<14)|(id3[8]<<7)|id3[9];
-        fseek(f, tagSize, SEEK_CUR);
-    }
-    else
-    {
-        fseek(f, 0, SEEK_SET);
-    }
-
-    // --- Find MPEG frame ---
-    while (fread(h,1,4,f)==4)
-    {
-        if (h[0]==0xFF && (h[1]&0xE0)==0xE0)
-            break;
-        fseek(f,-3,SEEK_CUR);
-    }
-
-    if (!(h[0]==0xFF && (h[1]&0xE0)==0xE0))
-    {
-        debugLog("[MP3] %s NO MPEG FRAME FOUND\n", path);
-        fclose(f);
-        return;
-    }
-    debugLog("[MP3] %s MPEG header found: %02X %02X %02X %02X\n", path, h[0], h[1], h[2], h[3]);
-//    int versionIndex = (h[1] >> 3) & 0x03;
-    int srIndex      = (h[2] >> 2) & 0x03;
-
-    static const int sampleRates[4] = {44100,48000,32000,0};
-    outSampleRateKHz = sampleRates[srIndex] / 1000;
-    outChannels = ((h[3] & 0xC0) == 0xC0) ? 1 : 2;
-
-    long frameStart = ftell(f) - 4;
-    debugLog("[MP3] SampleRate=%dkHz Channels=%d\n", outSampleRateKHz, outChannels);
-    // Jump into frame to check for Xing/VBRI
-    fseek(f, frameStart + 32, SEEK_SET); // typical offset for MPEG1 stereo
-    unsigned char tag[4];
-    fread(tag,1,4,f);
-
-    // ---------- XING / INFO ----------
-    if (memcmp(tag,"Xing",4)==0 || memcmp(tag,"Info",4)==0)
-    {
-        unsigned char flags[4];
-        fread(flags,1,4,f);
-        int flagsVal = readBigEndian32(flags);
-
-        int frames = 0;
-        int bytes  = 0;
-
-        if (flagsVal & 0x1) { unsigned char b[4]; fread(b,1,4,f); frames = readBigEndian32(b); }
-        if (flagsVal & 0x2) { unsigned char b[4]; fread(b,1,4,f); bytes  = readBigEndian32(b); }
-
-        if (frames > 0 && bytes > 0 && outSampleRateKHz > 0)
-        {
-            double duration = (frames * 1152.0) / (outSampleRateKHz * 1000);
-            outBitrateKbps = (int)((bytes * 8.0) / duration / 1000.0);
-
-        }
-        debugLog("[MP3] %s has XING/INFO header\n", path);
-        debugLog("[MP3] frames=%d bytes=%d\n", frames, bytes);
-        debugLog("[MP3] Calculated VBR bitrate=%d kbps\n", outBitrateKbps);
-        fclose(f);
-        return;
-    }
-
-    // ---------- VBRI ----------
-    fseek(f, frameStart + 36, SEEK_SET);
-    fread(tag,1,4,f);
-    if (memcmp(tag,"VBRI",4)==0)
-    {
-        fseek(f, 10, SEEK_CUR);
-        unsigned char b[4];
-        fread(b,1,4,f);
-        int bytes = readBigEndian32(b);
-
-        fread(b,1,4,f);
-        int frames = readBigEndian32(b);
-
-        if (frames > 0 && bytes > 0 && outSampleRateKHz > 0)
-        {
-            double duration = (frames * 1152.0) / (outSampleRateKHz * 1000);
-            outBitrateKbps = (int)((bytes * 8.0) / duration / 1000.0);
-        }
-        printf("[MP3] %s has VBRI header\n", path);
-        printf("[MP3] frames=%d bytes=%d\n", frames, bytes);
-        printf("[MP3] Calculated VBR bitrate=%d kbps\n", outBitrateKbps);
-
-        fclose(f);
-        return;
-    }
-
-    // ---------- Fallback CBR ----------
-    fseek(f, frameStart, SEEK_SET);
-    fread(h,1,4,f);
-
-    int brIndex = (h[2] >> 4) & 0x0F;
-    static const int brTable[16] = {0,32,40,48,56,64,80,96,112,128,160,192,224,256,320,0};
-
-    outBitrateKbps = brTable[brIndex];
-    debugLog("[MP3] %s using CBR fallback bitrate=%d kbps\n", path, outBitrateKbps);
-
-    fclose(f);
-}
-
 int getMp3DurationSeconds(const char* path, int& bitrateKbps, int id3TagBytes)
 {
     struct stat st;
@@ -729,136 +156,58 @@ int getMp3DurationSeconds(const char* path, int& bitrateKbps, int id3TagBytes)
         debugLog("[MP3] FAST duration (audioBytes=%ld bitrate=%d) = %d sec\n",
                  audioBytes, bitrateKbps, fastDuration);
 
-        if (bitrateKbps <= 192)
-        {
-            debugLog("[MP3] Verifying duration — possible VBR without header\n");
-
-            mpg123_handle* mh = mpg123_new(NULL, NULL);
-            if (mh)
-            {
-                // Tell mpg123 to ignore ID3v2 completely
-                mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_SKIP_ID3V2, 0);
-
-                if (mpg123_open(mh, path) == MPG123_OK)
-                {
-
-
-                off_t samples = mpg123_length(mh);
-                long rate;
-                int ch, enc;
-                mpg123_getformat(mh, &rate, &ch, &enc);
-
-                if (samples > 0 && rate > 0)
-                {
-                    int realDuration = samples / rate;
-                    debugLog("[MP3] mpg123 quick length = %d sec\n", realDuration);
-
-                    if (abs(realDuration - fastDuration) > 5)
-                    {
-                        debugLog("[MP3] FAST duration rejected (VBR detected)\n");
-
-                        bitrateKbps = (int)((audioBytes * 8.0) / (realDuration * 1000.0));
-                        debugLog("[MP3] Corrected average bitrate = %d kbps\n", bitrateKbps);
-
-                        mpg123_close(mh);
-                        mpg123_delete(mh);
-                        return realDuration;
-                    }
-                }
-
-                mpg123_close(mh);
-                mpg123_delete(mh);
-            }
-        }
-
-        if (fastDuration > 10 && fastDuration < 7200)
+        // Low bitrates are often VBR without a Xing header — verify those
+        if (bitrateKbps > 192 && fastDuration > 10 && fastDuration < 7200)
             return fastDuration;
     }
-}
-    // Full scan fallback
-    mpg123_handle* mh = mpg123_new(NULL, NULL);
-    if (!mh) return 0;
-
-    // Ignore ID3v2 here as well
-    mpg123_param(mh, MPG123_ADD_FLAGS, MPG123_SKIP_ID3V2, 0);
-
-    if (mpg123_open(mh, path) != MPG123_OK)
-    {
-        mpg123_delete(mh);
-        return 0;
-    }
-
-
-    debugLog("[MP3] Using mpg123 FULL SCAN for duration (slow path)\n");
-    mpg123_scan(mh);
-
-    off_t samples = mpg123_length(mh);
-    long rate;
-    int ch, enc;
-    mpg123_getformat(mh, &rate, &ch, &enc);
-
-    int finalDuration = 0;
-    if (samples > 0 && rate > 0)
-    {
-        finalDuration = samples / rate;
-        bitrateKbps = (int)((audioBytes * 8.0) / (finalDuration * 1000.0));
-    }
-
-    mpg123_close(mh);
-    mpg123_delete(mh);
 
-    return finalDuration;
+    // Accurate path: walk the frame headers. No decoding, unlike the
+    // mpg123_scan() this replaces, and the offset table comes for free.
+    Mp3MetadataEntry probed;
+    Mp3ProbeInfo probe;
+    Mp3FrameWalk walk;
+    if (!mp3Probe(path, probed, &probe) ||
+        !mp3WalkFrames(path, probe, &walk) || walk.seconds <= 0.0)
+        return fastDuration;
+
+    bitrateKbps = (int)(walk.audioBytes * 8.0 / walk.seconds / 1000.0);
+    mp3IndexSave(path, walk);
+
+    debugLog("[MP3] Walked duration = %d sec, average bitrate = %d kbps\n",
+             (int)walk.seconds, bitrateKbps);
+    return (int)walk.seconds;
 }
 
 /* ---------- Public API ---------- */
 
 void mp3ClearMetadata()
 {
-    playlistMetadata.clear();
-}
-
-void mp3CancelAllScans()
-{
-    mutexLock(&g_scanMutex);
-
-    g_scanQueue.clear();
-    g_scanQueuedPaths.clear();
-    g_scanGeneration++; // invalidate in-flight jobs
-
-    mutexUnlock(&g_scanMutex);
+    // Metadata itself lives in the track table and outlives the playlist
+    g_mp3TrackCount = 0;
 }
 
 bool mp3AddToPlaylist(const char* path)
 {
     if (!path) return false;
 
-    // Prevent duplicate playlist entries
-    if (playlistHasPath(path))
+    // Prevent duplicate playlist entries (O(1) — see playlistAdd)
+    TrackId id = playlistAdd(path);
+    if (id == TRACK_ID_NONE)
         return false;
 
-    playlistAdd(path);
-
-    // Use the LOCAL index into playlistMetadata, not the global playlist index.
-    // This is critical for mixed MP3+FLAC folders — the global playlist index
-    // includes FLAC entries, but this metadata vector only holds MP3 entries.
-    int localIndex = (int)playlistMetadata.size();
+    g_mp3TrackCount++;
 
+    // Metadata is keyed by track ID, so mixed MP3+FLAC folders need no
+    // separate local index any more.
     Mp3MetadataEntry meta{};
     strcpy(meta.title, "Scanning...");
+    trackSetMetadata(id, meta);
 
-    RuntimeMetadata r{};
-    strncpy(r.path, path, sizeof(r.path) - 1);
-    r.path[sizeof(r.path) - 1] = '\0';
-    r.meta = meta;
-
-    playlistMetadata.push_back(r);
     //  Try cache first
-    auto it = g_mp3Cache.find(path);
-    if (it != g_mp3Cache.end() && mp3CacheValid(it->second))
+    Mp3MetadataEntry cached;
+    if (metaCacheLookup(path, &cached))
     {
-        mutexLock(&g_metaMutex);
-        playlistMetadata[localIndex].meta = it->second.meta;
-        mutexUnlock(&g_metaMutex);
+        trackSetMetadata(id, cached);
 
         debugLog("[CACHE] Hit for %s\n", path);
         return true;
@@ -867,120 +216,30 @@ bool mp3AddToPlaylist(const char* path)
     if (strncmp(path, "romfs:/", 7) == 0)
     {
         Mp3MetadataEntry entry{};
-        readMp3Metadata(path, entry);
-        readID3v1Fallback(path, entry);
-        readMp3BitrateAndRate(
-            path,
-            entry.bitrateKbps,
-            entry.sampleRateKHz,
-            entry.channels
-        );
+        Mp3ProbeInfo info;
+        mp3Probe(path, entry, &info);
 
-        entry.durationSeconds =
-            getMp3DurationSeconds(
-                path,
-                entry.bitrateKbps,
-                entry.id3TagBytes
-            );
+        if (!info.exactLength)
+            entry.durationSeconds =
+                getMp3DurationSeconds(
+                    path,
+                    entry.bitrateKbps,
+                    entry.id3TagBytes
+                );
 
-        mutexLock(&g_metaMutex);
-        playlistMetadata[localIndex].meta = entry;
-        mutexUnlock(&g_metaMutex);
+        trackSetMetadata(id, entry);
 
         return true;
     }
 
-    // Prevent duplicate scan queue entries
-    mutexLock(&g_scanMutex);
-    if (g_scanQueuedPaths.insert(path).second)
-    {
-        g_scanQueue.push_back({
-            path,
-            localIndex,
-            g_scanGeneration,
-            SCAN_FAST
-        });
-    }
-    mutexUnlock(&g_scanMutex);
+    // playlistAdd already rejected duplicates, so each track is queued once
+    scanPoolSubmit(id, SCAN_JOB_MP3_FAST, scanPoolToken());
 
     return true;
 }
 
-void mp3AppendCache(const char* path, const Mp3MetadataEntry& meta)
-{
-    // 🔒 Reject invalid or ROMFS paths
-    if (!path || strncmp(path, "romfs:/", 7) == 0)
-        return;
-
-    // 🔒 Reject temp / garbage paths
-    if (strstr(path, ".tmp"))
-        return;
-
-    struct stat st;
-    if (stat(path, &st) != 0)
-        return;
-
-    // 🔒 Avoid hammering SD card (write throttle)
-    static time_t lastWrite = 0;
-    time_t now = time(nullptr);
-    if (now - lastWrite < 1)
-        return;
-    lastWrite = now;
-
-    // Update in-memory cache
-    Mp3CacheEntry& e = g_mp3Cache[path];
-
-    strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path) - 1] = '\0';   // defensive
-    e.meta  = meta;
-    e.mtime = st.st_mtime;
-
-    // 🔐 Write cache atomically via temp file
-    FILE* f = fopen(MP3_CACHE_TMP_PATH, "wb");
-    if (!f)
-    {
-        debugLog("[CACHE] Failed to open temp cache file\n");
-        return;
-    }
-
-    Mp3CacheHeader h{};
-    h.magic   = 0x4D503343; // 'MP3C'
-    h.version = MP3_CACHE_VERSION;
-
-    if (fwrite(&h, sizeof(h), 1, f) != 1)
-        goto fail;
-
-    for (auto& [_, entry] : g_mp3Cache)
-    {
-        if (fwrite(&entry, sizeof(entry), 1, f) != 1)
-            goto fail;
-    }
-
-    // 🔐 Flush everything (best effort on Switch)
-    fflush(f);
-    fsync(fileno(f));
-    fclose(f);
-
-    // 🔐 Atomic replace
-    remove(MP3_CACHE_PATH); // ignore failure
-    if (rename(MP3_CACHE_TMP_PATH, MP3_CACHE_PATH) != 0)
-    {
-        remove(MP3_CACHE_TMP_PATH);
-        return;
-    }
-
-    debugLog("[CACHE] Atomically wrote %zu entries\n", g_mp3Cache.size());
-    return;
-
-fail:
-    fclose(f);
-    remove(MP3_CACHE_TMP_PATH);
-}
-
 void mp3ReloadAllMetadata()
 {
-    playlistMetadata.clear();
-
     int count = playlistGetCount();
     for (int i = 0; i < count; i++)
     {
@@ -988,12 +247,10 @@ void mp3ReloadAllMetadata()
         if (!path) continue;
 
         Mp3MetadataEntry entry;
-        readMp3Metadata(path, entry);
-        readID3v1Fallback(path, entry);
-        readMp3BitrateAndRate(path, entry.bitrateKbps, entry.sampleRateKHz, entry.channels);
-        // after readMp3BitrateAndRate(...)
-        //entry.durationSeconds = getMp3DurationSeconds(path, entry.bitrateKbps);
-        entry.durationSeconds = getMp3DurationSeconds(path, entry.bitrateKbps, entry.id3TagBytes);
+        Mp3ProbeInfo info;
+        mp3Probe(path, entry, &info);
+        if (!info.exactLength)
+            entry.durationSeconds = getMp3DurationSeconds(path, entry.bitrateKbps, entry.id3TagBytes);
         // 🔍 If duration looks suspicious, force accurate scan
         if (entry.durationSeconds < 5 || entry.durationSeconds > 3600)
         {
@@ -1005,30 +262,13 @@ void mp3ReloadAllMetadata()
         }
 
 
-        RuntimeMetadata r{};
-        strncpy(r.path, path, sizeof(r.path) - 1);
-        r.meta = entry;
-        playlistMetadata.push_back(r);
+        trackSetMetadata(playlistGetTrackId(i), entry);
     }
 }
 
-const Mp3MetadataEntry* mp3GetTrackMetadata(int globalIndex)
-{
-    if (globalIndex < 0 || globalIndex >= playlistGetCount()) return nullptr;
-    const char* path = playlistGetTrack(globalIndex);
-    if (!path) return nullptr;
-
-    for (auto& r : playlistMetadata)
-        if (strcmp(r.path, path) == 0)
-            return &r.meta;
-
-    return nullptr;
-}
-
-
 int mp3GetPlaylistCount()
 {
-    return playlistMetadata.size();
+    return g_mp3TrackCount;
 }
 
 bool mp3Load(const char* path)
@@ -1036,10 +276,11 @@ bool mp3Load(const char* path)
     if (!path) return false;
 
     Mp3MetadataEntry entry;
-    readMp3Metadata(path, entry);
-    readMp3BitrateAndRate(path, entry.bitrateKbps, entry.sampleRateKHz, entry.channels);
+    Mp3ProbeInfo info;
+    mp3Probe(path, entry, &info);
 
-    entry.durationSeconds = getMp3DurationSeconds(path, entry.bitrateKbps, entry.id3TagBytes);
+    if (!info.exactLength)
+        entry.durationSeconds = getMp3DurationSeconds(path, entry.bitrateKbps, entry.id3TagBytes);
     if (entry.durationSeconds < 5 || entry.durationSeconds > 3600)
     {
         int tempBitrate = 0;
@@ -1048,11 +289,11 @@ bool mp3Load(const char* path)
     }
 
 
-    playlistAdd(path);
-    RuntimeMetadata r{};
-    strncpy(r.path, path, sizeof(r.path) - 1);
-    r.meta = entry;
-    playlistMetadata.push_back(r);
+    TrackId id = playlistAdd(path);
+    if (id == TRACK_ID_NONE)
+        return false;
+    trackSetMetadata(id, entry);
+    g_mp3TrackCount++;
     debugLog("\n=== MP3 LOADED ===\n");
     debugLog("File: %s\n", path);
     debugLog("Title: %s\n", entry.title);
@@ -6,22 +6,14 @@
 #include <stdbool.h>
 #include <switch.h>      // gives socketInitializeDefault + nxlinkStdio
 
-#define MP3_CACHE_VERSION 2
-
 // Folder tracking
 bool mp3IsFolderLoaded(const char* path);
 void mp3SetLoadedFolder(const char* path);
-void mp3CancelAllScans();
 //void mp3FlushCacheIfNeeded();
 
 // Optional debug logging
 void debugLog(const char* fmt, ...);
 
-struct Mp3CacheHeader {
-    uint32_t magic;   // 'MP3C'
-    uint32_t version;
-};
-
 struct Mp3MetadataEntry
 {
     char title[128];
@@ -45,29 +37,12 @@ struct Mp3MetadataEntry
     float replayGainAlbumPeak = 1.0f;
 };
 
-struct RuntimeMetadata
-{
-    char path[512];
-    Mp3MetadataEntry meta;
-};
-
-struct Mp3CacheEntry
-{
-    char path[512];
-    time_t mtime;
-    Mp3MetadataEntry meta;
-};
-
-// Cache
-
-void mp3LoadCache(const char* folderKey);
-void mp3StartBackgroundScanner();
-void mp3StopBackgroundScanner();
+// Scanning runs on the shared scanner pool (scanpool.h)
 
 // --- Playlist metadata management ---
 void mp3LoadPlaylist();
 
-const Mp3MetadataEntry* mp3GetTrackMetadata(int index);
+// Per-track metadata lives in the track table — see playlistGetMetadata()
 int mp3GetPlaylistCount();
 
 // --- Load single MP3 ---
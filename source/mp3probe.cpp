@@ -0,0 +1,839 @@
+#include "mp3probe.h"
+#include "metacache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <vector>
+
+#define MP3PROBE_FRAME_BYTES 8192   // enough for two of the largest frames
+#define ID3V1_BYTES          128
+
+/* -------------------------------------------------------
+   Byte helpers
+------------------------------------------------------- */
+static inline uint32_t be32(const uint8_t* b)
+{
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static inline uint32_t be24(const uint8_t* b)
+{
+    return ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
+}
+
+static inline uint32_t syncsafe32(const uint8_t* b)
+{
+    return ((uint32_t)(b[0] & 0x7F) << 21) | ((uint32_t)(b[1] & 0x7F) << 14) |
+           ((uint32_t)(b[2] & 0x7F) << 7)  |  (uint32_t)(b[3] & 0x7F);
+}
+
+// Undo ID3 unsynchronisation (0xFF 0x00 -> 0xFF) into dst
+static void unsynchronise(const uint8_t* src, size_t len, std::vector<uint8_t>& dst)
+{
+    dst.clear();
+    dst.reserve(len);
+    for (size_t i = 0; i < len; i++)
+    {
+        dst.push_back(src[i]);
+        if (src[i] == 0xFF && i + 1 < len && src[i + 1] == 0x00)
+            i++;
+    }
+}
+
+/* -------------------------------------------------------
+   ReplayGain (TXXX frames)
+------------------------------------------------------- */
+static void parseReplayGain(const char* key, const char* value, Mp3MetadataEntry& entry)
+{
+    if (!key || !value) return;
+
+    if (strcasecmp(key, "REPLAYGAIN_TRACK_GAIN") == 0)
+    {
+        float db = 0.0f;
+        if (sscanf(value, "%f", &db) == 1)
+        {
+            entry.replayGainDb = db;
+            entry.hasTrackReplayGain = true;
+        }
+    }
+    else if (strcasecmp(key, "REPLAYGAIN_TRACK_PEAK") == 0)
+    {
+        float peak = 0.0f;
+        if (sscanf(value, "%f", &peak) == 1 && peak > 0.0f)
+            entry.replayGainPeak = peak;
+    }
+    else if (strcasecmp(key, "REPLAYGAIN_ALBUM_GAIN") == 0)
+    {
+        float db = 0.0f;
+        if (sscanf(value, "%f", &db) == 1)
+        {
+            entry.replayGainAlbumDb = db;
+            entry.hasAlbumReplayGain = true;
+        }
+    }
+    else if (strcasecmp(key, "REPLAYGAIN_ALBUM_PEAK") == 0)
+    {
+        float peak = 0.0f;
+        if (sscanf(value, "%f", &peak) == 1 && peak > 0.0f)
+            entry.replayGainAlbumPeak = peak;
+    }
+}
+
+/* -------------------------------------------------------
+   ID3 text → UTF-8
+------------------------------------------------------- */
+static bool putUtf8(char* out, size_t outSize, size_t& pos, uint32_t cp)
+{
+    char tmp[4];
+    size_t n;
+    if (cp < 0x80)         { tmp[0] = (char)cp; n = 1; }
+    else if (cp < 0x800)   { tmp[0] = (char)(0xC0 | (cp >> 6));
+                             tmp[1] = (char)(0x80 | (cp & 0x3F)); n = 2; }
+    else if (cp < 0x10000) { tmp[0] = (char)(0xE0 | (cp >> 12));
+                             tmp[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                             tmp[2] = (char)(0x80 | (cp & 0x3F)); n = 3; }
+    else                   { tmp[0] = (char)(0xF0 | (cp >> 18));
+                             tmp[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                             tmp[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                             tmp[3] = (char)(0x80 | (cp & 0x3F)); n = 4; }
+
+    if (pos + n >= outSize) return false;   // keep room for the terminator
+    memcpy(out + pos, tmp, n);
+    pos += n;
+    return true;
+}
+
+// Decode one NUL-terminated string in the given ID3 encoding.
+// Returns the bytes consumed, terminator included.
+static size_t decodeString(int encoding, const uint8_t* p, size_t size,
+                           char* out, size_t outSize)
+{
+    size_t pos = 0;
+    size_t i   = 0;
+    bool full  = false;
+
+    if (encoding == 1 || encoding == 2)   // UTF-16 with BOM / UTF-16BE
+    {
+        bool bigEndian = (encoding == 2);
+        if (encoding == 1 && size >= 2)
+        {
+            if (p[0] == 0xFF && p[1] == 0xFE) { bigEndian = false; i = 2; }
+            else if (p[0] == 0xFE && p[1] == 0xFF) { bigEndian = true; i = 2; }
+        }
+
+        for (; i + 1 < size; i += 2)
+        {
+            uint32_t ch = bigEndian ? (p[i] << 8) | p[i + 1] : (p[i + 1] << 8) | p[i];
+            if (ch == 0) { i += 2; break; }
+
+            // Surrogate pair
+            if (ch >= 0xD800 && ch < 0xDC00 && i + 3 < size)
+            {
+                uint32_t lo = bigEndian ? (p[i + 2] << 8) | p[i + 3] : (p[i + 3] << 8) | p[i + 2];
+                if (lo >= 0xDC00 && lo < 0xE000)
+                {
+                    ch = 0x10000 + ((ch - 0xD800) << 10) + (lo - 0xDC00);
+                    i += 2;
+                }
+            }
+            if (!full && !putUtf8(out, outSize, pos, ch)) full = true;
+        }
+    }
+    else   // 0 = ISO-8859-1, 3 = UTF-8
+    {
+        for (; i < size; i++)
+        {
+            if (p[i] == 0) { i++; break; }
+            if (full) continue;
+            if (encoding == 3 || p[i] < 0x80)
+            {
+                if (pos + 1 < outSize) out[pos++] = (char)p[i];
+                else full = true;
+            }
+            else if (!putUtf8(out, outSize, pos, p[i]))
+                full = true;
+        }
+    }
+
+    if (outSize) out[pos] = '\0';
+    return i;
+}
+
+static void readTextFrame(const uint8_t* p, size_t size, char* out, size_t outSize)
+{
+    if (size < 1 || outSize == 0) return;
+    decodeString(p[0], p + 1, size - 1, out, outSize);
+}
+
+static void readTxxxFrame(const uint8_t* p, size_t size, Mp3MetadataEntry& entry)
+{
+    if (size < 2) return;
+
+    // TXXX = encoding, description\0, value
+    char key[64], value[64];
+    size_t used = decodeString(p[0], p + 1, size - 1, key, sizeof(key));
+    if (used >= size - 1) return;
+    decodeString(p[0], p + 1 + used, size - 1 - used, value, sizeof(value));
+    parseReplayGain(key, value, entry);
+}
+
+/* -------------------------------------------------------
+   ID3v2.2 / 2.3 / 2.4
+   `avail` may be shorter than the tag when the head window
+   cut it off (cover art); parsing just stops there.
+------------------------------------------------------- */
+static void parseId3v2(const uint8_t* tag, size_t avail, Mp3MetadataEntry& entry)
+{
+    int      version  = tag[3];
+    uint8_t  flags    = tag[5];
+    uint32_t tagSize  = syncsafe32(tag + 6);
+
+    const uint8_t* body = tag + 10;
+    size_t bodyLen = avail - 10;
+    if (bodyLen > tagSize) bodyLen = tagSize;
+
+    std::vector<uint8_t> plain;
+    if ((flags & 0x80) && version < 4)
+    {
+        // v2.2/2.3 unsynchronise the whole tag
+        unsynchronise(body, bodyLen, plain);
+        body = plain.data();
+        bodyLen = plain.size();
+    }
+
+    size_t pos = 0;
+    if ((flags & 0x40) && version >= 3 && bodyLen >= 4)
+    {
+        // Extended header: v2.3 size excludes itself, v2.4 includes it
+        pos = (version == 3) ? 4 + be32(body) : syncsafe32(body);
+    }
+
+    const size_t hdrBytes = (version == 2) ? 6 : 10;
+    std::vector<uint8_t> frameBuf;
+
+    while (pos + hdrBytes <= bodyLen)
+    {
+        const uint8_t* fh = body + pos;
+        if (fh[0] == 0) break;   // padding
+
+        char     id[5] = {0};
+        uint32_t size;
+        uint8_t  fmtFlags = 0;
+
+        if (version == 2)
+        {
+            memcpy(id, fh, 3);
+            size = be24(fh + 3);
+
+            // Map the v2.2 IDs we care about onto their v2.3 names
+            if      (strcmp(id, "TT2") == 0) strcpy(id, "TIT2");
+            else if (strcmp(id, "TP1") == 0) strcpy(id, "TPE1");
+            else if (strcmp(id, "TP2") == 0) strcpy(id, "TPE2");
+            else if (strcmp(id, "TXX") == 0) strcpy(id, "TXXX");
+        }
+        else
+        {
+            memcpy(id, fh, 4);
+            size = (version == 4) ? syncsafe32(fh + 4) : be32(fh + 4);
+            fmtFlags = fh[9];
+        }
+
+        if (size == 0 || pos + hdrBytes + size > bodyLen) break;
+
+        const uint8_t* data = fh + hdrBytes;
+        size_t dataLen = size;
+        pos += hdrBytes + size;
+
+        if (id[0] != 'T') continue;   // only text frames are of interest
+
+        if (version == 3)
+        {
+            if (fmtFlags & 0xC0) continue;              // compressed / encrypted
+            if (fmtFlags & 0x20) { data++; dataLen--; } // grouping ID
+        }
+        else if (version == 4)
+        {
+            if (fmtFlags & 0x0C) continue;              // compressed / encrypted
+            if (fmtFlags & 0x40) { data++; dataLen--; } // grouping ID
+            if (fmtFlags & 0x01)                        // data length indicator
+            {
+                if (dataLen < 4) continue;
+                data += 4; dataLen -= 4;
+            }
+            if (fmtFlags & 0x02)                        // per-frame unsync
+            {
+                unsynchronise(data, dataLen, frameBuf);
+                data = frameBuf.data();
+                dataLen = frameBuf.size();
+            }
+        }
+
+        if (strcmp(id, "TIT2") == 0)
+            readTextFrame(data, dataLen, entry.title, sizeof(entry.title));
+        else if (strcmp(id, "TPE1") == 0)
+            readTextFrame(data, dataLen, entry.artist, sizeof(entry.artist));
+        else if (strcmp(id, "TPE2") == 0 && entry.artist[0] == 0)   // album artist fallback
+            readTextFrame(data, dataLen, entry.artist, sizeof(entry.artist));
+        else if (strcmp(id, "TXXX") == 0)
+            readTxxxFrame(data, dataLen, entry);
+    }
+}
+
+/* -------------------------------------------------------
+   ID3v1
+------------------------------------------------------- */
+static void copyId3v1Field(const uint8_t* src, char* out, size_t outSize)
+{
+    // Fixed 30-byte Latin-1 field, NUL- or space-padded
+    size_t len = 0;
+    while (len < 30 && src[len]) len++;
+    while (len > 0 && src[len - 1] == ' ') len--;
+
+    size_t pos = 0;
+    for (size_t i = 0; i < len; i++)
+        if (!putUtf8(out, outSize, pos, src[i])) break;
+    out[pos] = '\0';
+}
+
+static void parseId3v1(const uint8_t* tag, Mp3MetadataEntry& entry)
+{
+    if (!entry.title[0])  copyId3v1Field(tag + 3,  entry.title,  sizeof(entry.title));
+    if (!entry.artist[0]) copyId3v1Field(tag + 33, entry.artist, sizeof(entry.artist));
+}
+
+/* -------------------------------------------------------
+   MPEG audio frame header
+------------------------------------------------------- */
+struct MpegHeader
+{
+    int  version;        // 10 / 20 / 25
+    int  layer;
+    int  bitrateKbps;    // 0 for free format
+    int  sampleRate;
+    int  channels;
+    int  samplesPerFrame;
+    int  padding;        // bytes (4 for layer I)
+    int  frameBytes;     // 0 for free format until the slot size is known
+    bool freeFormat;
+};
+
+static bool parseMpegHeader(const uint8_t* h, MpegHeader& out)
+{
+    static const int kBitrates[5][16] = {
+        { 0, 32, 64, 96,128,160,192,224,256,288,320,352,384,416,448, 0 },   // V1 L1
+        { 0, 32, 48, 56, 64, 80, 96,112,128,160,192,224,256,320,384, 0 },   // V1 L2
+        { 0, 32, 40, 48, 56, 64, 80, 96,112,128,160,192,224,256,320, 0 },   // V1 L3
+        { 0, 32, 48, 56, 64, 80, 96,112,128,144,160,176,192,224,256, 0 },   // V2 L1
+        { 0,  8, 16, 24, 32, 40, 48, 56, 64, 80, 96,112,128,144,160, 0 },   // V2 L2/L3
+    };
+    static const int kRates[3] = { 44100, 48000, 32000 };
+
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) return false;
+
+    int verBits   = (h[1] >> 3) & 3;
+    int layerBits = (h[1] >> 1) & 3;
+    int brIndex   = h[2] >> 4;
+    int srIndex   = (h[2] >> 2) & 3;
+
+    if (verBits == 1 || layerBits == 0 || brIndex == 15 || srIndex == 3)
+        return false;   // reserved values
+
+    out.version = (verBits == 3) ? 10 : (verBits == 2) ? 20 : 25;
+    out.layer   = 4 - layerBits;
+
+    int table = (out.version == 10) ? out.layer - 1 : (out.layer == 1 ? 3 : 4);
+    out.bitrateKbps = kBitrates[table][brIndex];
+    out.sampleRate  = kRates[srIndex] >> (out.version == 10 ? 0 : out.version == 20 ? 1 : 2);
+    out.channels    = ((h[3] >> 6) == 3) ? 1 : 2;
+    out.freeFormat  = (brIndex == 0);
+    out.padding     = ((h[2] >> 1) & 1) * (out.layer == 1 ? 4 : 1);
+
+    if (out.layer == 1)
+        out.samplesPerFrame = 384;
+    else
+        out.samplesPerFrame = (out.layer == 3 && out.version != 10) ? 576 : 1152;
+
+    out.frameBytes = 0;
+    if (out.freeFormat) return true;
+
+    if (out.layer == 1)
+        out.frameBytes = 12 * out.bitrateKbps * 1000 / out.sampleRate * 4 + out.padding;
+    else
+        out.frameBytes = out.samplesPerFrame / 8 * out.bitrateKbps * 1000 / out.sampleRate + out.padding;
+    return out.frameBytes > 4;
+}
+
+// Free-format streams don't encode their bitrate; the slot size is the
+// distance to the next header with the same fixed fields, less padding.
+// Returns 0 if no such header is within reach.
+#define MP3_FREE_FORMAT_MAX_BYTES 4096
+
+static int freeFormatSlotBytes(const uint8_t* buf, size_t len, size_t pos, const MpegHeader& hdr)
+{
+    const uint8_t* h = buf + pos;
+    size_t limit = pos + MP3_FREE_FORMAT_MAX_BYTES;
+    if (limit > len - 4) limit = len - 4;
+
+    for (size_t j = pos + 16; j <= limit; j++)
+    {
+        if (buf[j] == 0xFF && buf[j + 1] == h[1] && (buf[j + 2] & 0xFD) == (h[2] & 0xFD))
+            return (int)(j - pos) - hdr.padding;
+    }
+    return 0;
+}
+
+static void setFreeFormatSize(MpegHeader& hdr, int slotBytes)
+{
+    hdr.frameBytes  = slotBytes + hdr.padding;
+    hdr.bitrateKbps = (int)((int64_t)slotBytes * 8 * hdr.sampleRate / hdr.samplesPerFrame / 1000);
+}
+
+// First header in buf that is followed by a matching one (or by the
+// end of the buffer). Returns the offset, or -1.
+static long findFirstFrame(const uint8_t* buf, size_t len, MpegHeader& out)
+{
+    for (size_t i = 0; i + 4 <= len; i++)
+    {
+        if (buf[i] != 0xFF) continue;
+        if (!parseMpegHeader(buf + i, out)) continue;
+
+        if (out.freeFormat)
+        {
+            int slot = freeFormatSlotBytes(buf, len, i, out);
+            if (slot <= 0) continue;
+            setFreeFormatSize(out, slot);
+            return (long)i;   // the slot search already matched the next header
+        }
+
+        size_t next = i + out.frameBytes;
+        if (next + 4 > len) return (long)i;
+
+        MpegHeader n;
+        if (parseMpegHeader(buf + next, n) &&
+            n.version == out.version && n.layer == out.layer &&
+            n.sampleRate == out.sampleRate)
+            return (long)i;
+    }
+    return -1;
+}
+
+/* -------------------------------------------------------
+   Xing / Info / VBRI / LAME  (all live in the first frame)
+------------------------------------------------------- */
+static size_t xingOffset(const MpegHeader& hdr)
+{
+    // Xing sits after the side info, whose size depends on version and mode
+    size_t side = (hdr.version == 10) ? (hdr.channels == 1 ? 17 : 32)
+                                      : (hdr.channels == 1 ? 9 : 17);
+    return 4 + side;
+}
+
+#define VBRI_OFFSET (4 + 32)   // VBRI always sits 32 bytes after the header
+
+// True for a tag frame that carries no audio (decoders skip it)
+static bool isInfoFrame(const uint8_t* frame, size_t avail, const MpegHeader& hdr)
+{
+    size_t end = (size_t)hdr.frameBytes < avail ? (size_t)hdr.frameBytes : avail;
+    size_t x = xingOffset(hdr);
+    if (x + 4 <= end && (memcmp(frame + x, "Xing", 4) == 0 || memcmp(frame + x, "Info", 4) == 0))
+        return true;
+    return VBRI_OFFSET + 4 <= end && memcmp(frame + VBRI_OFFSET, "VBRI", 4) == 0;
+}
+static void parseVbrHeaders(const uint8_t* frame, size_t avail, const MpegHeader& hdr,
+                            Mp3ProbeInfo& info, Mp3MetadataEntry& entry)
+{
+    size_t end = (size_t)hdr.frameBytes < avail ? (size_t)hdr.frameBytes : avail;
+
+    size_t x = xingOffset(hdr);
+
+    if (x + 8 <= end && (memcmp(frame + x, "Xing", 4) == 0 || memcmp(frame + x, "Info", 4) == 0))
+    {
+        info.hasXing = true;
+        uint32_t flags = be32(frame + x + 4);
+        size_t p = x + 8;
+
+        if ((flags & 0x1) && p + 4 <= end) { info.vbrFrames = be32(frame + p); p += 4; }
+        if ((flags & 0x2) && p + 4 <= end) { info.vbrBytes  = be32(frame + p); p += 4; }
+        if (flags & 0x4) p += 100;   // seek TOC
+        if (flags & 0x8) p += 4;     // quality
+
+        // LAME extension (ffmpeg writes a compatible one tagged "Lavc")
+        if (p + 24 <= end &&
+            (memcmp(frame + p, "LAME", 4) == 0 || memcmp(frame + p, "Lavc", 4) == 0))
+        {
+            const uint8_t* l = frame + p;
+            info.hasLame = true;
+
+            uint32_t dp = be24(l + 21);
+            info.encoderDelay   = (int)(dp >> 12);
+            info.encoderPadding = (int)(dp & 0xFFF);
+
+            // Radio (track) gain: name(3) originator(3) sign(1) value(9) in 0.1 dB
+            uint16_t rg = (uint16_t)((l[15] << 8) | l[16]);
+            int name = rg >> 13, originator = (rg >> 10) & 7, val = rg & 0x1FF;
+            if (!entry.hasTrackReplayGain && name == 1 && originator != 0 && val != 0)
+            {
+                entry.replayGainDb = ((rg & 0x200) ? -val : val) / 10.0f;
+                entry.hasTrackReplayGain = true;
+
+                uint32_t peak = be32(l + 11);   // 1.0 == 1 << 23
+                if (peak)
+                    entry.replayGainPeak = peak / 8388608.0f;
+            }
+        }
+        return;
+    }
+
+    const size_t v = VBRI_OFFSET;
+    if (v + 18 <= end && memcmp(frame + v, "VBRI", 4) == 0)
+    {
+        info.hasVbri   = true;
+        info.vbrBytes  = be32(frame + v + 10);
+        info.vbrFrames = be32(frame + v + 14);
+    }
+}
+
+/* -------------------------------------------------------
+   Probe
+------------------------------------------------------- */
+bool mp3Probe(const char* path, Mp3MetadataEntry& entry, Mp3ProbeInfo* infoOut)
+{
+    Mp3ProbeInfo info;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.replayGainPeak      = 1.0f;
+    entry.replayGainAlbumPeak = 1.0f;
+
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    setvbuf(f, nullptr, _IONBF, 0);   // two big reads — stdio buffering only adds a copy
+
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0) { fclose(f); return false; }
+    info.fileBytes = st.st_size;
+    info.audioEnd  = st.st_size;
+
+    // --- Read 1: head ---
+    std::vector<uint8_t> head(info.fileBytes < MP3PROBE_HEAD_BYTES
+                              ? (size_t)info.fileBytes : MP3PROBE_HEAD_BYTES);
+    size_t headLen = fread(head.data(), 1, head.size(), f);
+
+    // --- Read 2: ID3v1 tail ---
+    uint8_t tail[ID3V1_BYTES];
+    bool hasV1 = false;
+    if (info.fileBytes >= ID3V1_BYTES &&
+        fseek(f, -ID3V1_BYTES, SEEK_END) == 0 &&
+        fread(tail, 1, ID3V1_BYTES, f) == ID3V1_BYTES &&
+        memcmp(tail, "TAG", 3) == 0)
+    {
+        hasV1 = true;
+        info.audioEnd -= ID3V1_BYTES;
+    }
+
+    // --- ID3v2 ---
+    if (headLen >= 10 && memcmp(head.data(), "ID3", 3) == 0 && head[3] >= 2 && head[3] <= 4)
+    {
+        int64_t total = 10 + (int64_t)syncsafe32(&head[6]);
+        if (head[3] == 4 && (head[5] & 0x10)) total += 10;   // footer
+        entry.id3TagBytes = (int)total;
+        info.audioStart   = total;
+
+        parseId3v2(head.data(), headLen, entry);
+    }
+    if (hasV1) parseId3v1(tail, entry);
+
+    // --- First frame ---
+    const uint8_t* audio = nullptr;
+    size_t audioLen = 0;
+    std::vector<uint8_t> frameBuf;
+
+    if (info.audioStart < (int64_t)headLen)
+    {
+        audio    = head.data() + info.audioStart;
+        audioLen = headLen - (size_t)info.audioStart;
+    }
+    else if (info.audioStart < info.fileBytes)
+    {
+        // Tag outgrew the head window — one small read past it
+        frameBuf.resize(MP3PROBE_FRAME_BYTES);
+        if (fseek(f, (long)info.audioStart, SEEK_SET) == 0)
+            audioLen = fread(frameBuf.data(), 1, frameBuf.size(), f);
+        audio = frameBuf.data();
+    }
+    fclose(f);
+
+    MpegHeader hdr;
+    long first = audio ? findFirstFrame(audio, audioLen, hdr) : -1;
+    if (first < 0)
+    {
+        debugLog("[MP3] %s NO MPEG FRAME FOUND\n", path);
+        if (infoOut) *infoOut = info;
+        return false;
+    }
+
+    info.audioStart     += first;
+    info.mpegVersion     = hdr.version;
+    info.layer           = hdr.layer;
+    info.sampleRate      = hdr.sampleRate;
+    info.channels        = hdr.channels;
+    info.samplesPerFrame = hdr.samplesPerFrame;
+
+    parseVbrHeaders(audio + first, audioLen - first, hdr, info, entry);
+
+    entry.sampleRateKHz = hdr.sampleRate / 1000;
+    entry.channels      = hdr.channels;
+
+    int64_t audioBytes = info.audioEnd - info.audioStart;
+    if (audioBytes < 0) audioBytes = 0;
+
+    if (info.vbrFrames > 0)
+    {
+        // Exact: frame count from the Xing/VBRI header
+        int64_t samples = (int64_t)info.vbrFrames * hdr.samplesPerFrame
+                        - info.encoderDelay - info.encoderPadding;
+        if (samples < 0) samples = 0;
+        double seconds = (double)samples / hdr.sampleRate;
+
+        uint32_t bytes = info.vbrBytes ? info.vbrBytes : (uint32_t)audioBytes;
+        entry.durationSeconds = (int)seconds;
+        entry.bitrateKbps     = seconds > 0.0 ? (int)(bytes * 8.0 / seconds / 1000.0)
+                                              : hdr.bitrateKbps;
+        info.exactLength      = true;
+    }
+    else
+    {
+        // CBR estimate from the first frame's bitrate
+        entry.bitrateKbps     = hdr.bitrateKbps;
+        entry.durationSeconds = (int)(audioBytes * 8.0 / (hdr.bitrateKbps * 1000.0));
+    }
+
+    if (infoOut) *infoOut = info;
+    return true;
+}
+
+/* -------------------------------------------------------
+   Frame walk
+------------------------------------------------------- */
+#define MP3WALK_LOOKAHEAD 8192   // a frame plus the next header, with room to resync
+
+bool mp3WalkFrames(const char* path, const Mp3ProbeInfo& probe, Mp3FrameWalk* out)
+{
+    if (!out) return false;
+    *out = Mp3FrameWalk{};
+    if (probe.sampleRate == 0) return false;   // the probe found no frame
+
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    setvbuf(f, nullptr, _IONBF, 0);
+
+    const int64_t end = probe.audioEnd;
+    int64_t pos = probe.audioStart;
+    if (fseek(f, (long)pos, SEEK_SET) != 0) { fclose(f); return false; }
+
+    u64 t0 = svcGetSystemTick();
+
+    std::vector<uint8_t> buf(MP3WALK_BLOCK_BYTES);
+    int64_t bufStart = pos;
+    size_t  bufLen   = 0;
+
+    // Make at least `need` bytes from pos resident (as far as the audio
+    // goes) and return how many are. pos only ever moves forward, so the
+    // unread tail slides down and the file is read strictly in sequence.
+    auto fill = [&](size_t need) -> size_t
+    {
+        int64_t resident = bufStart + (int64_t)bufLen - pos;
+        if (resident >= (int64_t)need) return (size_t)resident;
+
+        size_t have = 0;
+        if (resident > 0)
+        {
+            have = (size_t)resident;
+            memmove(buf.data(), buf.data() + (pos - bufStart), have);
+        }
+        else if (resident < 0 && fseek(f, (long)pos, SEEK_SET) != 0)
+        {
+            return 0;
+        }
+        bufStart = pos;
+
+        int64_t left = end - (pos + (int64_t)have);
+        size_t  want = buf.size() - have;
+        if ((int64_t)want > left) want = left > 0 ? (size_t)left : 0;
+        if (want) have += fread(buf.data() + have, 1, want, f);
+
+        bufLen = have;
+        return have;
+    };
+
+    MpegHeader ref{};
+    bool     haveRef     = false;
+    bool     firstFrame  = true;
+    bool     resyncing   = false;
+    int      freeSlot    = 0;
+    int      lastRate    = 0;
+    uint64_t rawSamples  = 0;
+    bool     indexOk     = true;
+
+    while (pos + 4 <= end)
+    {
+        size_t avail = fill(MP3WALK_LOOKAHEAD);
+        if (avail < 4) break;
+        const uint8_t* h = buf.data() + (pos - bufStart);
+
+        if (h[0] != 0xFF)
+        {
+            // Junk between frames: jump to the next candidate sync byte
+            if (!resyncing) { out->resyncs++; resyncing = true; }
+            const uint8_t* p = (const uint8_t*)memchr(h + 1, 0xFF, avail - 1);
+            pos += p ? (p - h) : (int64_t)avail;
+            continue;
+        }
+
+        out->headers++;
+        MpegHeader hdr;
+        bool ok = parseMpegHeader(h, hdr) &&
+                  (!haveRef || (hdr.version == ref.version && hdr.layer == ref.layer));
+
+        if (ok && hdr.freeFormat)
+        {
+            if (!freeSlot) freeSlot = freeFormatSlotBytes(h, avail, 0, hdr);
+            if (freeSlot) setFreeFormatSize(hdr, freeSlot);
+            else ok = false;
+        }
+
+        // After junk, only trust a header that the next one confirms
+        if (ok && resyncing && (size_t)hdr.frameBytes + 4 <= avail)
+        {
+            MpegHeader n;
+            ok = parseMpegHeader(h + hdr.frameBytes, n) &&
+                 n.version == hdr.version && n.layer == hdr.layer;
+        }
+
+        if (!ok)
+        {
+            if (!resyncing) { out->resyncs++; resyncing = true; }
+            pos++;
+            continue;
+        }
+        resyncing = false;
+
+        if (pos + hdr.frameBytes > end) break;   // truncated last frame
+
+        if (!haveRef)
+        {
+            ref = hdr;
+            haveRef = true;
+            out->sampleRate = lastRate = hdr.sampleRate;
+        }
+        else if (hdr.sampleRate != lastRate)
+        {
+            out->rateChanges++;
+            lastRate = hdr.sampleRate;
+        }
+
+        if (firstFrame)
+        {
+            firstFrame = false;
+            if (isInfoFrame(h, avail, hdr)) { pos += hdr.frameBytes; continue; }
+        }
+
+        // Offset table: one entry every indexStep frames, halved when full
+        if (indexOk && out->frames % out->indexStep == 0)
+        {
+            if (out->index.size() == MP3_INDEX_MAX_ENTRIES)
+            {
+                for (size_t i = 0; i < MP3_INDEX_MAX_ENTRIES / 2; i++)
+                    out->index[i] = out->index[i * 2];
+                out->index.resize(MP3_INDEX_MAX_ENTRIES / 2);
+                out->indexStep *= 2;
+            }
+            if (out->frames % out->indexStep == 0)
+            {
+                if (pos > (int64_t)UINT32_MAX) { indexOk = false; out->index.clear(); }
+                else out->index.push_back((uint32_t)pos);
+            }
+        }
+
+        out->frames++;
+        out->audioBytes += hdr.frameBytes;
+        out->seconds    += (double)hdr.samplesPerFrame / hdr.sampleRate;
+        rawSamples      += hdr.samplesPerFrame;
+        pos             += hdr.frameBytes;
+    }
+
+    fclose(f);
+
+    // Gapless trim from the LAME tag
+    int64_t trim = probe.hasLame ? probe.encoderDelay + probe.encoderPadding : 0;
+    if (trim > (int64_t)rawSamples) trim = (int64_t)rawSamples;
+    out->samples = rawSamples - trim;
+    if (out->sampleRate) out->seconds -= (double)trim / out->sampleRate;
+
+    out->walkTicks = svcGetSystemTick() - t0;
+    double ms = out->walkTicks / 19200.0;
+    printf("[MP3] Frame walk: %u headers, %llu frames, %u resyncs in %.1f ms (%.0f headers/s)\n",
+           out->headers, (unsigned long long)out->frames, out->resyncs, ms,
+           ms > 0.0 ? out->headers * 1000.0 / ms : 0.0);
+
+    return out->frames > 0;
+}
+
+/* -------------------------------------------------------
+   Offset table blob
+------------------------------------------------------- */
+#define MP3_INDEX_VERSION 1
+
+struct Mp3IndexBlob   // followed by `count` uint32 offsets
+{
+    uint32_t version;
+    uint32_t step;
+    uint32_t count;
+    uint32_t sampleRate;
+    uint64_t frames;
+    uint64_t samples;
+};
+
+void mp3IndexSave(const char* path, const Mp3FrameWalk& walk)
+{
+    if (!path || walk.index.empty()) return;
+
+    std::vector<uint8_t> blob(sizeof(Mp3IndexBlob) + walk.index.size() * sizeof(uint32_t));
+    Mp3IndexBlob hdr;
+    hdr.version    = MP3_INDEX_VERSION;
+    hdr.step       = walk.indexStep;
+    hdr.count      = (uint32_t)walk.index.size();
+    hdr.sampleRate = (uint32_t)walk.sampleRate;
+    hdr.frames     = walk.frames;
+    hdr.samples    = walk.samples;
+
+    memcpy(blob.data(), &hdr, sizeof(hdr));
+    memcpy(blob.data() + sizeof(hdr), walk.index.data(), walk.index.size() * sizeof(uint32_t));
+    metaCachePutBlob(path, MP3_INDEX_BLOB_TAG, blob.data(), blob.size());
+}
+
+bool mp3IndexLoad(const char* path, Mp3FrameWalk* out)
+{
+    if (!path || !out) return false;
+
+    std::vector<uint8_t> blob;
+    if (!metaCacheGetBlob(path, MP3_INDEX_BLOB_TAG, &blob) || blob.size() < sizeof(Mp3IndexBlob))
+        return false;
+
+    Mp3IndexBlob hdr;
+    memcpy(&hdr, blob.data(), sizeof(hdr));
+    if (hdr.version != MP3_INDEX_VERSION || hdr.step == 0 ||
+        blob.size() != sizeof(hdr) + (size_t)hdr.count * sizeof(uint32_t))
+        return false;
+
+    *out = Mp3FrameWalk{};
+    out->frames     = hdr.frames;
+    out->samples    = hdr.samples;
+    out->sampleRate = (int)hdr.sampleRate;
+    out->seconds    = hdr.sampleRate ? (double)hdr.samples / hdr.sampleRate : 0.0;
+    out->indexStep  = hdr.step;
+    out->index.resize(hdr.count);
+    memcpy(out->index.data(), blob.data() + sizeof(hdr), (size_t)hdr.count * sizeof(uint32_t));
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "mp3.h"
+#include <stdint.h>
+#include <vector>
+
+/* -------------------------------------------------------
+   Single-open MP3 probe
+   Fills a complete Mp3MetadataEntry from one open of the
+   file, replacing the old three-open path (ID3v2 reader,
+   ID3v1 fallback, header/bitrate reader) plus a stat().
+
+   - Two large reads: the head of the file (ID3v2 tag and
+     the first frames) and the 128-byte ID3v1 tail. A tag
+     bigger than the head window (embedded cover art) costs
+     one more small read at the first frame.
+   - Everything is parsed from memory: ID3v2.2/2.3/2.4
+     (incl. unsynchronisation and extended headers), ID3v1,
+     Xing/Info, VBRI and the LAME extension.
+   - The first frame header is validated against the next
+     one before it is trusted, so stray 0xFF bytes in the
+     audio don't produce a bogus sample rate.
+------------------------------------------------------- */
+#define MP3PROBE_HEAD_BYTES (16 * 1024)   // a text-only tag plus several frames
+
+struct Mp3ProbeInfo
+{
+    int64_t  fileBytes       = 0;
+    int64_t  audioStart      = 0;   // offset of the first MPEG frame
+    int64_t  audioEnd        = 0;   // end of audio (before an ID3v1 tag)
+
+    int      mpegVersion     = 0;   // 10 = MPEG-1, 20 = MPEG-2, 25 = MPEG-2.5
+    int      layer           = 0;   // 1..3
+    int      sampleRate      = 0;   // Hz
+    int      channels        = 0;
+    int      samplesPerFrame = 0;
+
+    bool     hasXing         = false;   // Xing or Info
+    bool     hasVbri         = false;
+    bool     hasLame         = false;
+    uint32_t vbrFrames       = 0;       // audio frames, excluding the tag frame
+    uint32_t vbrBytes        = 0;
+    int      encoderDelay    = 0;       // samples, from the LAME tag
+    int      encoderPadding  = 0;
+
+    // True when the frame count came from a Xing/VBRI header, so the
+    // duration is exact and needs no scan
+    bool     exactLength     = false;
+};
+
+// Returns false if the file can't be opened or holds no MPEG frame.
+// entry is filled as far as parsing got either way.
+bool mp3Probe(const char* path, Mp3MetadataEntry& entry, Mp3ProbeInfo* info = nullptr);
+
+/* -------------------------------------------------------
+   Frame walk
+   Exact duration without decoding: reads the audio in
+   large blocks and hops from frame header to frame header.
+   Handles free-format streams, sample-rate changes mid
+   stream (each frame is timed at its own rate) and junk
+   between frames (resync on the next valid header pair).
+
+   Along the way it records a compact frame-offset table:
+   one byte offset every `indexStep` frames, with the step
+   doubled (and the table halved) whenever it would grow
+   past MP3_INDEX_MAX_ENTRIES — the same shape mpg123 uses
+   for its own index. The Xing/Info frame is not counted.
+------------------------------------------------------- */
+#define MP3WALK_BLOCK_BYTES   (256 * 1024)
+#define MP3_INDEX_MAX_ENTRIES 1024
+#define MP3_INDEX_BLOB_TAG    0x5849504Du   // 'MPIX' — metacache blob tag
+
+struct Mp3FrameWalk
+{
+    uint64_t frames       = 0;   // audio frames
+    uint64_t samples      = 0;   // after the LAME encoder delay/padding trim
+    double   seconds      = 0.0;
+    uint64_t audioBytes   = 0;   // bytes covered by counted frames
+    int      sampleRate   = 0;   // of the first frame
+    uint32_t rateChanges  = 0;
+    uint32_t resyncs      = 0;
+    uint32_t headers      = 0;   // headers parsed, resync candidates included
+    uint64_t walkTicks    = 0;
+
+    uint32_t              indexStep = 1;   // frames per table entry
+    std::vector<uint32_t> index;           // byte offset of frame i * indexStep
+};
+
+// probe must come from mp3Probe() on the same file
+bool mp3WalkFrames(const char* path, const Mp3ProbeInfo& probe, Mp3FrameWalk* out);
+
+// Offset table <-> metadata cache blob
+void mp3IndexSave(const char* path, const Mp3FrameWalk& walk);
+bool mp3IndexLoad(const char* path, Mp3FrameWalk* out);
@@ -1,6 +1,9 @@
 #include "ogg.h"
 #include "playlist.h"
 #include "player.h"
+#include "metacache.h"
+#include "scanpool.h"
+#include "readahead.h"
 #include <vorbis/vorbisfile.h>
 #include <vorbis/codec.h>
 #include <switch.h>
@@ -15,130 +18,11 @@
 #include <unordered_map>
 #include <unordered_set>
 
-/* -------------------------------------------------------
-   Cache
-------------------------------------------------------- */
-#define OGG_CACHE_VERSION  1
-#define OGG_CACHE_PATH     "sdmc:/config/winamp/ogg_cache.bin"
-#define OGG_CACHE_TMP_PATH "sdmc:/config/winamp/ogg_cache.bin.tmp"
-
-struct OggCacheHeader { uint32_t magic; uint32_t version; };
-struct OggCacheEntry  { char path[512]; time_t mtime; Mp3MetadataEntry meta; };
-
-static std::unordered_map<std::string, OggCacheEntry> g_oggCache;
-static bool g_oggCacheLoaded = false;
-
 /* -------------------------------------------------------
    Scanner state
 ------------------------------------------------------- */
-static Thread  g_oggThread;
-static bool    g_oggThreadRunning = false;
-static Mutex   g_oggMetaMutex;
-static Mutex   g_oggScanMutex;
-static bool    g_oggMutexInited   = false;
 static char    g_oggLoadedFolder[512] = {0};
-
-struct OggScanJob { std::string path; int localIndex; int generation; };
-
-static std::vector<OggScanJob>         g_oggScanQueue;
-static std::unordered_set<std::string> g_oggScanQueued;
-static std::vector<RuntimeMetadata>    g_oggPlaylistMeta;
-static int                             g_oggScanGeneration = 0;
-
-/* -------------------------------------------------------
-   Helpers
-------------------------------------------------------- */
-static void oggEnsureMutexInited()
-{
-    if (!g_oggMutexInited)
-    {
-        mutexInit(&g_oggMetaMutex);
-        mutexInit(&g_oggScanMutex);
-        g_oggMutexInited = true;
-    }
-}
-
-static bool oggCacheValid(const OggCacheEntry& e)
-{
-    struct stat st;
-    if (stat(e.path, &st) != 0) return false;
-    return st.st_mtime == e.mtime;
-}
-
-static bool oggPlaylistHasPath(const char* path)
-{
-    for (auto& m : g_oggPlaylistMeta)
-        if (strcmp(m.path, path) == 0) return true;
-    return false;
-}
-
-static void ensureCacheDir()
-{
-    mkdir("sdmc:/config",        0777);
-    mkdir("sdmc:/config/winamp", 0777);
-}
-
-/* -------------------------------------------------------
-   Cache I/O
-------------------------------------------------------- */
-void oggLoadCache(const char* /*folderKey*/)
-{
-    if (g_oggCacheLoaded) return;
-    ensureCacheDir();
-
-    FILE* f = fopen(OGG_CACHE_PATH, "rb");
-    if (!f) { g_oggCacheLoaded = true; return; }
-
-    OggCacheHeader h{};
-    if (fread(&h, sizeof(h), 1, f) != 1 ||
-        h.magic   != 0x4F474743 ||   // 'OGGC'
-        h.version != OGG_CACHE_VERSION)
-    { fclose(f); g_oggCacheLoaded = true; return; }
-
-    OggCacheEntry e;
-    while (fread(&e, sizeof(e), 1, f) == 1)
-        if (oggCacheValid(e))
-            g_oggCache[e.path] = e;
-
-    fclose(f);
-    g_oggCacheLoaded = true;
-}
-
-static void oggAppendCache(const char* path, const Mp3MetadataEntry& meta)
-{
-    if (!path || strncmp(path, "romfs:/", 7) == 0) return;
-    if (strstr(path, ".tmp")) return;
-
-    struct stat st;
-    if (stat(path, &st) != 0) return;
-
-    // Update in-memory cache entry
-    OggCacheEntry& e = g_oggCache[path];
-    strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path)-1] = '\0';
-    e.meta  = meta;
-    e.mtime = st.st_mtime;
-
-    // Write the full cache atomically.
-    // NOTE: No per-second throttle here — the throttle in flac/wav caused
-    // all files scanned within the same second to silently lose their cache
-    // entry. OGG folders typically have multiple files scanned back-to-back
-    // so every file must be persisted individually.
-    FILE* f = fopen(OGG_CACHE_TMP_PATH, "wb");
-    if (!f) return;
-
-    OggCacheHeader h{ 0x4F474743, OGG_CACHE_VERSION };
-    if (fwrite(&h, sizeof(h), 1, f) != 1) goto fail;
-    for (auto& [_, entry] : g_oggCache)
-        if (fwrite(&entry, sizeof(entry), 1, f) != 1) goto fail;
-
-    fflush(f); fsync(fileno(f)); fclose(f);
-    remove(OGG_CACHE_PATH);
-    rename(OGG_CACHE_TMP_PATH, OGG_CACHE_PATH);
-    return;
-fail:
-    fclose(f); remove(OGG_CACHE_TMP_PATH);
-}
+static int     g_oggTrackCount = 0;
 
 /* -------------------------------------------------------
    Tag reading
@@ -265,50 +149,27 @@ static void readOggMetadata(const char* path, Mp3MetadataEntry& entry)
 }
 
 /* -------------------------------------------------------
-   Background scanner
+   Scan job (runs on the scanner pool)
 ------------------------------------------------------- */
-static void oggScanThread(void*)
+void oggScanJob(const ScanJob& job)
 {
-    while (g_oggThreadRunning)
-    {
-        OggScanJob job;
-
-        mutexLock(&g_oggScanMutex);
-        if (g_oggScanQueue.empty())
-        {
-            mutexUnlock(&g_oggScanMutex);
-            svcSleepThread(50'000'000);
-            continue;
-        }
-        job = g_oggScanQueue.front();
-        g_oggScanQueue.erase(g_oggScanQueue.begin());
-        mutexUnlock(&g_oggScanMutex);
-
-        mutexLock(&g_oggScanMutex);
-        bool canceled = (job.generation != g_oggScanGeneration);
-        mutexUnlock(&g_oggScanMutex);
-        if (canceled) continue;
-
-        // Skip the currently playing track
-        if (playerIsPlaying())
-        {
-            const char* playing = playlistGetTrack(playlistGetCurrentIndex());
-            if (playing && job.path == playing) continue;
-        }
+    // Skip the currently playing track
+    if (playerIsPlaying() &&
+        playlistGetTrackId(playlistGetCurrentIndex()) == job.id)
+        return;
 
-        Mp3MetadataEntry entry{};
-        readOggMetadata(job.path.c_str(), entry);
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
 
-        printf("[OGG] Scanned: %s | dur=%ds kbps=%d\n",
-               job.path.c_str(), entry.durationSeconds, entry.bitrateKbps);
+    Mp3MetadataEntry entry{};
+    readOggMetadata(path, entry);
 
-        mutexLock(&g_oggMetaMutex);
-        if (job.localIndex < (int)g_oggPlaylistMeta.size())
-            g_oggPlaylistMeta[job.localIndex].meta = entry;
-        mutexUnlock(&g_oggMetaMutex);
+    printf("[OGG] Scanned: %s | dur=%ds kbps=%d\n",
+           path, entry.durationSeconds, entry.bitrateKbps);
 
-        oggAppendCache(job.path.c_str(), entry);
-    }
+    if (scanJobCanceled(job)) return;
+    trackSetMetadata(job.id, entry);
+    metaCachePut(path, entry);
 }
 
 /* -------------------------------------------------------
@@ -326,97 +187,68 @@ void oggSetLoadedFolder(const char* path)
     g_oggLoadedFolder[sizeof(g_oggLoadedFolder)-1] = '\0';
 }
 
-void oggCancelAllScans()
-{
-    oggEnsureMutexInited();
-    mutexLock(&g_oggScanMutex);
-    g_oggScanQueue.clear();
-    g_oggScanQueued.clear();
-    g_oggScanGeneration++;
-    mutexUnlock(&g_oggScanMutex);
-}
-
-void oggStartBackgroundScanner()
-{
-    oggEnsureMutexInited();
-    g_oggThreadRunning = true;
-    threadCreate(&g_oggThread, oggScanThread, nullptr, nullptr, 0x4000, 0x2B, -2);
-    threadStart(&g_oggThread);
-}
-
-void oggStopBackgroundScanner()
-{
-    if (!g_oggThreadRunning) return;
-    g_oggThreadRunning = false;
-    threadWaitForExit(&g_oggThread);
-    threadClose(&g_oggThread);
-}
-
 void oggClearMetadata()
 {
-    oggEnsureMutexInited();
-    mutexLock(&g_oggMetaMutex);
-    g_oggPlaylistMeta.clear();
-    mutexUnlock(&g_oggMetaMutex);
+    g_oggTrackCount = 0;   // metadata itself stays in the track table
 }
 
 bool oggAddToPlaylist(const char* path)
 {
     if (!path) return false;
-    oggEnsureMutexInited();
-    if (oggPlaylistHasPath(path)) return false;
 
-    playlistAdd(path);
-    int localIndex = (int)g_oggPlaylistMeta.size();
+    TrackId id = playlistAdd(path);
+    if (id == TRACK_ID_NONE) return false;   // already in the playlist
+    g_oggTrackCount++;
 
     Mp3MetadataEntry meta{};
     strncpy(meta.title, "Scanning...", sizeof(meta.title) - 1);
+    trackSetMetadata(id, meta);
 
-    RuntimeMetadata r{};
-    strncpy(r.path, path, sizeof(r.path) - 1);
-    r.path[sizeof(r.path)-1] = '\0';
-    r.meta = meta;
-    g_oggPlaylistMeta.push_back(r);
-
-    auto it = g_oggCache.find(path);
-    if (it != g_oggCache.end() && oggCacheValid(it->second))
+    Mp3MetadataEntry cached;
+    if (metaCacheLookup(path, &cached))
     {
-        mutexLock(&g_oggMetaMutex);
-        g_oggPlaylistMeta[localIndex].meta = it->second.meta;
-        mutexUnlock(&g_oggMetaMutex);
+        trackSetMetadata(id, cached);
         printf("[OGG] Cache hit: %s\n", path);
         return true;
     }
 
-    mutexLock(&g_oggScanMutex);
-    if (g_oggScanQueued.insert(path).second)
-        g_oggScanQueue.push_back({ path, localIndex, g_oggScanGeneration });
-    mutexUnlock(&g_oggScanMutex);
+    scanPoolSubmit(id, SCAN_JOB_OGG, scanPoolToken());
 
     return true;
 }
 
-const Mp3MetadataEntry* oggGetTrackMetadata(int globalIndex)
-{
-    if (globalIndex < 0 || globalIndex >= playlistGetCount()) return nullptr;
-    const char* path = playlistGetTrack(globalIndex);
-    if (!path) return nullptr;
-    for (auto& r : g_oggPlaylistMeta)
-        if (strcmp(r.path, path) == 0) return &r.meta;
-    return nullptr;
-}
-
-int oggGetPlaylistCount() { return (int)g_oggPlaylistMeta.size(); }
+int oggGetPlaylistCount() { return g_oggTrackCount; }
 
 /* =======================================================
    DECODER
 ======================================================= */
+// libvorbisfile reads through the shared read-ahead service
+static size_t oggIoRead(void* ptr, size_t size, size_t nmemb, void* src)
+{
+    if (size == 0) return 0;
+    return readAheadRead((ReadAheadStream*)src, ptr, size * nmemb) / size;
+}
+
+static int oggIoSeek(void* src, ogg_int64_t offset, int whence)
+{
+    return readAheadSeek((ReadAheadStream*)src, (int64_t)offset, whence) ? 0 : -1;
+}
+
+static int  oggIoClose(void* src) { readAheadClose((ReadAheadStream*)src); return 0; }
+static long oggIoTell(void* src)  { return (long)readAheadTell((ReadAheadStream*)src); }
+
 OggDecoder* oggOpen(const char* path)
 {
+    ReadAheadStream* io = readAheadOpen(path);
+    if (!io) return nullptr;
+
     OggDecoder* od = new OggDecoder();
 
-    if (ov_fopen(path, &od->vf) != 0)
+    ov_callbacks cb = { oggIoRead, oggIoSeek, oggIoClose, oggIoTell };
+    if (ov_open_callbacks(io, &od->vf, nullptr, 0, cb) != 0)
     {
+        // On failure vorbisfile leaves the datasource to us
+        readAheadClose(io);
         delete od;
         return nullptr;
     }
@@ -456,20 +288,17 @@ OggReadResult oggRead(OggDecoder* od,
     *bytesRead = 0;
     if (!od || !od->open || od->eof) return OGG_READ_DONE;
 
-    // ov_read expects a signed 16-bit little-endian output
-    // bitstream = -1 means "current logical bitstream"
-    int  bitstream = 0;
-    long totalRead = 0;
+    // Output is interleaved stereo float32 — libvorbis synthesises float
+    // internally, so ov_read_float skips its int16 packing entirely.
+    float* out       = (float*)buffer;
+    int    maxFrames = (int)(bufBytes / (sizeof(float) * 2));
+    int    total     = 0;
 
-    while (totalRead < (long)bufBytes)
+    while (total < maxFrames)
     {
-        long n = ov_read(&od->vf,
-                         (char*)buffer + totalRead,
-                         (int)(bufBytes - totalRead),
-                         0,    // little-endian
-                         2,    // 16-bit
-                         1,    // signed
-                         &bitstream);
+        float** pcm       = nullptr;
+        int     bitstream = 0;
+        long n = ov_read_float(&od->vf, &pcm, maxFrames - total, &bitstream);
 
         if (n == 0)
         {
@@ -485,21 +314,30 @@ OggReadResult oggRead(OggDecoder* od,
         else if (n < 0)
         {
             // Unrecoverable error
-            if (totalRead == 0) return OGG_READ_ERR;
+            if (total == 0) return OGG_READ_ERR;
             break;
         }
 
-        totalRead += n;
+        // Channel count can change between chained logical bitstreams
+        vorbis_info* vi = ov_info(&od->vf, bitstream);
+        int ch = vi ? vi->channels : (int)od->channels;
+
+        const float* l = pcm[0];
+        const float* r = (ch > 1) ? pcm[1] : pcm[0];
+        float*       o = out + total * 2;
+        for (long i = 0; i < n; i++)
+        {
+            o[i * 2]     = l[i];
+            o[i * 2 + 1] = r[i];
+        }
 
-        // Update sample counter (n is bytes; int16 stereo = 4 bytes/frame)
-        int bytesPerFrame = (int)(sizeof(int16_t) * od->channels);
-        if (bytesPerFrame > 0)
-            od->samplesRead += n / bytesPerFrame;
+        total           += (int)n;
+        od->samplesRead += n;
     }
 
-    *bytesRead = (size_t)totalRead;
+    *bytesRead = (size_t)total * sizeof(float) * 2;
 
-    if (totalRead == 0 && od->eof) return OGG_READ_DONE;
+    if (total == 0 && od->eof) return OGG_READ_DONE;
     return OGG_READ_OK;
 }
 
@@ -7,7 +7,7 @@
 
 /* -------------------------------------------------------
    OGG/Vorbis decoder handle
-   Wraps libvorbisfile and outputs int16_t stereo PCM,
+   Wraps libvorbisfile and outputs float32 stereo PCM,
    matching the interface used by the FLAC and MP3 decoders.
 ------------------------------------------------------- */
 struct OggDecoder
@@ -47,14 +47,10 @@ bool oggSeek(OggDecoder* od, uint64_t targetSample);
 ------------------------------------------------------- */
 bool oggIsFolderLoaded(const char* path);
 void oggSetLoadedFolder(const char* path);
-void oggCancelAllScans();
 
-void oggStartBackgroundScanner();
-void oggStopBackgroundScanner();
+// Scanning runs on the shared scanner pool (scanpool.h)
 
 bool oggAddToPlaylist(const char* path);
 void oggClearMetadata();
-void oggLoadCache(const char* folderKey);
 
-const Mp3MetadataEntry* oggGetTrackMetadata(int globalIndex);
-int                     oggGetPlaylistCount();
+int oggGetPlaylistCount();   // per-track metadata: playlistGetMetadata()
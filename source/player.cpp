@@ -2,11 +2,15 @@
 #include "player_state.h"
 #include "playlist.h"
 #include "mp3.h"
+#include "mp3probe.h"
+#include "scanpool.h"
 #include "flac.h"
 #include "ogg.h"
 #include "wav.h"
 #include "eq.h"
 #include "audio_engine.h"
+#include "resampler.h"
+#include "readahead.h"
 #include "ui.h"
 #include <SDL.h>
 #include <switch.h>
@@ -16,16 +20,39 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#ifndef __SWITCH__
+#include <thread>
+#endif
 
 #include "settings.h"
 #include "settings_state.h"
 /* ---------------------------------------------------- */
 /* CONFIG                                               */
 /* ---------------------------------------------------- */
-#define FFT_SIZE       1024
-#define DECODE_BUFFER  8192   // bytes (mpg123 output)
+#define DECODE_BUFFER  16384  // bytes: 2048 float stereo frames
 #define SHUFFLE_MEMORY 5
 #define FLOAT_BUF_FRAMES 4096 // frames per decode chunk
+
+// Decode thread: keep ~200 ms queued in the ring, poll every few ms while
+// playing and much more lazily while idle (commands wake it immediately).
+#define DECODE_TARGET_MS      200
+#define DECODE_POLL_MS        5
+#define DECODE_IDLE_POLL_MS   50
+#define DECODE_THREAD_STACK   0x40000
+#define DECODE_THREAD_PRIO    0x2B    // just above the main thread (0x2C)
+// Main loop is on core 0. Scan workers run one per core on 0-2, so one
+// shares this core, at a lower priority (0x2D) than the decoder.
+#define DECODE_THREAD_CPU     1
+
+// Seek: decoded right away so the callback never sees a gap, and faded in
+// so the splice doesn't click
+#define SEEK_PREROLL_MS 40
+#define SEEK_FADE_MS    6
+#define SCRUB_PREVIEW_INTERVAL_MS 150   // at most one preview seek per this long
 /* ---------------------------------------------------- */
 /* AUDIO FORMAT                                         */
 /* ---------------------------------------------------- */
@@ -74,6 +101,35 @@ static uint64_t samplesPlayedNext = 0; // frames decoded from incoming track dur
 /* Gapless preload guard */
 static bool g_preloadAttempted = false;
 
+/* Fade-in after a seek, in output frames (decode thread only) */
+static int g_fadeInTotal = 0;
+static int g_fadeInLeft  = 0;
+
+/* Last seek, reported once the new position is audible */
+static double g_seekDecoderMs = 0.0;
+static double g_seekPrerollMs = 0.0;
+
+/* Scrub — target written by the UI, previews run on the decode thread */
+static std::atomic<bool>     g_scrubbing{false};
+static std::atomic<float>    g_scrubTarget{0.0f};
+static std::atomic<uint32_t> g_scrubMoves{0};      // UI updates this scrub
+static std::atomic<uint32_t> g_scrubPreviews{0};   // decoder seeks this scrub
+static float                 g_previewTarget = -1.0f;
+static u64                   g_previewTicks  = 0;
+
+// A scrub belongs to the track it started on. Stopping or changing track
+// drops it without a seek, so a late release can't move the new track.
+// Safe from any thread; the decode-thread callers also reset the preview
+static void scrubCancel(const char* why)
+{
+    if (g_scrubbing.exchange(false, std::memory_order_acq_rel))
+        printf("[SEEK] Scrub cancelled (%s)\n", why);
+}
+
+/* MP3 tracks opened before their seek index existed — retried on seek */
+static TrackId g_seekIndexPending     = TRACK_ID_NONE;
+static TrackId g_seekIndexPendingNext = TRACK_ID_NONE;
+
 enum PlaybackState
 {
     STATE_STOPPED,
@@ -89,9 +145,12 @@ static void rebuildShufflePool();
 static std::vector<int> g_shufflePool;
 static std::vector<int> g_shuffleHistory;
 
-/* FFT */
-float g_fftInput[FFT_SIZE] = {0};
-static int fftWritePos = 0;
+/* Sample-rate conversion: decoder rate → fixed device rate */
+static Resampler          g_resampler;      // current track
+static Resampler          g_resamplerNext;  // incoming track during crossfade
+static std::vector<float> g_outBuf;         // resampled block (decode thread only)
+static std::vector<float> g_xfadeCur;       // crossfade FIFOs at the output rate,
+static std::vector<float> g_xfadeNext;      // so both sides can run at any rate
 
 /* Mixing */
 static float g_volume   = 1.0f;
@@ -103,6 +162,35 @@ static float g_rightMix = 1.0f;
 /* FORMAT-AWARE DECODER HELPERS                         */
 /* ---------------------------------------------------- */
 
+// mpg123 reads through the shared read-ahead service instead of its own fd
+static ssize_t mp3IoRead(void* h, void* buf, size_t n)
+{
+    return (ssize_t)readAheadRead((ReadAheadStream*)h, buf, n);
+}
+
+static off_t mp3IoSeek(void* h, off_t offset, int whence)
+{
+    ReadAheadStream* s = (ReadAheadStream*)h;
+    if (!readAheadSeek(s, (int64_t)offset, whence)) return -1;
+    return (off_t)readAheadTell(s);
+}
+
+static void mp3IoCleanup(void* h) { readAheadClose((ReadAheadStream*)h); }
+
+static bool mp3OpenReadAhead(mpg123_handle* h, const char* path)
+{
+    ReadAheadStream* io = readAheadOpen(path);
+    if (!io) return false;
+    if (mpg123_replace_reader_handle(h, mp3IoRead, mp3IoSeek, mp3IoCleanup) != MPG123_OK)
+    {
+        readAheadClose(io);
+        return false;
+    }
+    // From here mpg123 owns `io` — mpg123_close() runs mp3IoCleanup
+    return mpg123_open_handle(h, io) == MPG123_OK;
+}
+
+
 static int decoderRead(unsigned char* buf, size_t bufBytes, size_t* done)
 {
     *done = 0;
@@ -161,9 +249,49 @@ static int decoderReadNext(unsigned char* buf, size_t bufBytes, size_t* done)
     }
 }
 
+/* ---------------------------------------------------- */
+/* MP3 SEEK INDEX                                       */
+/* ---------------------------------------------------- */
+// Hand the cached frame-offset table (mp3probe.h) to mpg123. With it,
+// mpg123_seek() jumps straight to the indexed frame at or before the
+// target and decodes forward at most `step` frames — no scan from the
+// start of the file, and exact on VBR files.
+static bool mp3ApplySeekIndex(mpg123_handle* h, const char* path, double* seconds)
+{
+    Mp3FrameWalk walk;
+    if (!h || !mp3IndexLoad(path, &walk) || walk.index.empty())
+        return false;
+
+    std::vector<off_t> offsets(walk.index.begin(), walk.index.end());
+    if (mpg123_set_index(h, offsets.data(), (off_t)walk.indexStep, offsets.size()) != MPG123_OK)
+    {
+        printf("[MP3] mpg123_set_index failed: %s\n", mpg123_strerror(h));
+        return false;
+    }
+
+    if (seconds) *seconds = walk.seconds;
+    printf("[MP3] Seek index: %zu entries, every %u frames\n",
+           offsets.size(), walk.indexStep);
+    return true;
+}
+
+// Returns the track still waiting for an index (its walk is queued),
+// or TRACK_ID_NONE if the index was applied
+static TrackId mp3AttachSeekIndex(mpg123_handle* h, int playlistIndex, double* seconds)
+{
+    TrackId id = playlistGetTrackId(playlistIndex);
+    if (mp3ApplySeekIndex(h, trackGetPath(id), seconds))
+        return TRACK_ID_NONE;
+
+    if (id != TRACK_ID_NONE)
+        scanPoolSubmit(id, SCAN_JOB_MP3_INDEX, scanPoolToken());
+    return id;
+}
+
 static void closeCurrentDecoder()
 {
     if (mh)      { mpg123_close(mh); mpg123_delete(mh); mh = nullptr; }
+    g_seekIndexPending = TRACK_ID_NONE;
     if (mh_flac) { flacClose(mh_flac); mh_flac = nullptr; }
     if (mh_ogg)  { oggClose(mh_ogg);   mh_ogg  = nullptr; }
     if (mh_wav)  { wavClose(mh_wav);   mh_wav  = nullptr; }
@@ -172,6 +300,7 @@ static void closeCurrentDecoder()
 static void closeNextDecoderAll()
 {
     if (mh_next)      { mpg123_close(mh_next); mpg123_delete(mh_next); mh_next = nullptr; }
+    g_seekIndexPendingNext = TRACK_ID_NONE;
     if (mh_flac_next) { flacClose(mh_flac_next); mh_flac_next = nullptr; }
     if (mh_ogg_next)  { oggClose(mh_ogg_next);   mh_ogg_next  = nullptr; }
     if (mh_wav_next)  { wavClose(mh_wav_next);   mh_wav_next  = nullptr; }
@@ -181,6 +310,8 @@ static void promoteNextToCurrent()
 {
     closeCurrentDecoder();
     mh          = mh_next;       mh_next      = nullptr;
+    g_seekIndexPending = g_seekIndexPendingNext;
+    g_seekIndexPendingNext = TRACK_ID_NONE;
     mh_flac     = mh_flac_next;  mh_flac_next = nullptr;
     mh_ogg      = mh_ogg_next;   mh_ogg_next  = nullptr;
     mh_wav      = mh_wav_next;   mh_wav_next  = nullptr;
@@ -209,6 +340,28 @@ static bool decoderGetFormat(long* rate, int* ch)
     }
 }
 
+static bool decoderGetFormatNext(long* rate, int* ch)
+{
+    switch (g_formatNext)
+    {
+        case FORMAT_FLAC:
+            if (!mh_flac_next) return false;
+            *rate = (long)mh_flac_next->sampleRate; *ch = (int)mh_flac_next->channels;
+            return (*rate > 0);
+        case FORMAT_OGG:
+            if (!mh_ogg_next) return false;
+            *rate = (long)mh_ogg_next->sampleRate; *ch = (int)mh_ogg_next->channels;
+            return (*rate > 0);
+        case FORMAT_WAV:
+            if (!mh_wav_next) return false;
+            *rate = (long)mh_wav_next->sampleRate; *ch = (int)mh_wav_next->channels;
+            return (*rate > 0);
+        default:
+            if (!mh_next) return false;
+            { int enc; return mpg123_getformat(mh_next, rate, ch, &enc) == MPG123_OK; }
+    }
+}
+
 static int64_t decoderTotalSamples()
 {
     switch (g_format)
@@ -262,8 +415,28 @@ static void closeNextDecoder()
     closeNextDecoderAll();
 }
 
-// Open and configure the decoder for track at `index` into the next-track slot.
+static bool openNextDecoderInternal(int index);
+
+// Open and configure the decoder for track at `index` into the next-track
+// slot, and tune the crossfade resampler to its rate.
 static bool openNextDecoder(int index)
+{
+    if (!openNextDecoderInternal(index))
+        return false;
+
+    long rate; int ch;
+    if (decoderGetFormatNext(&rate, &ch))
+    {
+        g_resamplerNext.setQuality(g_settings.resampleQuality);
+        g_resamplerNext.setRates((int)rate, audio.getSampleRate());
+        g_resamplerNext.reset();
+    }
+    g_xfadeCur.clear();
+    g_xfadeNext.clear();
+    return true;
+}
+
+static bool openNextDecoderInternal(int index)
 {
     closeNextDecoderAll();
 
@@ -292,13 +465,14 @@ static bool openNextDecoder(int index)
             mpg123_param(mh_next, MPG123_GAPLESS,      1,                 0);
             mpg123_param(mh_next, MPG123_ADD_FLAGS,    MPG123_SKIP_ID3V2, 0);
             mpg123_param(mh_next, MPG123_FORCE_STEREO, 1,                 0);
-            if (mpg123_open(mh_next, path) != MPG123_OK)
+            if (!mp3OpenReadAhead(mh_next, path))
             { closeNextDecoderAll(); return false; }
             { long rate; int ch, enc;
               if (mpg123_getformat(mh_next, &rate, &ch, &enc) != MPG123_OK)
               { closeNextDecoderAll(); return false; }
               mpg123_format_none(mh_next);
-              mpg123_format(mh_next, rate, ch, MPG123_ENC_SIGNED_16); }
+              mpg123_format(mh_next, rate, MPG123_STEREO, MPG123_ENC_FLOAT_32); }
+            g_seekIndexPendingNext = mp3AttachSeekIndex(mh_next, index, nullptr);
             return true;
     }
 }
@@ -326,6 +500,8 @@ static void playerCommitNextTrack(int nextIndex)
             g_shufflePool.erase(it);
     }
 
+    scrubCancel("track changed");
+    g_previewTarget = -1.0f;
     g_state.trackIndex = nextIndex;
     playlistSetCurrentIndex(nextIndex);
 }
@@ -387,25 +563,81 @@ static int playerPeekNextIndex()
 /* ---------------------------------------------------- */
 /* DSP                                                  */
 /* ---------------------------------------------------- */
-static void processSamplesToFloat(
-    const int16_t* in,
-    float*         out,
-    int            frames,
-    int            channels
+// Every decoder hands us interleaved stereo float32 in [-1, 1], so this is
+// just the volume/pan gain — no widening pass.
+static void applyMix(
+    const float* in,
+    float*       out,
+    int          frames
 ) {
+    const float lMix = g_leftMix;
+    const float rMix = g_rightMix;
     for (int i = 0; i < frames; i++)
     {
-        float left  = in[i * channels]     / 32768.0f;
-        float right = (channels > 1) ? in[i * channels + 1] / 32768.0f : left;
-        left  *= g_leftMix;
-        right *= g_rightMix;
-        out[i * 2]     = left;
-        out[i * 2 + 1] = right;
-        g_fftInput[fftWritePos] = left;
-        fftWritePos = (fftWritePos + 1) % FFT_SIZE;
+        out[i * 2]     = in[i * 2]     * lMix;
+        out[i * 2 + 1] = in[i * 2 + 1] * rMix;
     }
 }
 
+// UI thread: read from the device side of the engine — after the EQ
+// and limiter, and in step with playback however far ahead the decoder
+// runs. Goes through a scratch buffer so a window the callback lapped
+// mid-copy never reaches the caller.
+bool playerReadAnalysisWindow(float* out, int frames)
+{
+    static std::vector<float> scratch;
+    if (frames <= 0) return false;
+    if ((int)scratch.size() < frames) scratch.resize(frames);
+
+    if (audio.readAnalysisWindow(scratch.data(), (size_t)frames, svcGetSystemTick()) != (size_t)frames)
+        return false;
+    memcpy(out, scratch.data(), frames * sizeof(float));
+    return true;
+}
+
+int playerGetOutputSampleRate()
+{
+    return audio.getSampleRate();
+}
+
+// DSP stage between the decoder and the ring: the whole block goes through
+// the EQ/limiter chain here, on the decode thread, so the audio callback
+// only has to copy. `pcm` is interleaved stereo and is modified in place.
+static void pushBlockToEngine(float* pcm, int frames)
+{
+    g_equalizer.processBlock(pcm, frames);
+
+    // Linear ramp over the first SEEK_FADE_MS after a seek, after the EQ
+    // so the filters' transient from the jump is covered too
+    if (g_fadeInLeft > 0)
+    {
+        int n = std::min(frames, g_fadeInLeft);
+        int done = g_fadeInTotal - g_fadeInLeft;
+        for (int i = 0; i < n; i++)
+        {
+            float g = (float)(done + i + 1) / (float)g_fadeInTotal;
+            pcm[i * 2]     *= g;
+            pcm[i * 2 + 1] *= g;
+        }
+        g_fadeInLeft -= n;
+    }
+
+    audio.pushPCM(pcm, (size_t)frames * 2);
+}
+
+// Decoder PCM → volume/pan → device rate, appended to `dst`.
+static void decodeToOutput(Resampler& rs, const float* in, int frames,
+                           std::vector<float>& dst)
+{
+    float floatPCM[FLOAT_BUF_FRAMES * 2];
+    applyMix(in, floatPCM, frames);
+
+    size_t base = dst.size();
+    dst.resize(base + (size_t)rs.maxOutputFrames(frames) * 2);
+    int produced = rs.process(floatPCM, frames, dst.data() + base);
+    dst.resize(base + (size_t)produced * 2);
+}
+
 /* ---------------------------------------------------- */
 /* VOLUME / PAN                                         */
 /* ---------------------------------------------------- */
@@ -466,18 +698,31 @@ void applyReplayGainFromMetadata(const Mp3MetadataEntry& meta)
 /* ---------------------------------------------------- */
 /* LIFECYCLE                                            */
 /* ---------------------------------------------------- */
+static void decodeThreadStart();
+static void decodeThreadStop();
+
 void playerInit()
 {
     mpg123_init();
+    // One device for the whole session at a fixed rate; decoders are
+    // resampled to it, so track changes never reopen it.
+    if (!audio.init(AUDIO_OUTPUT_RATE, 2))
+        printf("Error: failed to open audio device\n");
+    audio.setPaused(false);
+    readAheadInit();
     playerSetVolume(1.0f);
     g_state.repeat  = REPEAT_OFF;
     g_state.shuffle = false;
     g_state.paused  = false;
+    decodeThreadStart();
 }
 
 void playerShutdown()
 {
     playerStop();
+    decodeThreadStop();
+    readAheadShutdown();
+    audio.shutdown();
     mpg123_exit();
 }
 
@@ -486,7 +731,8 @@ void playerShutdown()
 /* ---------------------------------------------------- */
 static void stopPlaybackInternal()
 {
-    audio.stop();
+    // The device stays open; just drop whatever is still queued.
+    audio.clear();
 
     g_playbackState      = STATE_STOPPED;
     g_crossfadeTargetIndex = -1;
@@ -494,19 +740,24 @@ static void stopPlaybackInternal()
     g_crossfadeProgress  = 0.0f;
     samplesPlayedNext    = 0;
     g_preloadAttempted   = false;
+    g_fadeInLeft         = 0;
 
     closeNextDecoderAll();
     closeCurrentDecoder();
 
-    audio.shutdown();
+    g_resampler.reset();
+    g_xfadeCur.clear();
+    g_xfadeNext.clear();
     samplesPlayed = 0;
 }
 
 /* ---------------------------------------------------- */
 /* PLAYBACK CONTROL                                     */
 /* ---------------------------------------------------- */
-void playerPlay(int index)
+static void playInternal(int index)
 {
+    scrubCancel("track changed");
+    g_previewTarget = -1.0f;
     stopPlaybackInternal();
 
     const char* path = playlistGetTrack(index);
@@ -520,6 +771,7 @@ void playerPlay(int index)
 
     long rate = 0;
     int  ch   = 0;
+    double indexedSeconds = 0.0;
 
     switch (g_format)
     {
@@ -550,7 +802,7 @@ void playerPlay(int index)
             mpg123_param(mh, MPG123_GAPLESS,      1,                 0);
             mpg123_param(mh, MPG123_ADD_FLAGS,    MPG123_SKIP_ID3V2, 0);
             mpg123_param(mh, MPG123_FORCE_STEREO, 1,                 0);
-            if (mpg123_open(mh, path) != MPG123_OK)
+            if (!mp3OpenReadAhead(mh, path))
             {
                 printf("Error: failed to open %s\n", path);
                 mpg123_delete(mh); mh = nullptr; return;
@@ -562,36 +814,34 @@ void playerPlay(int index)
                   mpg123_close(mh); mpg123_delete(mh); mh = nullptr; return;
               }
               mpg123_format_none(mh);
-              mpg123_format(mh, rate, ch, MPG123_ENC_SIGNED_16); }
+              mpg123_format(mh, rate, MPG123_STEREO, MPG123_ENC_FLOAT_32); }
+            g_seekIndexPending = mp3AttachSeekIndex(mh, index, &indexedSeconds);
             break;
     }
 
     g_state.sampleRate = rate;
     g_state.channels   = ch;
 
-    audio.init(rate, ch);
-    audio.start();
+    g_resampler.setQuality(g_settings.resampleQuality);
+    g_resampler.setRates((int)rate, audio.getSampleRate());
+    g_resampler.reset();
     audio.setPaused(false);
 
-    // Duration: for FLAC use exact sample count; for MP3 use mpg123_length
+    // Duration: for FLAC use exact sample count; for MP3 the frame walk
+    // behind the seek index if there is one, else mpg123_length
     int64_t totalSamples = decoderTotalSamples();
     g_state.durationSeconds =
         (totalSamples > 0 && rate > 0) ? (int)(totalSamples / rate) : 0;
+    if (indexedSeconds > 0.0)
+        g_state.durationSeconds = (int)indexedSeconds;
 
     samplesPlayed          = 0;
     g_state.elapsedSeconds = 0;
     g_preloadAttempted     = false;
 
-    // ReplayGain — pick the right metadata source for this format
+    // ReplayGain — every format's metadata lives in the track table
     {
-        const Mp3MetadataEntry* meta = nullptr;
-        switch (g_format)
-        {
-            case FORMAT_FLAC: meta = flacGetTrackMetadata(index); break;
-            case FORMAT_OGG:  meta = oggGetTrackMetadata(index);  break;
-            case FORMAT_WAV:  meta = wavGetTrackMetadata(index);  break;
-            default:          meta = mp3GetTrackMetadata(index);  break;
-        }
+        const Mp3MetadataEntry* meta = playlistGetMetadata(index);
         if (meta) applyReplayGainFromMetadata(*meta);
     }
 
@@ -609,8 +859,10 @@ void playerPlay(int index)
            path);
 }
 
-void playerStop()
+static void stopInternal()
 {
+    scrubCancel("stopped");
+    g_previewTarget = -1.0f;
     stopPlaybackInternal();
     spectrumReset();
     g_shuffleHistory.clear();
@@ -623,7 +875,7 @@ void playerStop()
     g_playbackState          = STATE_STOPPED;
 }
 
-void playerTogglePause()
+static void togglePauseInternal()
 {
     if (!g_state.playing)
         return;
@@ -635,25 +887,25 @@ void playerTogglePause()
 // called playerPlay() → playerCommitNextTrack() which popped them a second
 // time. Now playerNext() just calls playerPlay(); commit happens once inside
 // the gapless/crossfade switch paths or via playerCommitNextTrack() below.
-void playerNext()
+static void nextInternal()
 {
     int nextIndex = playerPeekNextIndex();
     if (nextIndex < 0)
     {
-        playerStop();
+        stopInternal();
         return;
     }
     printf("NEXT → %d\n", nextIndex);
-    playerPlay(nextIndex);
+    playInternal(nextIndex);
 }
 
-void playerPrev()
+static void prevInternal()
 {
     if (g_state.shuffle && !g_shuffleHistory.empty())
     {
         int prevIndex = g_shuffleHistory.back();
         g_shuffleHistory.pop_back();
-        playerPlay(prevIndex);
+        playInternal(prevIndex);
         return;
     }
 
@@ -665,17 +917,17 @@ void playerPrev()
     if (prevIndex < 0)
         prevIndex = (g_state.repeat == REPEAT_ALL) ? count - 1 : 0;
 
-    playerPlay(prevIndex);
+    playInternal(prevIndex);
 }
 
-void playerEnqueue(int index)
+static void enqueueInternal(int index)
 {
     if (index >= 0 && index < playlistGetCount())
         g_playQueue.push_back(index);
 }
 
 // Manual crossfade trigger (e.g. from controller button)
-void playerStartCrossfade()
+static void startCrossfadeInternal()
 {
     if (!g_settings.crossfadeEnabled)
         return;
@@ -685,13 +937,13 @@ void playerStartCrossfade()
     int nextIndex = playerPeekNextIndex();
     if (nextIndex < 0)
     {
-        playerStop();
+        stopInternal();
         return;
     }
 
     if (!openNextDecoder(nextIndex))
     {
-        playerNext();
+        nextInternal();
         return;
     }
 
@@ -702,19 +954,65 @@ void playerStartCrossfade()
     g_metadataSwitched     = false;
 }
 
-void playerSeek(float targetSeconds)
+// Leave the crossfade before seeking. Past its midpoint the UI already
+// shows the incoming track, so finish the switch and seek in that one;
+// before it, drop the fade and stay on the current track.
+static void leaveCrossfadeForSeek()
+{
+    if (g_metadataSwitched)
+    {
+        promoteNextToCurrent();
+        std::swap(g_resampler, g_resamplerNext);
+
+        long rate; int ch;
+        if (decoderGetFormat(&rate, &ch))
+        {
+            g_state.sampleRate = rate;
+            g_state.channels   = ch;
+        }
+        int64_t total = decoderTotalSamples();
+        g_state.durationSeconds =
+            (total > 0 && g_state.sampleRate > 0)
+            ? (int)(total / g_state.sampleRate) : 0;
+    }
+    else
+    {
+        closeNextDecoderAll();
+    }
+
+    g_xfadeCur.clear();
+    g_xfadeNext.clear();
+    g_crossfadeTargetIndex = -1;
+    g_crossfadeProgress    = 0.0f;
+    g_metadataSwitched     = false;
+    samplesPlayedNext      = 0;
+    g_preloadAttempted     = false;
+    g_playbackState        = STATE_PLAYING;
+}
+
+// requestTicks: when playerSeek() was called, for the latency report
+// (0 for scrub previews, which aren't reported)
+static void seekInternal(float targetSeconds, uint64_t requestTicks)
 {
     if (!decoderIsOpen() || !g_state.playing)
         return;
 
+    if (g_playbackState == STATE_CROSSFADING)
+        leaveCrossfadeForSeek();
+
     if (targetSeconds < 0.0f)
         targetSeconds = 0.0f;
     if (targetSeconds > (float)g_state.durationSeconds)
         targetSeconds = (float)g_state.durationSeconds;
 
     uint64_t targetSample = (uint64_t)(targetSeconds * g_state.sampleRate);
+    u64 t0 = svcGetSystemTick();
 
-    audio.setPaused(true);
+    // Audio from the old position goes first, in one step under the
+    // device lock — nothing of it plays after this
+    audio.clear();
+    if (!g_state.paused && requestTicks)
+        audio.armLatencyProbe(requestTicks);
 
     bool ok = false;
     switch (g_format)
@@ -723,23 +1021,55 @@ void playerSeek(float targetSeconds)
         case FORMAT_OGG:  if (mh_ogg)  ok = oggSeek(mh_ogg,   targetSample); break;
         case FORMAT_WAV:  if (mh_wav)  ok = wavSeek(mh_wav,   targetSample); break;
         default:
-            if (mh) ok = (mpg123_seek(mh, (off_t)targetSample, SEEK_SET) >= 0);
+            if (!mh) break;
+            // The index may have been built since the track started
+            if (g_seekIndexPending != TRACK_ID_NONE &&
+                mp3ApplySeekIndex(mh, trackGetPath(g_seekIndexPending), nullptr))
+                g_seekIndexPending = TRACK_ID_NONE;
+            ok = (mpg123_seek(mh, (off_t)targetSample, SEEK_SET) >= 0);
             break;
     }
+    u64 t1 = svcGetSystemTick();
 
     if (ok)
     {
         samplesPlayed          = targetSample;
         g_state.elapsedSeconds = (int)targetSeconds;
+        g_resampler.reset();
     }
 
-    audio.setPaused(g_state.paused);
+    // A seek back from the very end revives a draining track. A gapless
+    // preload is kept — it doesn't depend on where this track is.
+    if (g_playbackState == STATE_DRAINING)
+        g_playbackState = STATE_PLAYING;
 
-    // Cancel any pending crossfade/preload — recalculated on next update
-    g_crossfadeTargetIndex = -1;
-    g_metadataSwitched     = false;
-    g_preloadAttempted     = false;
-    closeNextDecoderAll();
+    g_fadeInTotal = g_fadeInLeft = audio.getSampleRate() * SEEK_FADE_MS / 1000;
+
+    // Pre-roll: queue the first few ms now instead of on the next update
+    const size_t prerollFrames = (size_t)audio.getSampleRate() * SEEK_PREROLL_MS / 1000;
+    size_t queued = 0;
+    while (queued < prerollFrames)
+    {
+        alignas(16) unsigned char buffer[DECODE_BUFFER];
+        size_t done = 0;
+        decoderRead(buffer, sizeof(buffer), &done);
+        if (done == 0) break;   // end of stream — decodeUpdate takes it from here
+
+        int frames = (int)(done / (sizeof(float) * 2));
+        samplesPlayed += frames;
+
+        g_outBuf.clear();
+        decodeToOutput(g_resampler, (float*)buffer, frames, g_outBuf);
+        if (!g_outBuf.empty())
+            pushBlockToEngine(g_outBuf.data(), (int)(g_outBuf.size() / 2));
+        queued += g_outBuf.size() / 2;
+    }
+    g_state.elapsedSeconds = (int)(samplesPlayed / g_state.sampleRate);
+
+    g_seekDecoderMs = (t1 - t0) / 19200.0;
+    g_seekPrerollMs = (svcGetSystemTick() - t1) / 19200.0;
+    if (!ok)
+        printf("[SEEK] Decoder seek to %.1f s failed\n", targetSeconds);
 }
 
 /* ---------------------------------------------------- */
@@ -747,7 +1077,7 @@ void playerSeek(float targetSeconds)
 /* ---------------------------------------------------- */
 bool playerIsShuffleEnabled() { return g_state.shuffle; }
 
-void playerToggleShuffle()
+static void toggleShuffleInternal()
 {
     g_state.shuffle = !g_state.shuffle;
     if (g_state.shuffle)
@@ -769,7 +1099,7 @@ void playerToggleShuffle()
 RepeatMode playerGetRepeatMode()    { return g_state.repeat; }
 bool       playerIsRepeatEnabled()  { return g_state.repeat != REPEAT_OFF; }
 
-void playerCycleRepeat()
+static void cycleRepeatInternal()
 {
     switch (g_state.repeat)
     {
@@ -781,27 +1111,63 @@ void playerCycleRepeat()
 
 float playerGetPosition()
 {
-    return g_state.playing ? (float)g_state.elapsedSeconds : 0.0f;
+    if (!g_state.playing) return 0.0f;
+    // While scrubbing the UI shows where the finger is, not what's playing
+    if (g_scrubbing.load(std::memory_order_acquire))
+        return g_scrubTarget.load(std::memory_order_relaxed);
+    return (float)g_state.elapsedSeconds;
+}
+
+// Decode thread: while a scrub is active, jump to the latest target at
+// most every SCRUB_PREVIEW_INTERVAL_MS and let it play until the next
+// jump — short snippets that follow the finger. Nothing queues up behind
+// a slow seek, since each preview reads the newest target.
+static void scrubPreviewUpdate()
+{
+    if (!g_scrubbing.load(std::memory_order_acquire) || !g_settings.scrubPreview ||
+        !g_state.playing || g_state.paused)
+        return;
+
+    float target = g_scrubTarget.load(std::memory_order_relaxed);
+    u64   now    = svcGetSystemTick();
+    if (target == g_previewTarget ||
+        now - g_previewTicks < (u64)SCRUB_PREVIEW_INTERVAL_MS * 19200)
+        return;
+
+    g_previewTarget = target;
+    g_previewTicks  = now;
+    g_scrubPreviews.fetch_add(1);
+    seekInternal(target, 0);
 }
 
 /* ---------------------------------------------------- */
 /* UPDATE LOOP                                          */
 /* ---------------------------------------------------- */
-void playerUpdate()
+static void decodeUpdate()
 {
+    // Request → audible, reported once the callback has played it
+    double seekMs;
+    if (audio.takeLatencyMs(&seekMs))
+        printf("[SEEK] %.1f ms to audio at the new position (decoder seek %.1f ms, pre-roll %.1f ms)\n",
+               seekMs, g_seekDecoderMs, g_seekPrerollMs);
+
     if (!decoderIsOpen() || !g_state.playing || g_state.paused)
         return;
 
-    const size_t TARGET_SAMPLES = g_state.sampleRate * g_state.channels / 10;
+    // Ring holds interleaved stereo at the device rate
+    const size_t TARGET_SAMPLES =
+        (size_t)audio.getSampleRate() * 2 * DECODE_TARGET_MS / 1000;
 
-    // Stack buffers — avoids the static aliasing hazard of the original
-    float floatPCM[FLOAT_BUF_FRAMES * 2];
-    float pcm1    [FLOAT_BUF_FRAMES * 2];
-    float pcm2    [FLOAT_BUF_FRAMES * 2];
+    // Resampler quality can change from the settings screen at any time
+    if (g_resampler.getQuality() != g_settings.resampleQuality)
+    {
+        g_resampler.setQuality(g_settings.resampleQuality);
+        g_resamplerNext.setQuality(g_settings.resampleQuality);
+    }
 
     while (audio.availableRead() < TARGET_SAMPLES)
     {
-        unsigned char buffer[DECODE_BUFFER];
+        alignas(16) unsigned char buffer[DECODE_BUFFER]; // float stereo
         size_t done = 0;
         int err = decoderRead(buffer, sizeof(buffer), &done);
 
@@ -812,12 +1178,14 @@ void playerUpdate()
         {
             if (done > 0)
             {
-                int frames = (int)(done / (sizeof(int16_t) * g_state.channels));
+                int frames = (int)(done / (sizeof(float) * 2));
                 samplesPlayed          += frames;
                 g_state.elapsedSeconds  = (int)(samplesPlayed / g_state.sampleRate);
 
-                processSamplesToFloat((int16_t*)buffer, floatPCM, frames, g_state.channels);
-                audio.pushPCM(floatPCM, frames * 2);
+                g_outBuf.clear();
+                decodeToOutput(g_resampler, (float*)buffer, frames, g_outBuf);
+                if (!g_outBuf.empty())
+                    pushBlockToEngine(g_outBuf.data(), (int)(g_outBuf.size() / 2));
             }
 
             // Compute AFTER updating samplesPlayed.
@@ -858,6 +1226,9 @@ void playerUpdate()
                         {
                             g_state.sampleRate = rate;
                             g_state.channels   = ch;
+                            // Same rate keeps the filter history → seamless;
+                            // a new rate just retunes the converter.
+                            g_resampler.setRates((int)rate, audio.getSampleRate());
                         }
 
                         samplesPlayed          = 0;
@@ -909,21 +1280,33 @@ void playerUpdate()
         /* ================================================= */
         else if (g_playbackState == STATE_CROSSFADING)
         {
-            unsigned char buffer2[DECODE_BUFFER];
+            alignas(16) unsigned char buffer2[DECODE_BUFFER];
             size_t done2 = 0;
             decoderReadNext(buffer2, sizeof(buffer2), &done2);
 
-            if (done == 0 && done2 == 0)
+            int frames1 = (int)(done  / (sizeof(float) * 2));
+            int frames2 = (int)(done2 / (sizeof(float) * 2));
+
+            // Both sides are converted to the device rate first, so tracks
+            // with different sample rates can be mixed frame-for-frame.
+            if (frames1 > 0)
+                decodeToOutput(g_resampler, (float*)buffer, frames1, g_xfadeCur);
+            if (frames2 > 0)
+                decodeToOutput(g_resamplerNext, (float*)buffer2, frames2, g_xfadeNext);
+
+            size_t avail1    = g_xfadeCur.size()  / 2;
+            size_t avail2    = g_xfadeNext.size() / 2;
+            size_t mixFrames = std::min(avail1, avail2);
+
+            // One stream is dry — mix what the other has against silence
+            // instead of stalling (or dropping it).
+            if (frames1 == 0 || frames2 == 0)
             {
-                // Both streams exhausted — drain whatever's left in the hw buffer
-                g_playbackState = STATE_DRAINING;
-                break;
+                mixFrames = std::max(avail1, avail2);
+                g_xfadeCur.resize(mixFrames * 2, 0.0f);
+                g_xfadeNext.resize(mixFrames * 2, 0.0f);
             }
 
-            int frames1   = (done  > 0) ? (int)(done  / (sizeof(int16_t) * g_state.channels)) : 0;
-            int frames2   = (done2 > 0) ? (int)(done2 / (sizeof(int16_t) * g_state.channels)) : 0;
-            int mixFrames = std::min(frames1, frames2);
-
             float duration = g_settings.crossfadeSeconds;
             if (duration < 0.01f) duration = 0.01f;
 
@@ -935,23 +1318,27 @@ void playerUpdate()
 
             if (mixFrames > 0)
             {
-                processSamplesToFloat((int16_t*)buffer,  pcm1, mixFrames, g_state.channels);
-                processSamplesToFloat((int16_t*)buffer2, pcm2, mixFrames, g_state.channels);
+                float* a = g_xfadeCur.data();
+                const float* b = g_xfadeNext.data();
+                for (size_t i = 0; i < mixFrames * 2; i++)
+                    a[i] = a[i] * fadeOut + b[i] * fadeIn;
 
-                for (int i = 0; i < mixFrames * 2; i++)
-                    pcm1[i] = pcm1[i] * fadeOut + pcm2[i] * fadeIn;
+                pushBlockToEngine(a, (int)mixFrames);
 
-                audio.pushPCM(pcm1, mixFrames * 2);
+                g_xfadeCur.erase(g_xfadeCur.begin(), g_xfadeCur.begin() + mixFrames * 2);
+                g_xfadeNext.erase(g_xfadeNext.begin(), g_xfadeNext.begin() + mixFrames * 2);
 
-                samplesPlayedNext   += frames2;
-                g_crossfadeProgress += (float)frames2 / g_state.sampleRate;
+                g_crossfadeProgress += (float)mixFrames / audio.getSampleRate();
             }
-            else
+            samplesPlayedNext += (uint64_t)frames2;
+
+            if (done == 0 && done2 == 0)
             {
-                // One stream is dry but the other has data — advance time so we don't stall
-                int liveFrames = std::max(frames1, frames2);
-                g_crossfadeProgress += (float)liveFrames / g_state.sampleRate;
-                samplesPlayedNext   += (uint64_t)frames2;
+                // Both streams exhausted — drain whatever's left in the hw buffer
+                g_xfadeCur.clear();
+                g_xfadeNext.clear();
+                g_playbackState = STATE_DRAINING;
+                break;
             }
 
             /* ---- switch metadata at the halfway point ---- */
@@ -972,6 +1359,7 @@ void playerUpdate()
                 }
 
                 promoteNextToCurrent();
+                std::swap(g_resampler, g_resamplerNext);
 
                 long rate; int ch;
                 if (decoderGetFormat(&rate, &ch))
@@ -980,6 +1368,13 @@ void playerUpdate()
                     g_state.channels   = ch;
                 }
 
+                // Whatever the incoming side had converted beyond the fade
+                // is already at full gain — queue it as-is.
+                if (!g_xfadeNext.empty())
+                    pushBlockToEngine(g_xfadeNext.data(), (int)(g_xfadeNext.size() / 2));
+                g_xfadeCur.clear();
+                g_xfadeNext.clear();
+
                 // samplesPlayedNext is how far into the new track we already are —
                 // set samplesPlayed to it so elapsed time is correct and the crossfade
                 // trigger doesn't immediately re-fire on the very next update.
@@ -1011,9 +1406,9 @@ void playerUpdate()
     {
         int nextIndex = playerPeekNextIndex();
         if (nextIndex >= 0)
-            playerNext();      // more tracks to play
+            nextInternal();    // more tracks to play
         else
-            playerStop();      // BUG FIX: was calling playerNext() which called
+            stopInternal();    // BUG FIX: was calling playerNext() which called
                                // playerStop() anyway, but left a frame where
                                // g_state.playing was true with a dead decoder.
     }
@@ -1026,5 +1421,275 @@ const PlayerState* playerGetState()          { return &g_state; }
 bool               playerIsPlaying()         { return g_state.playing; }
 bool               playerIsPaused()          { return g_state.playing && g_state.paused; }
 int                playerGetCurrentTrackIndex() { return g_state.trackIndex; }
-int                playerGetElapsedSeconds() { return g_state.elapsedSeconds; }
+int                playerGetElapsedSeconds() { return (int)playerGetPosition(); }
 int                playerGetTrackLength()    { return g_state.durationSeconds; }
+
+/* ---------------------------------------------------- */
+/* DECODE THREAD                                        */
+/* ---------------------------------------------------- */
+// The decode thread owns every decoder handle and the producer side of the
+// AudioEngine ring. The UI never touches them: the public player API below
+// only posts a PlayerCommand and returns, and the UI reads g_state.
+// A slow frame (text rendering, scanDir, cache rewrites) therefore can no
+// longer starve the audio callback.
+enum PlayerCommandType
+{
+    CMD_PLAY,
+    CMD_STOP,
+    CMD_NEXT,
+    CMD_PREV,
+    CMD_TOGGLE_PAUSE,
+    CMD_SEEK,
+    CMD_START_CROSSFADE,
+    CMD_ENQUEUE,
+    CMD_TOGGLE_SHUFFLE,
+    CMD_CYCLE_REPEAT
+};
+
+struct PlayerCommand
+{
+    PlayerCommandType type;
+    int      index   = -1;
+    float    seconds = 0.0f;
+    uint64_t seq     = 0;
+};
+
+#ifdef __SWITCH__
+static Thread      g_decodeThread;
+#else
+static std::thread g_decodeThread;
+#endif
+static bool                       g_decodeThreadStarted = false;
+static std::atomic<bool>          g_decodeThreadRunning{false};
+static std::mutex                 g_cmdMutex;
+static std::condition_variable    g_cmdCond;      // UI → decode thread
+static std::condition_variable    g_cmdDoneCond;  // decode thread → waiters
+static std::vector<PlayerCommand> g_cmdQueue;
+static uint64_t                   g_cmdPosted = 0;
+static uint64_t                   g_cmdDone   = 0;
+
+// Seek coalescing (under g_cmdMutex): at most one CMD_SEEK is queued,
+// and it runs with whatever target is newest when it executes
+static float                      g_seekTarget = 0.0f;
+static uint64_t                   g_seekTicks  = 0;
+static bool                       g_seekQueued = false;
+
+static void takeSeekTarget(float* seconds, uint64_t* ticks)
+{
+    std::lock_guard<std::mutex> lock(g_cmdMutex);
+    *seconds     = g_seekTarget;
+    *ticks       = g_seekTicks;
+    g_seekQueued = false;
+}
+
+static void executeCommand(const PlayerCommand& cmd)
+{
+    switch (cmd.type)
+    {
+        case CMD_PLAY:            playInternal(cmd.index);       break;
+        case CMD_STOP:            stopInternal();                break;
+        case CMD_NEXT:            nextInternal();                break;
+        case CMD_PREV:            prevInternal();                break;
+        case CMD_TOGGLE_PAUSE:    togglePauseInternal();         break;
+        case CMD_SEEK:
+        {
+            float sec; uint64_t ticks;
+            takeSeekTarget(&sec, &ticks);
+            seekInternal(sec, ticks);
+            break;
+        }
+        case CMD_START_CROSSFADE: startCrossfadeInternal();      break;
+        case CMD_ENQUEUE:         enqueueInternal(cmd.index);    break;
+        case CMD_TOGGLE_SHUFFLE:  toggleShuffleInternal();       break;
+        case CMD_CYCLE_REPEAT:    cycleRepeatInternal();         break;
+    }
+}
+
+static void decodeThreadMain(void*)
+{
+    std::vector<PlayerCommand> batch;
+
+    while (g_decodeThreadRunning.load(std::memory_order_acquire))
+    {
+        {
+            std::unique_lock<std::mutex> lock(g_cmdMutex);
+            if (g_cmdQueue.empty())
+            {
+                int pollMs = (g_state.playing && !g_state.paused)
+                           ? DECODE_POLL_MS : DECODE_IDLE_POLL_MS;
+                g_cmdCond.wait_for(lock, std::chrono::milliseconds(pollMs), [] {
+                    return !g_cmdQueue.empty() ||
+                           !g_decodeThreadRunning.load(std::memory_order_relaxed);
+                });
+            }
+            batch.swap(g_cmdQueue);
+        }
+
+        uint64_t lastSeq = 0;
+        for (const PlayerCommand& cmd : batch)
+        {
+            executeCommand(cmd);
+            lastSeq = cmd.seq;
+        }
+        batch.clear();
+
+        if (lastSeq)
+        {
+            std::lock_guard<std::mutex> lock(g_cmdMutex);
+            g_cmdDone = lastSeq;
+            g_cmdDoneCond.notify_all();
+        }
+
+        scrubPreviewUpdate();
+        decodeUpdate();
+    }
+}
+
+// Queue a command for the decode thread. With wait=true the caller blocks
+// until it has been executed (used where the caller is about to touch
+// state the decode thread reads, e.g. clearing the playlist).
+static void postCommand(PlayerCommand cmd, bool wait = false)
+{
+    if (!g_decodeThreadStarted)
+    {
+        // Not running yet (or already shut down) — execute inline.
+        executeCommand(cmd);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(g_cmdMutex);
+    cmd.seq = ++g_cmdPosted;
+    g_cmdQueue.push_back(cmd);
+    g_cmdCond.notify_one();
+
+    if (wait)
+    {
+        uint64_t seq = cmd.seq;
+        g_cmdDoneCond.wait(lock, [seq] { return g_cmdDone >= seq; });
+    }
+}
+
+static void decodeThreadStart()
+{
+    if (g_decodeThreadStarted)
+        return;
+
+    g_decodeThreadRunning.store(true, std::memory_order_release);
+
+#ifdef __SWITCH__
+    Result rc = threadCreate(&g_decodeThread, decodeThreadMain, nullptr, nullptr,
+                             DECODE_THREAD_STACK, DECODE_THREAD_PRIO, DECODE_THREAD_CPU);
+    if (R_FAILED(rc))
+    {
+        printf("Decode thread: threadCreate failed (0x%x)\n", rc);
+        g_decodeThreadRunning.store(false);
+        return;
+    }
+    threadStart(&g_decodeThread);
+#else
+    g_decodeThread = std::thread(decodeThreadMain, nullptr);
+#endif
+
+    g_decodeThreadStarted = true;
+}
+
+static void decodeThreadStop()
+{
+    if (!g_decodeThreadStarted)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(g_cmdMutex);
+        g_decodeThreadRunning.store(false, std::memory_order_release);
+        g_cmdCond.notify_one();
+    }
+
+#ifdef __SWITCH__
+    threadWaitForExit(&g_decodeThread);
+    threadClose(&g_decodeThread);
+#else
+    g_decodeThread.join();
+#endif
+
+    g_decodeThreadStarted = false;
+}
+
+/* ---------------------------------------------------- */
+/* PUBLIC CONTROL (posts to the decode thread)          */
+/* ---------------------------------------------------- */
+void playerPlay(int index)
+{
+    PlayerCommand cmd{ CMD_PLAY };
+    cmd.index = index;
+    postCommand(cmd);
+}
+
+// Synchronous: once this returns no decoder is open and the decode thread
+// no longer reads the playlist, so callers may clear/rebuild it safely.
+void playerStop()             { postCommand({ CMD_STOP }, true); }
+void playerNext()             { postCommand({ CMD_NEXT }); }
+void playerPrev()             { postCommand({ CMD_PREV }); }
+void playerTogglePause()      { postCommand({ CMD_TOGGLE_PAUSE }); }
+void playerStartCrossfade()   { postCommand({ CMD_START_CROSSFADE }); }
+void playerToggleShuffle()    { postCommand({ CMD_TOGGLE_SHUFFLE }); }
+void playerCycleRepeat()      { postCommand({ CMD_CYCLE_REPEAT }); }
+
+void playerEnqueue(int index)
+{
+    PlayerCommand cmd{ CMD_ENQUEUE };
+    cmd.index = index;
+    postCommand(cmd);
+}
+
+// Called as often as the UI likes (every touch event, every frame a
+// button is held): only the newest target survives, and the decoder is
+// never handed more than one seek at a time.
+void playerSeek(float targetSeconds)
+{
+    {
+        std::lock_guard<std::mutex> lock(g_cmdMutex);
+        g_seekTarget = targetSeconds;
+        g_seekTicks  = svcGetSystemTick();
+        if (g_seekQueued) return;   // the queued one will pick this up
+        g_seekQueued = true;
+    }
+    postCommand({ CMD_SEEK });
+}
+
+void playerScrubTo(float targetSeconds)
+{
+    if (!g_state.playing) return;
+
+    float len = (float)g_state.durationSeconds;
+    if (targetSeconds < 0.0f) targetSeconds = 0.0f;
+    if (len > 0.0f && targetSeconds > len) targetSeconds = len;
+
+    g_scrubTarget.store(targetSeconds, std::memory_order_relaxed);
+    if (!g_scrubbing.exchange(true, std::memory_order_acq_rel))
+    {
+        g_scrubMoves.store(0);
+        g_scrubPreviews.store(0);
+    }
+    g_scrubMoves.fetch_add(1);
+}
+
+void playerScrubEnd()
+{
+    if (!g_scrubbing.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    float target = g_scrubTarget.load(std::memory_order_relaxed);
+    printf("[SEEK] Scrub released at %.1f s: %u positions, %u previews\n",
+           target, g_scrubMoves.load(), g_scrubPreviews.load());
+    playerSeek(target);
+}
+
+void playerScrubCancel()
+{
+    scrubCancel("input moved away");
+}
+
+bool playerIsScrubbing()
+{
+    return g_scrubbing.load(std::memory_order_acquire);
+}
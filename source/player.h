@@ -7,13 +7,13 @@ extern "C" {
 #include "player_state.h"
 struct Mp3MetadataEntry;
 void playerInit();
+void playerShutdown();
 void playerPlay(int index);
 void playerStop();
 void playerStartCrossfade();
 //void playerNext();
 void playerPrev();
 bool playerIsPlaying();
-void playerUpdate();
 //void applyReplayGainFromMetadata();
 void applyReplayGainFromMetadata(const Mp3MetadataEntry& meta);
 //void applyReplayGainFromMetadata(const Mp3MetadataEntry& meta);
@@ -26,14 +26,24 @@ bool playerIsRepeatEnabled();
 void playerToggleShuffle();
 void playerToggleRepeat();
 
-float playerGetPosition();   // seconds
-void  playerSeek(float sec);
+float playerGetPosition();   // seconds (the scrub target while scrubbing)
+void  playerSeek(float sec); // coalesced: only the newest target is executed
+
+// Drag / hold-to-scrub. The decoder only previews (if enabled in
+// settings) while scrubbing; the real seek happens on release.
+void  playerScrubTo(float sec);   // starts a scrub if none is active
+void  playerScrubEnd();
+void  playerScrubCancel();        // drop the scrub without seeking
+bool  playerIsScrubbing();
 
 
 #define PREV_RESTART_THRESHOLD 3.0f
 
-#define FFT_SIZE 1024
-extern float g_fftInput[FFT_SIZE];
+// UI thread: the newest `frames` mono samples of what is audible right
+// now, from the output tap. False (and `out` untouched) if there is
+// nothing to give yet.
+bool playerReadAnalysisWindow(float* out, int frames);
+int  playerGetOutputSampleRate();
 
 void playerSetVolume(float v);
 float playerGetVolume();
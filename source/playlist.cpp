@@ -10,7 +10,8 @@
 #include "filebrowser.h"
 #include "player.h"
 
-static std::vector<std::string> playlist;
+static std::vector<TrackId> playlist;
+static std::vector<uint8_t> inPlaylist;   // indexed by TrackId — O(1) duplicate check
 
 int playlistScroll = 0;              // top visible item
 static int currentIndex = 0;         // selected track
@@ -47,10 +48,18 @@ int playlistGetCurrentIndex()
 
 
 /* ---------- Add / Get ---------- */
-void playlistAdd(const char* path)
+TrackId playlistAdd(const char* path)
 {
-    if (!path) return;
-    playlist.push_back(path);
+    TrackId id = trackIntern(path);
+    if (id == TRACK_ID_NONE) return TRACK_ID_NONE;
+
+    if (id >= inPlaylist.size())
+        inPlaylist.resize(id + 1024, 0);
+    if (inPlaylist[id]) return TRACK_ID_NONE;
+
+    inPlaylist[id] = 1;
+    playlist.push_back(id);
+    return id;
 }
 
 int playlistGetCount()
@@ -61,7 +70,19 @@ int playlistGetCount()
 const char* playlistGetTrack(int index)
 {
     if (index < 0 || index >= (int)playlist.size()) return NULL;
-    return playlist[index].c_str();
+    return trackGetPath(playlist[index]);
+}
+
+TrackId playlistGetTrackId(int index)
+{
+    if (index < 0 || index >= (int)playlist.size()) return TRACK_ID_NONE;
+    return playlist[index];
+}
+
+const Mp3MetadataEntry* playlistGetMetadata(int index)
+{
+    if (index < 0 || index >= (int)playlist.size()) return NULL;
+    return trackGetMetadata(playlist[index]);
 }
 
 
@@ -92,6 +113,7 @@ void playlistScrollDown()
 /* ---------- Clear ---------- */
 void playlistClear()
 {
+    for (TrackId id : playlist) inPlaylist[id] = 0;
     playlist.clear();
     playlistScroll = 0;
     currentIndex = 0;
@@ -130,11 +152,8 @@ void renderPlaylist(SDL_Renderer* renderer, TTF_Font* font)
         const char* trackPath = playlistGetTrack(idx);
         if (!trackPath) continue;
 
-        const Mp3MetadataEntry* md = mp3GetTrackMetadata(idx);
-        if (!md) md = flacGetTrackMetadata(idx);
-        if (!md) md = oggGetTrackMetadata(idx);
-        if (!md) md = wavGetTrackMetadata(idx);
-        // If still null, render a fallback line using the filename
+        const Mp3MetadataEntry* md = playlistGetMetadata(idx);
+        // If null, render a fallback line using the filename
 
 
         char line[256];
@@ -153,10 +172,11 @@ void renderPlaylist(SDL_Renderer* renderer, TTF_Font* font)
         titleRect.x += (MAX_VISIBLE_TRACKS - 1 - i) * 75;
         timeRect.x  += (MAX_VISIBLE_TRACKS - 1 - i) * 75;
 
-        // Highlight selected
+        // Highlight selected (106: the look of the old alpha-60
+        // fill, which was drawn twice a frame)
         if (idx == playlistGetCurrentIndex())
         {
-            SDL_SetRenderDrawColor(renderer, 0, 128, 255, 60);
+            SDL_SetRenderDrawColor(renderer, 0, 128, 255, 106);
             SDL_Rect highlight = titleRect;
             highlight.w = 70;
             highlight.h = 945;
@@ -1,6 +1,7 @@
 #pragma once
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include "tracktable.h"
 
 // Scroll support
 extern int playlistScroll;          // allows main.cpp to modify scroll position
@@ -16,11 +17,16 @@ int playlistGetMaxVisible();    // how many songs fit on screen
 // Draw playlist UI
 void renderPlaylist(SDL_Renderer* renderer, TTF_Font* font);
 
-// Add a song to playlist (full path)
-void playlistAdd(const char* path);
+// Add a song to playlist (full path). Returns its track ID,
+// or TRACK_ID_NONE if the path is already in the playlist.
+TrackId playlistAdd(const char* path);
 
 // Get track count
 int playlistGetCount();
 
 // Get track path by index
 const char* playlistGetTrack(int index);
+
+// Track ID / metadata by index — O(1), whatever the format
+TrackId                 playlistGetTrackId(int index);
+const Mp3MetadataEntry* playlistGetMetadata(int index);
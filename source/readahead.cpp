@@ -0,0 +1,427 @@
+#include "readahead.h"
+#include <switch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+#ifndef __SWITCH__
+#include <thread>
+#endif
+
+/* -------------------------------------------------------
+   Config
+------------------------------------------------------- */
+#define READAHEAD_ALIGN         4096
+#define READAHEAD_THREAD_STACK  0x8000
+#define READAHEAD_THREAD_PRIO   0x2A    // above the decode thread (0x2B) —
+                                        // it mostly sleeps in fread
+#define READAHEAD_THREAD_CPU    2
+
+/* -------------------------------------------------------
+   Stream state
+   A slot owns one pool block and caches one file block.
+     FREE    — no block assigned
+     QUEUED  — waiting in the I/O queue (block can still be
+               retargeted by the reader)
+     LOADING — I/O thread is filling it; hands off
+     READY   — `bytes` valid bytes of block `block`
+------------------------------------------------------- */
+enum SlotState { SLOT_FREE, SLOT_QUEUED, SLOT_LOADING, SLOT_READY };
+
+struct ReadAheadSlot
+{
+    uint8_t*  buf   = nullptr;
+    int64_t   block = -1;
+    size_t    bytes = 0;
+    SlotState state = SLOT_FREE;
+};
+
+struct ReadAheadStream
+{
+    FILE*         file   = nullptr;
+    int64_t       size   = 0;
+    int64_t       pos    = 0;
+    bool          pooled = false;   // false → direct fread on the caller
+    int64_t       filePos = -1;     // direct mode: where `file` is positioned
+    ReadAheadSlot slots[READAHEAD_WINDOW_BLOCKS];
+    ReadAheadStats stats;
+};
+
+struct ReadAheadRequest
+{
+    ReadAheadStream* stream;
+    ReadAheadSlot*   slot;
+};
+
+/* -------------------------------------------------------
+   Service state
+------------------------------------------------------- */
+#ifdef __SWITCH__
+static Thread      g_raThread;
+#else
+static std::thread g_raThread;
+#endif
+static bool                         g_raStarted = false;
+static bool                         g_raQuit    = false;
+static std::mutex                   g_raMutex;
+static std::condition_variable      g_raWork;   // reader → I/O thread
+static std::condition_variable      g_raDone;   // I/O thread → readers
+static std::deque<ReadAheadRequest> g_raQueue;
+static uint8_t*                     g_raPool = nullptr;
+static std::vector<uint8_t*>        g_raFreeBlocks;
+static std::vector<ReadAheadStream*> g_raOpen;
+static ReadAheadStats               g_raClosedStats;  // folded in on close
+
+static uint64_t elapsedNs(std::chrono::steady_clock::time_point t0)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+}
+
+static void addStats(ReadAheadStats& dst, const ReadAheadStats& src)
+{
+    dst.bytesPrefetched += src.bytesPrefetched;
+    dst.hits            += src.hits;
+    dst.misses          += src.misses;
+    dst.stallNs         += src.stallNs;
+}
+
+/* -------------------------------------------------------
+   I/O thread
+------------------------------------------------------- */
+static void readAheadThreadMain(void*)
+{
+    std::unique_lock<std::mutex> lock(g_raMutex);
+
+    while (true)
+    {
+        g_raWork.wait(lock, [] { return g_raQuit || !g_raQueue.empty(); });
+        if (g_raQuit) break;
+
+        ReadAheadRequest req = g_raQueue.front();
+        g_raQueue.pop_front();
+        if (req.slot->state != SLOT_QUEUED) continue;
+
+        ReadAheadSlot* slot = req.slot;
+        FILE*   file  = req.stream->file;
+        int64_t block = slot->block;
+        slot->state   = SLOT_LOADING;
+
+        lock.unlock();
+        size_t got = 0;
+        if (fseek(file, (long)(block * READAHEAD_BLOCK_BYTES), SEEK_SET) == 0)
+            got = fread(slot->buf, 1, READAHEAD_BLOCK_BYTES, file);
+        lock.lock();
+
+        slot->bytes  = got;
+        slot->state  = SLOT_READY;
+        req.stream->stats.bytesPrefetched += got;
+        g_raDone.notify_all();
+    }
+}
+
+/* -------------------------------------------------------
+   Window scheduling  (g_raMutex held)
+   Makes sure every block in [pos, pos + window) is cached
+   or on its way, recycling slots that fell behind or were
+   left stranded by a seek. Nearest block is queued first.
+------------------------------------------------------- */
+static ReadAheadSlot* findSlot(ReadAheadStream* s, int64_t block)
+{
+    for (ReadAheadSlot& sl : s->slots)
+        if (sl.state != SLOT_FREE && sl.block == block)
+            return &sl;
+    return nullptr;
+}
+
+static void scheduleWindow(ReadAheadStream* s)
+{
+    if (s->size <= 0) return;
+
+    int64_t first = s->pos / READAHEAD_BLOCK_BYTES;
+    int64_t last  = std::min<int64_t>(first + READAHEAD_WINDOW_BLOCKS - 1,
+                                      (s->size - 1) / READAHEAD_BLOCK_BYTES);
+    bool queued = false;
+
+    for (int64_t b = first; b <= last; b++)
+    {
+        if (findSlot(s, b)) continue;
+
+        ReadAheadSlot* victim = nullptr;
+        for (ReadAheadSlot& sl : s->slots)
+        {
+            if (sl.state == SLOT_LOADING) continue;
+            if (sl.state == SLOT_FREE || sl.block < first || sl.block > last)
+            { victim = &sl; break; }
+        }
+        if (!victim) break;
+
+        // A QUEUED slot is already in the queue — just retarget it
+        if (victim->state != SLOT_QUEUED)
+        {
+            g_raQueue.push_back({ s, victim });
+            queued = true;
+        }
+        victim->block = b;
+        victim->bytes = 0;
+        victim->state = SLOT_QUEUED;
+    }
+
+    if (queued) g_raWork.notify_one();
+}
+
+/* -------------------------------------------------------
+   Service lifecycle
+------------------------------------------------------- */
+void readAheadInit()
+{
+    if (g_raStarted) return;
+
+    g_raPool = (uint8_t*)aligned_alloc(READAHEAD_ALIGN,
+        (size_t)READAHEAD_POOL_BLOCKS * READAHEAD_BLOCK_BYTES);
+    if (!g_raPool)
+    {
+        printf("[ReadAhead] pool allocation failed — direct reads only\n");
+        return;
+    }
+    for (int i = 0; i < READAHEAD_POOL_BLOCKS; i++)
+        g_raFreeBlocks.push_back(g_raPool + (size_t)i * READAHEAD_BLOCK_BYTES);
+
+    g_raQuit = false;
+
+#ifdef __SWITCH__
+    Result rc = threadCreate(&g_raThread, readAheadThreadMain, nullptr, nullptr,
+                             READAHEAD_THREAD_STACK, READAHEAD_THREAD_PRIO,
+                             READAHEAD_THREAD_CPU);
+    if (R_FAILED(rc))
+    {
+        printf("[ReadAhead] threadCreate failed (0x%x)\n", rc);
+        g_raFreeBlocks.clear();
+        free(g_raPool);
+        g_raPool = nullptr;
+        return;
+    }
+    threadStart(&g_raThread);
+#else
+    g_raThread = std::thread(readAheadThreadMain, nullptr);
+#endif
+
+    g_raStarted = true;
+}
+
+// Every stream must be closed first (the decoders close theirs in
+// playerStop, which runs before this).
+void readAheadShutdown()
+{
+    if (!g_raStarted) return;
+
+    {
+        std::lock_guard<std::mutex> lock(g_raMutex);
+        g_raQuit = true;
+        g_raWork.notify_one();
+    }
+
+#ifdef __SWITCH__
+    threadWaitForExit(&g_raThread);
+    threadClose(&g_raThread);
+#else
+    g_raThread.join();
+#endif
+
+    ReadAheadStats st;
+    readAheadGetStats(&st);
+    uint64_t total = st.hits + st.misses;
+    printf("[ReadAhead] %llu KB prefetched, hit rate %.1f%%, stalled %.1f ms\n",
+           (unsigned long long)(st.bytesPrefetched / 1024),
+           total ? 100.0 * st.hits / total : 100.0,
+           st.stallNs / 1e6);
+
+    g_raQueue.clear();
+    g_raFreeBlocks.clear();
+    free(g_raPool);
+    g_raPool    = nullptr;
+    g_raStarted = false;
+}
+
+void readAheadGetStats(ReadAheadStats* out)
+{
+    std::lock_guard<std::mutex> lock(g_raMutex);
+    *out = g_raClosedStats;
+    for (ReadAheadStream* s : g_raOpen)
+        addStats(*out, s->stats);
+}
+
+/* -------------------------------------------------------
+   Streams
+------------------------------------------------------- */
+ReadAheadStream* readAheadOpen(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return nullptr;
+
+    struct stat st;
+    if (fstat(fileno(f), &st) != 0)
+    {
+        fclose(f);
+        return nullptr;
+    }
+
+    // Whole blocks go straight from the SD card into pool memory
+    setvbuf(f, nullptr, _IONBF, 0);
+
+    ReadAheadStream* s = new ReadAheadStream();
+    s->file = f;
+    s->size = (int64_t)st.st_size;
+
+    std::lock_guard<std::mutex> lock(g_raMutex);
+    if (g_raStarted && g_raFreeBlocks.size() >= READAHEAD_WINDOW_BLOCKS)
+    {
+        for (ReadAheadSlot& sl : s->slots)
+        {
+            sl.buf = g_raFreeBlocks.back();
+            g_raFreeBlocks.pop_back();
+        }
+        s->pooled = true;
+        scheduleWindow(s);
+    }
+    else
+    {
+        // Pool exhausted / service down — unbuffered direct reads would be
+        // tiny and slow, so give stdio a buffer back
+        setvbuf(f, nullptr, _IOFBF, 64 * 1024);
+    }
+    g_raOpen.push_back(s);
+    return s;
+}
+
+void readAheadClose(ReadAheadStream* s)
+{
+    if (!s) return;
+
+    {
+        std::unique_lock<std::mutex> lock(g_raMutex);
+
+        // Drop queued requests, then let an in-flight read land before the
+        // block goes back to the pool
+        g_raQueue.erase(std::remove_if(g_raQueue.begin(), g_raQueue.end(),
+                            [s](const ReadAheadRequest& r) { return r.stream == s; }),
+                        g_raQueue.end());
+        g_raDone.wait(lock, [s] {
+            for (const ReadAheadSlot& sl : s->slots)
+                if (sl.state == SLOT_LOADING) return false;
+            return true;
+        });
+
+        if (s->pooled)
+            for (ReadAheadSlot& sl : s->slots)
+                g_raFreeBlocks.push_back(sl.buf);
+
+        addStats(g_raClosedStats, s->stats);
+        g_raOpen.erase(std::remove(g_raOpen.begin(), g_raOpen.end(), s),
+                       g_raOpen.end());
+    }
+
+    fclose(s->file);
+    delete s;
+}
+
+// Direct-mode read: the caller does the I/O itself
+static size_t readDirect(ReadAheadStream* s, void* dst, size_t bytes)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    if (s->filePos != s->pos)
+    {
+        if (fseek(s->file, (long)s->pos, SEEK_SET) != 0) return 0;
+        s->filePos = s->pos;
+    }
+    size_t got = fread(dst, 1, bytes, s->file);
+    s->pos     += (int64_t)got;
+    s->filePos += (int64_t)got;
+
+    s->stats.misses++;
+    s->stats.stallNs += elapsedNs(t0);
+    return got;
+}
+
+size_t readAheadRead(ReadAheadStream* s, void* dst, size_t bytes)
+{
+    if (!s || bytes == 0 || s->pos >= s->size) return 0;
+    if (!s->pooled) return readDirect(s, dst, bytes);
+
+    uint8_t* out  = (uint8_t*)dst;
+    size_t   done = 0;
+
+    std::unique_lock<std::mutex> lock(g_raMutex);
+
+    while (done < bytes && s->pos < s->size)
+    {
+        int64_t block = s->pos / READAHEAD_BLOCK_BYTES;
+        scheduleWindow(s);
+
+        ReadAheadSlot* sl = findSlot(s, block);
+        if (sl && sl->state == SLOT_READY)
+        {
+            s->stats.hits++;
+        }
+        else
+        {
+            s->stats.misses++;
+            auto t0 = std::chrono::steady_clock::now();
+
+            // Right after a seek every slot can still be mid-load for a
+            // stale block; wait for one to land so it can be retargeted
+            while (!sl)
+            {
+                g_raDone.wait(lock);
+                scheduleWindow(s);
+                sl = findSlot(s, block);
+            }
+            g_raDone.wait(lock, [sl] { return sl->state == SLOT_READY; });
+            s->stats.stallNs += elapsedNs(t0);
+        }
+
+        size_t off = (size_t)(s->pos - block * READAHEAD_BLOCK_BYTES);
+        if (off >= sl->bytes) break; // short read: file shrank / I/O error
+
+        size_t n = std::min(bytes - done, sl->bytes - off);
+        memcpy(out + done, sl->buf + off, n);
+        done   += n;
+        s->pos += (int64_t)n;
+    }
+
+    // Top the window up past wherever we stopped
+    scheduleWindow(s);
+    return done;
+}
+
+bool readAheadSeek(ReadAheadStream* s, int64_t offset, int whence)
+{
+    if (!s) return false;
+
+    int64_t base = (whence == SEEK_CUR) ? s->pos
+                 : (whence == SEEK_END) ? s->size
+                 : 0;
+    int64_t target = base + offset;
+    if (target < 0) return false;
+
+    // Past-the-end is allowed (like fseek); reads just return 0 there
+    s->pos = target;
+
+    if (s->pooled)
+    {
+        std::lock_guard<std::mutex> lock(g_raMutex);
+        scheduleWindow(s);
+    }
+    return true;
+}
+
+int64_t readAheadTell(const ReadAheadStream* s) { return s ? s->pos  : -1; }
+int64_t readAheadSize(const ReadAheadStream* s) { return s ? s->size : -1; }
+bool    readAheadEof (const ReadAheadStream* s) { return !s || s->pos >= s->size; }
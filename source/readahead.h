@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* -------------------------------------------------------
+   Asynchronous read-ahead I/O
+   One I/O thread serves every open stream from a shared
+   pool of fixed-size aligned blocks. Each stream keeps a
+   window of blocks past its read position in flight, so SD
+   card latency spikes are absorbed here instead of stalling
+   the decode thread.
+
+   Read/seek/tell are ordinary blocking calls made from one
+   thread per stream (the decode thread); only the refill is
+   asynchronous. When the service isn't running or the pool
+   is exhausted, a stream silently falls back to direct
+   reads, so callers never need a second code path.
+------------------------------------------------------- */
+#define READAHEAD_BLOCK_BYTES   (128 * 1024)
+#define READAHEAD_WINDOW_BLOCKS 4     // 512 KB in flight per stream
+#define READAHEAD_POOL_BLOCKS   16    // current + next track, with headroom
+
+struct ReadAheadStream;
+
+struct ReadAheadStats
+{
+    uint64_t bytesPrefetched = 0;  // read by the I/O thread
+    uint64_t hits            = 0;  // block was ready when the reader got there
+    uint64_t misses          = 0;  // reader had to wait for (or read) the block
+    uint64_t stallNs         = 0;  // total time readers spent waiting
+};
+
+/* -------------------------------------------------------
+   Service lifecycle
+------------------------------------------------------- */
+void readAheadInit();
+void readAheadShutdown();
+
+// Totals across every stream closed so far plus the open ones
+void readAheadGetStats(ReadAheadStats* out);
+
+/* -------------------------------------------------------
+   Streams  (stdio-like; whence is SEEK_SET/CUR/END)
+------------------------------------------------------- */
+ReadAheadStream* readAheadOpen(const char* path);
+void             readAheadClose(ReadAheadStream* s);
+
+size_t  readAheadRead(ReadAheadStream* s, void* dst, size_t bytes);
+bool    readAheadSeek(ReadAheadStream* s, int64_t offset, int whence);
+int64_t readAheadTell(const ReadAheadStream* s);
+int64_t readAheadSize(const ReadAheadStream* s);
+bool    readAheadEof(const ReadAheadStream* s);
@@ -0,0 +1,210 @@
+#include "resampler.h"
+#include <string.h>
+#include <math.h>
+
+/* ---------------------------------------------------- */
+/* CONFIG                                               */
+/* ---------------------------------------------------- */
+#define RESAMPLE_MAX_PHASES 4096   // caps the table for odd rate pairs
+
+struct ResampleTier
+{
+    int   taps;
+    float rolloff;   // cutoff as a fraction of the lower Nyquist
+    float beta;      // Kaiser window shape
+};
+
+static const ResampleTier kTiers[] =
+{
+    {  8, 0.85f, 5.0f },   // RESAMPLE_LOW
+    { 16, 0.90f, 7.0f },   // RESAMPLE_MEDIUM
+    { 32, 0.94f, 9.0f },   // RESAMPLE_HIGH
+};
+
+/* ---------------------------------------------------- */
+/* FILTER DESIGN                                        */
+/* ---------------------------------------------------- */
+static double besselI0(double x)
+{
+    // Power series — converges quickly for the beta range we use
+    double sum  = 1.0;
+    double term = 1.0;
+    double q    = x * x * 0.25;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= q / ((double)k * k);
+        sum  += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+static int gcdInt(int a, int b)
+{
+    while (b) { int t = a % b; a = b; b = t; }
+    return a;
+}
+
+void Resampler::setQuality(ResampleQuality q)
+{
+    if (q == quality && !phases.empty())
+        return;
+    quality = q;
+    rebuild();
+}
+
+void Resampler::setRates(int in, int out)
+{
+    if (in == inRate && out == outRate && !phases.empty())
+        return;
+    inRate  = in;
+    outRate = out;
+    rebuild();
+}
+
+void Resampler::rebuild()
+{
+    if (inRate <= 0 || outRate <= 0)
+        return;
+
+    const ResampleTier& tier = kTiers[(int)quality];
+    taps = tier.taps;
+
+    int g = gcdInt(inRate, outRate);
+    L = outRate / g;
+    M = inRate  / g;
+    if (L > RESAMPLE_MAX_PHASES)
+    {
+        // Unusual rate pair: approximate the ratio, the pitch error is
+        // far below audibility at this resolution.
+        M = (int)((double)M * RESAMPLE_MAX_PHASES / L + 0.5);
+        L = RESAMPLE_MAX_PHASES;
+    }
+
+    phases.clear();
+    if (L == 1 && M == 1)
+    {
+        reset();
+        return;
+    }
+
+    // Cutoff relative to the input Nyquist: when decimating, the output
+    // Nyquist is the limit.
+    double cutoff = tier.rolloff * ((L < M) ? (double)L / M : 1.0);
+    double half   = taps * 0.5;
+    double i0Beta = besselI0(tier.beta);
+
+    phases.resize((size_t)L * taps);
+    for (int p = 0; p < L; ++p)
+    {
+        float* c = &phases[(size_t)p * taps];
+        double sum = 0.0;
+
+        for (int j = 0; j < taps; ++j)
+        {
+            // Distance (in input frames) between the output instant and tap j;
+            // taps are stored oldest → newest.
+            double x = (double)p / L + (half - 1.0) - j;
+
+            double s = cutoff;
+            if (fabs(x) > 1e-9)
+                s = sin(M_PI * cutoff * x) / (M_PI * x);
+
+            double u = x / half;
+            double w = (fabs(u) < 1.0)
+                     ? besselI0(tier.beta * sqrt(1.0 - u * u)) / i0Beta
+                     : 0.0;
+
+            c[j] = (float)(s * w);
+            sum += c[j];
+        }
+
+        // Unity DC gain per phase, so no phase-dependent ripple
+        if (sum != 0.0)
+            for (int j = 0; j < taps; ++j)
+                c[j] = (float)(c[j] / sum);
+    }
+
+    reset();
+}
+
+void Resampler::reset()
+{
+    phaseAcc = 0;
+
+    if (phases.empty())
+    {
+        historyFrames = 0;
+        return;
+    }
+
+    // Prime with the filter's group delay so output 0 lines up with input 0
+    historyFrames = taps / 2 - 1;
+    history.assign((size_t)(historyFrames + taps) * 2, 0.0f);
+}
+
+/* ---------------------------------------------------- */
+/* PROCESS                                              */
+/* ---------------------------------------------------- */
+int Resampler::maxOutputFrames(int inFrames) const
+{
+    if (phases.empty())
+        return inFrames;
+    return (int)(((int64_t)(inFrames + taps) * L) / M) + 2;
+}
+
+int Resampler::process(const float* in, int inFrames, float* out)
+{
+    if (phases.empty())
+    {
+        // Same rate (or not configured yet) — straight copy
+        memcpy(out, in, (size_t)inFrames * 2 * sizeof(float));
+        return inFrames;
+    }
+
+    size_t need = (size_t)(historyFrames + inFrames) * 2;
+    if (history.size() < need)
+        history.resize(need);
+    memcpy(&history[(size_t)historyFrames * 2], in, (size_t)inFrames * 2 * sizeof(float));
+    historyFrames += inFrames;
+
+    const float* x = history.data();
+    int produced = 0;
+
+    for (;;)
+    {
+        uint64_t i = phaseAcc / L;
+        if (i + taps > (uint64_t)historyFrames)
+            break;
+
+        const float* c = &phases[(size_t)(phaseAcc % L) * taps];
+        const float* s = x + i * 2;
+
+        float l = 0.0f, r = 0.0f;
+        for (int j = 0; j < taps; ++j)
+        {
+            l += c[j] * s[j * 2];
+            r += c[j] * s[j * 2 + 1];
+        }
+
+        out[produced * 2]     = l;
+        out[produced * 2 + 1] = r;
+        ++produced;
+
+        phaseAcc += M;
+    }
+
+    // Drop input frames no future output can reach
+    int drop = (int)(phaseAcc / L);
+    if (drop > historyFrames)
+        drop = historyFrames;
+    if (drop > 0)
+    {
+        memmove(history.data(), history.data() + (size_t)drop * 2,
+                (size_t)(historyFrames - drop) * 2 * sizeof(float));
+        historyFrames -= drop;
+        phaseAcc      -= (uint64_t)drop * L;
+    }
+
+    return produced;
+}
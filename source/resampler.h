@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "settings_state.h"
+
+// Polyphase windowed-sinc sample-rate converter for interleaved stereo.
+//
+// The rate ratio is reduced to L/M (e.g. 44100 → 48000 = 160/147) and one
+// Kaiser-windowed sinc phase is precomputed for each of the L output
+// positions, so every output frame is a single dot product over `taps`
+// input frames — no per-sample trig. Equal rates are a straight copy.
+//
+// Quality tiers trade taps (CPU) for passband width and stopband depth:
+//   RESAMPLE_LOW     8 taps   rolloff 0.85  Kaiser beta 5
+//   RESAMPLE_MEDIUM 16 taps   rolloff 0.90  Kaiser beta 7
+//   RESAMPLE_HIGH   32 taps   rolloff 0.94  Kaiser beta 9
+class Resampler
+{
+public:
+    void setQuality(ResampleQuality q);
+    ResampleQuality getQuality() const { return quality; }
+
+    // Changing either rate rebuilds the filter table and clears history.
+    void setRates(int inRate, int outRate);
+    int  getInRate()  const { return inRate; }
+    int  getOutRate() const { return outRate; }
+
+    void reset();   // drop history (seek / track change)
+
+    // Upper bound of output frames process() can produce for `inFrames`.
+    int maxOutputFrames(int inFrames) const;
+
+    // Convert `inFrames` stereo frames. Writes at most maxOutputFrames()
+    // frames to `out` and returns how many were produced.
+    int process(const float* in, int inFrames, float* out);
+
+private:
+    void rebuild();
+
+    ResampleQuality quality = RESAMPLE_MEDIUM;
+    int inRate  = 0;
+    int outRate = 0;
+
+    int L = 1;        // interpolation factor (phases)
+    int M = 1;        // decimation factor
+    int taps = 16;
+
+    std::vector<float> phases;   // L * taps, each phase stored oldest→newest
+    std::vector<float> history;  // pending input frames, interleaved stereo
+    int      historyFrames = 0;  // frames in `history`
+    uint64_t phaseAcc = 0;       // output position in units of input/L
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+/* -------------------------------------------------------
+   Lock-free single-producer / single-consumer ring buffer
+   for trivially copyable T.
+
+   - Capacity is chosen at runtime and rounded up to a power
+     of two, so wrapping an index is a mask, not a modulo.
+   - Indices run freely (never wrapped) — used = head - tail.
+   - Every transfer is at most two memcpy spans.
+   - head and tail sit on separate cache lines so the producer
+     and consumer cores don't false-share.
+
+   write() may only be called from the producer thread,
+   read()/peek()/skip() only from the consumer thread.
+   init() and reset() need both sides idle.
+------------------------------------------------------- */
+template <typename T>
+class RingBuffer
+{
+public:
+    RingBuffer() = default;
+    explicit RingBuffer(size_t minCapacity) { init(minCapacity); }
+    ~RingBuffer() { delete[] data; }
+
+    RingBuffer(const RingBuffer&)            = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // (Re)allocate for at least minCapacity elements. Drops all content.
+    bool init(size_t minCapacity)
+    {
+        size_t cap = 16;
+        while (cap < minCapacity)
+            cap <<= 1;
+
+        if (cap != capacity_)
+        {
+            delete[] data;
+            data = new (std::nothrow) T[cap];
+            if (!data)
+            {
+                capacity_ = 0;
+                mask      = 0;
+                return false;
+            }
+            capacity_ = cap;
+            mask      = cap - 1;
+        }
+        reset();
+        return true;
+    }
+
+    void reset()
+    {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    size_t availableRead() const
+    {
+        return head.load(std::memory_order_acquire) -
+               tail.load(std::memory_order_acquire);
+    }
+
+    size_t availableWrite() const { return capacity_ - availableRead(); }
+
+    // Producer: copy up to `count` elements in; returns how many fit.
+    size_t write(const T* src, size_t count)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+
+        count = std::min(count, capacity_ - (h - t));
+        if (count == 0)
+            return 0;
+
+        size_t start = h & mask;
+        size_t first = std::min(count, capacity_ - start);
+        memcpy(data + start, src, first * sizeof(T));
+        if (count > first)
+            memcpy(data, src + first, (count - first) * sizeof(T));
+
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: copy up to `count` elements out without consuming them.
+    size_t peek(T* dst, size_t count) const
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+
+        count = std::min(count, h - t);
+        if (count == 0)
+            return 0;
+
+        size_t start = t & mask;
+        size_t first = std::min(count, capacity_ - start);
+        memcpy(dst, data + start, first * sizeof(T));
+        if (count > first)
+            memcpy(dst + first, data, (count - first) * sizeof(T));
+        return count;
+    }
+
+    // Consumer: discard up to `count` elements.
+    size_t skip(size_t count)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+
+        count = std::min(count, h - t);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: copy up to `count` elements out and consume them.
+    size_t read(T* dst, size_t count)
+    {
+        count = peek(dst, count);
+        tail.store(tail.load(std::memory_order_relaxed) + count,
+                   std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: drop everything currently queued.
+    void clear() { skip(availableRead()); }
+
+private:
+    T*     data      = nullptr;
+    size_t capacity_ = 0;
+    size_t mask      = 0;
+
+    alignas(64) std::atomic<size_t> head{0};   // written by producer
+    alignas(64) std::atomic<size_t> tail{0};   // written by consumer
+    char pad[64 - sizeof(std::atomic<size_t>)]; // keep tail's line to itself
+};
@@ -0,0 +1,299 @@
+#include "scanpool.h"
+#include "metacache.h"
+#include <switch.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#ifndef __SWITCH__
+#include <thread>
+#endif
+
+#define SCANPOOL_THREAD_STACK 0x4000
+#define SCANPOOL_THREAD_PRIO  0x2D    // below the main thread (0x2C) — a scan
+                                      // burst must never cost a rendered frame
+
+/* -------------------------------------------------------
+   Job types
+------------------------------------------------------- */
+typedef void (*ScanJobFn)(const ScanJob& job);
+
+struct ScanJobTypeInfo
+{
+    const char* name;
+    ScanJobFn   run;
+};
+
+static const ScanJobTypeInfo g_jobTypes[SCAN_JOB_TYPE_COUNT] = {
+    { "MP3",      mp3ScanFastJob     },
+    { "MP3 full", mp3ScanAccurateJob },
+    { "MP3 idx",  mp3ScanIndexJob    },
+    { "FLAC",     flacScanJob        },
+    { "FLAC idx", flacSeekJob        },
+    { "OGG",      oggScanJob         },
+    { "WAV",      wavScanJob         },
+};
+
+/* -------------------------------------------------------
+   Pool state
+------------------------------------------------------- */
+struct ScanWorker
+{
+#ifdef __SWITCH__
+    Thread              thread;
+#else
+    std::thread         thread;
+#endif
+    int                 index = 0;
+    std::mutex          mutex;     // guards jobs only
+    std::deque<ScanJob> jobs;
+};
+
+struct ScanBatchStats
+{
+    u64      startTicks = 0;
+    uint32_t jobs[SCAN_JOB_TYPE_COUNT]  = {};
+    u64      ticks[SCAN_JOB_TYPE_COUNT] = {};   // summed across workers
+};
+
+static ScanWorker           g_spWorkers[SCANPOOL_MAX_WORKERS];
+static int                  g_spWorkerCount = 0;       // written under g_spMutex once started
+static bool                 g_spStarted     = false;   // ditto
+
+static std::mutex              g_spMutex;   // sleep/wake, batch stats, started/count
+static std::condition_variable g_spWake;
+static bool                    g_spQuit = false;
+static std::atomic<int>        g_spPending{0};   // queued, not yet popped
+static std::atomic<int>        g_spRunning{0};   // popped, not yet finished
+static std::atomic<uint32_t>   g_spEpoch{1};     // current token value
+static unsigned                g_spNextWorker = 0;
+static bool                    g_spBatchOpen  = false;
+static ScanBatchStats          g_spBatch;
+
+/* -------------------------------------------------------
+   Deques
+------------------------------------------------------- */
+static bool popOwn(ScanWorker& w, ScanJob& out)
+{
+    std::lock_guard<std::mutex> lock(w.mutex);
+    if (w.jobs.empty()) return false;
+    out = w.jobs.front();
+    w.jobs.pop_front();
+    g_spRunning.fetch_add(1);   // before pending drops, so the pool never looks idle
+    g_spPending.fetch_sub(1);
+    return true;
+}
+
+// Take from the far end of someone else's deque, so the owner
+// keeps working through its own jobs in order
+static bool steal(int thief, ScanJob& out)
+{
+    for (int i = 1; i < g_spWorkerCount; i++)
+    {
+        ScanWorker& victim = g_spWorkers[(thief + i) % g_spWorkerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) continue;
+        out = victim.jobs.back();
+        victim.jobs.pop_back();
+        g_spRunning.fetch_add(1);
+        g_spPending.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+static void logBatch(const ScanBatchStats& b)
+{
+    uint32_t total = 0;
+    for (int t = 0; t < SCAN_JOB_TYPE_COUNT; t++) total += b.jobs[t];
+    if (total == 0) return;
+
+    double sec = (svcGetSystemTick() - b.startTicks) / 19200000.0;
+    printf("[SCAN] %u jobs in %.2f s on %d workers (%.1f jobs/s)\n",
+           total, sec, g_spWorkerCount, sec > 0.0 ? total / sec : 0.0);
+
+    for (int t = 0; t < SCAN_JOB_TYPE_COUNT; t++)
+    {
+        if (!b.jobs[t]) continue;
+        printf("[SCAN]   %-8s %6u  avg %.2f ms\n", g_jobTypes[t].name, b.jobs[t],
+               b.ticks[t] / 19200.0 / b.jobs[t]);
+    }
+}
+
+/* -------------------------------------------------------
+   Worker
+------------------------------------------------------- */
+static void scanWorkerMain(void* arg)
+{
+    ScanWorker& self = *(ScanWorker*)arg;
+
+    while (true)
+    {
+        ScanJob job;
+        if (popOwn(self, job) || steal(self.index, job))
+        {
+            if (!scanJobCanceled(job))
+            {
+                u64 t0 = svcGetSystemTick();
+                g_jobTypes[job.type].run(job);
+                u64 dt = svcGetSystemTick() - t0;
+
+                std::lock_guard<std::mutex> lock(g_spMutex);
+                g_spBatch.jobs[job.type]++;
+                g_spBatch.ticks[job.type] += dt;
+            }
+
+            g_spRunning.fetch_sub(1);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(g_spMutex);
+        if (g_spQuit) break;
+
+        // Last one out closes the batch
+        if (g_spPending.load() == 0 && g_spRunning.load() == 0 && g_spBatchOpen)
+        {
+            g_spBatchOpen = false;
+            ScanBatchStats done = g_spBatch;
+            lock.unlock();
+
+            logBatch(done);
+            metaCacheFlush(); // idle — persist whatever this batch produced
+
+            lock.lock();
+        }
+
+        g_spWake.wait(lock, [] { return g_spQuit || g_spPending.load() > 0; });
+        if (g_spQuit) break;
+    }
+}
+
+/* -------------------------------------------------------
+   Public API
+------------------------------------------------------- */
+void scanPoolStart(int workers)
+{
+    if (g_spStarted) return;
+
+    if (workers <= 0)
+    {
+#ifdef __SWITCH__
+        workers = SCANPOOL_MAX_WORKERS;
+#else
+        workers = (int)std::thread::hardware_concurrency();
+#endif
+    }
+    if (workers < 1) workers = 1;
+    if (workers > SCANPOOL_MAX_WORKERS) workers = SCANPOOL_MAX_WORKERS;
+
+    g_spQuit = false;
+    g_spWorkerCount = 0;
+
+    for (int i = 0; i < workers; i++)
+    {
+        ScanWorker& w = g_spWorkers[i];
+        w.index = i;
+#ifdef __SWITCH__
+        // One worker per core; they run below the main, decode and
+        // read-ahead threads, so they only soak up idle time there.
+        Result rc = threadCreate(&w.thread, scanWorkerMain, &w, nullptr,
+                                 SCANPOOL_THREAD_STACK, SCANPOOL_THREAD_PRIO, i);
+        if (R_FAILED(rc))
+        {
+            printf("[SCAN] threadCreate failed for worker %d (0x%x)\n", i, rc);
+            break;
+        }
+        threadStart(&w.thread);
+#else
+        w.thread = std::thread(scanWorkerMain, &w);
+#endif
+        g_spWorkerCount++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_spMutex);
+        g_spStarted = g_spWorkerCount > 0;
+    }
+    printf("[SCAN] Pool started with %d workers\n", g_spWorkerCount);
+}
+
+void scanPoolStop()
+{
+    int workers;
+    {
+        // Submitters check the flag under this lock, so none can queue
+        // onto a worker that is about to go away
+        std::lock_guard<std::mutex> lock(g_spMutex);
+        if (!g_spStarted) return;
+        g_spStarted = false;
+        g_spQuit    = true;
+        workers     = g_spWorkerCount;
+    }
+
+    scanPoolCancelAll();
+    g_spWake.notify_all();
+
+    for (int i = 0; i < workers; i++)
+    {
+#ifdef __SWITCH__
+        threadWaitForExit(&g_spWorkers[i].thread);
+        threadClose(&g_spWorkers[i].thread);
+#else
+        g_spWorkers[i].thread.join();
+#endif
+    }
+
+    std::lock_guard<std::mutex> lock(g_spMutex);
+    g_spWorkerCount = 0;
+}
+
+ScanToken scanPoolToken()
+{
+    return g_spEpoch.load();
+}
+
+bool scanJobCanceled(const ScanJob& job)
+{
+    return job.token != g_spEpoch.load();
+}
+
+void scanPoolCancelAll()
+{
+    g_spEpoch.fetch_add(1);
+
+    for (int i = 0; i < g_spWorkerCount; i++)
+    {
+        ScanWorker& w = g_spWorkers[i];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        g_spPending.fetch_sub((int)w.jobs.size());
+        w.jobs.clear();
+    }
+}
+
+void scanPoolSubmit(TrackId id, ScanJobType type, ScanToken token)
+{
+    if (type >= SCAN_JOB_TYPE_COUNT) return;
+
+    ScanJob job{ id, type, token };
+
+    // The decode thread submits too, and may race scanPoolStop()
+    std::lock_guard<std::mutex> lock(g_spMutex);
+    if (!g_spStarted || g_spWorkerCount == 0) return;
+
+    ScanWorker& w = g_spWorkers[g_spNextWorker++ % g_spWorkerCount];
+    {
+        std::lock_guard<std::mutex> wl(w.mutex);
+        w.jobs.push_back(job);
+        g_spPending.fetch_add(1);
+    }
+
+    if (!g_spBatchOpen)
+    {
+        g_spBatchOpen = true;
+        g_spBatch = ScanBatchStats{};
+        g_spBatch.startTicks = svcGetSystemTick();
+    }
+
+    g_spWake.notify_one();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "tracktable.h"
+#include <stdint.h>
+
+/* -------------------------------------------------------
+   Metadata scanner pool
+   One shared set of worker threads scans every format,
+   replacing the four per-format scanner threads that each
+   polled their own queue every 50 ms.
+
+   - Each worker owns a deque. Submitted jobs are dealt out
+     round-robin; a worker pops its own deque from the front
+     (playlist order) and, when it runs dry, steals from the
+     back of another worker's. A folder of one format keeps
+     every worker busy.
+   - Idle workers sleep on a condition variable; a submit
+     wakes one. Nothing polls.
+   - Jobs carry a cancellation token. scanPoolCancelAll()
+     revokes every outstanding token and drops queued work;
+     jobs already running are told via scanJobCanceled().
+   - When the pool drains, the metadata journal is flushed
+     and the batch's throughput is logged per job type.
+------------------------------------------------------- */
+#define SCANPOOL_MAX_WORKERS 3    // the Switch gives applications three cores
+
+// Job types — one reader per format (MP3 has a second,
+// slower pass for files whose fast duration is suspect, and
+// MP3 and FLAC each have a seek-index pass queued on first play)
+enum ScanJobType : uint8_t
+{
+    SCAN_JOB_MP3_FAST,
+    SCAN_JOB_MP3_ACCURATE,
+    SCAN_JOB_MP3_INDEX,
+    SCAN_JOB_FLAC,
+    SCAN_JOB_FLAC_SEEK,
+    SCAN_JOB_OGG,
+    SCAN_JOB_WAV,
+    SCAN_JOB_TYPE_COUNT
+};
+
+typedef uint32_t ScanToken;
+
+struct ScanJob
+{
+    TrackId     id;
+    ScanJobType type;
+    ScanToken   token;
+};
+
+// workers <= 0 starts one per available core
+void scanPoolStart(int workers);
+void scanPoolStop();
+
+// Token for new work; revoked by the next scanPoolCancelAll()
+ScanToken scanPoolToken();
+void      scanPoolCancelAll();
+bool      scanJobCanceled(const ScanJob& job);
+
+void scanPoolSubmit(TrackId id, ScanJobType type, ScanToken token);
+
+/* -------------------------------------------------------
+   Job readers (implemented by each format module)
+------------------------------------------------------- */
+void mp3ScanFastJob(const ScanJob& job);
+void mp3ScanAccurateJob(const ScanJob& job);
+void mp3ScanIndexJob(const ScanJob& job);
+void flacScanJob(const ScanJob& job);
+void flacSeekJob(const ScanJob& job);
+void oggScanJob(const ScanJob& job);
+void wavScanJob(const ScanJob& job);
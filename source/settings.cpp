@@ -2,6 +2,7 @@
 #include "settings_state.h"
 #include "ui.h"
 #include "eq.h"
+#include "spectrum.h"
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdio.h>
@@ -19,7 +20,7 @@
 #define S_MARGIN_TOP   400   // blank at top of screen     = high FB X margin
 #define S_HDR_H          80   // "// SELECT FILES [<][>]" header
 #define S_TITLE_H       80   // "// SETTINGS" title row
-#define S_ROW_H        160   // each setting row height
+#define S_ROW_H        140   // each setting row height
 #define S_GAP            8   // gap between rows
 #define S_HINT_H        70   // hint row at bottom of screen
 #define S_SAVE_H       120   // "Save Settings" + "Back" rows
@@ -31,6 +32,9 @@
 #define ADD_BTN_H         70   // button height in FB-X = screen vertical size
 #define ADD_BTN_MARGIN    10   // gap from right edge
 
+// 2 px per bar in the 306 px analyser
+#define SETTINGS_SPECTRUM_BARS_MAX 150
+
 /* ============================================================
    COLOURS (SDL_Color inline — same style as filebrowser)
 ============================================================ */
@@ -61,7 +65,11 @@ PlayerSettings g_settings =
     false,           // crossfadeEnabled
     3.0f,            // crossfadeSeconds
     false,           // autoGainEnabled
-    REPLAYGAIN_TRACK // replayGainMode
+    REPLAYGAIN_TRACK, // replayGainMode
+    RESAMPLE_MEDIUM, // resampleQuality
+    true,            // scrubPreview
+    1024,            // spectrumFftSize
+    SPECTRUM_BARS_DEFAULT  // spectrumBars
 };
 
 void settingsOpen()  { g_settingsOpen = true; }
@@ -88,17 +96,29 @@ static void settingsSave()
         (g_settings.replayGainMode == REPLAYGAIN_TRACK) ? "TRACK" :
         (g_settings.replayGainMode == REPLAYGAIN_ALBUM) ? "ALBUM" : "OFF";
 
+    const char* resampleStr =
+        (g_settings.resampleQuality == RESAMPLE_HIGH) ? "HIGH" :
+        (g_settings.resampleQuality == RESAMPLE_LOW)  ? "LOW"  : "MEDIUM";
+
     fprintf(f,
         "{\n"
         "  \"crossfadeEnabled\": %s,\n"
         "  \"crossfadeSeconds\": %.1f,\n"
         "  \"autoGainEnabled\": %s,\n"
-        "  \"replayGainMode\": \"%s\"\n"
+        "  \"replayGainMode\": \"%s\",\n"
+        "  \"resampleQuality\": \"%s\",\n"
+        "  \"scrubPreview\": %s,\n"
+        "  \"spectrumFftSize\": %d,\n"
+        "  \"spectrumBars\": %d\n"
         "}\n",
         g_settings.crossfadeEnabled ? "true" : "false",
         g_settings.crossfadeSeconds,
         g_settings.autoGainEnabled  ? "true" : "false",
-        replayGainStr
+        replayGainStr,
+        resampleStr,
+        g_settings.scrubPreview     ? "true" : "false",
+        g_settings.spectrumFftSize,
+        g_settings.spectrumBars
     );
 
     fclose(f);
@@ -167,6 +187,29 @@ void settingsHandleInput(PadState* pad)
                 g_settings.autoGainEnabled = !g_settings.autoGainEnabled;
                 break;
 
+            case SETTING_RESAMPLER:
+                g_settings.resampleQuality =
+                    (ResampleQuality)((g_settings.resampleQuality + 1) % 3);
+                break;
+
+            case SETTING_SCRUBPREVIEW:
+                g_settings.scrubPreview = !g_settings.scrubPreview;
+                break;
+
+            case SETTING_SPECTRUM_FFT:
+                // 512 → 1024 → … → 8192 → 512
+                g_settings.spectrumFftSize *= 2;
+                if (g_settings.spectrumFftSize > SPECTRUM_FFT_MAX)
+                    g_settings.spectrumFftSize = SPECTRUM_FFT_MIN;
+                break;
+
+            case SETTING_SPECTRUM_BARS:
+                // 10 → 20 → … → 150 → 10
+                g_settings.spectrumBars += SPECTRUM_BARS_STEP;
+                if (g_settings.spectrumBars > SETTINGS_SPECTRUM_BARS_MAX)
+                    g_settings.spectrumBars = SPECTRUM_BARS_MIN;
+                break;
+
             case SETTING_SAVESETTINGS:
                 settingsSave();
                 settingsClose();
@@ -208,6 +251,28 @@ void settingsHandleInput(PadState* pad)
                     g_settings.replayGainMode = REPLAYGAIN_OFF;
             }
         }
+        else if(g_selectedItem == SETTING_RESAMPLER)
+        {
+            // Left/Right steps the resampler quality tier
+            int q = (int)g_settings.resampleQuality + ((down & HidNpadButton_Right) ? 1 : -1);
+            g_settings.resampleQuality = (ResampleQuality)((q + 3) % 3);
+        }
+        else if(g_selectedItem == SETTING_SPECTRUM_FFT)
+        {
+            // Left/Right halves/doubles the FFT size, clamped
+            if(down & HidNpadButton_Right) g_settings.spectrumFftSize *= 2;
+            else                           g_settings.spectrumFftSize /= 2;
+            if(g_settings.spectrumFftSize < SPECTRUM_FFT_MIN) g_settings.spectrumFftSize = SPECTRUM_FFT_MIN;
+            if(g_settings.spectrumFftSize > SPECTRUM_FFT_MAX) g_settings.spectrumFftSize = SPECTRUM_FFT_MAX;
+        }
+        else if(g_selectedItem == SETTING_SPECTRUM_BARS)
+        {
+            // Left/Right steps the bar count, clamped
+            if(down & HidNpadButton_Right) g_settings.spectrumBars += SPECTRUM_BARS_STEP;
+            else                           g_settings.spectrumBars -= SPECTRUM_BARS_STEP;
+            if(g_settings.spectrumBars < SPECTRUM_BARS_MIN)          g_settings.spectrumBars = SPECTRUM_BARS_MIN;
+            if(g_settings.spectrumBars > SETTINGS_SPECTRUM_BARS_MAX) g_settings.spectrumBars = SETTINGS_SPECTRUM_BARS_MAX;
+        }
     }
 }
 
@@ -373,6 +438,10 @@ void settingsRender(SDL_Renderer* renderer, TTF_Font* font)
         { SETTING_CROSSFADE_TIME,   "Crossfade Time", false, false },
         { SETTING_REPLAYGAIN,       "ReplayGain",     false, false },
         { SETTING_AUTOGAIN,         "Auto Gain",      false, false },
+        { SETTING_RESAMPLER,        "Resampler",      false, false },
+        { SETTING_SCRUBPREVIEW,     "Scrub Preview",  false, false },
+        { SETTING_SPECTRUM_FFT,     "Spectrum FFT",   false, false },
+        { SETTING_SPECTRUM_BARS,    "Spectrum Bars",  false, false },
     };
 
     for(auto& sr : srows)
@@ -464,6 +533,47 @@ void settingsRender(SDL_Renderer* renderer, TTF_Font* font)
                         }
                     }
                     break;
+
+                case SETTING_RESAMPLER:
+                    {
+                        const char* m="MEDIUM";
+                        if(g_settings.resampleQuality==RESAMPLE_LOW)  m="LOW";
+                        if(g_settings.resampleQuality==RESAMPLE_HIGH) m="HIGH";
+                        sRowValue(renderer, font, m, x, rowH, SC_GREEN_DIM, 30);
+                    }
+                    break;
+
+                case SETTING_SCRUBPREVIEW:
+                    {
+                        // Toggle box
+                        const int BW=100, BH=100;
+                        int by = FBH - BW - 20;
+                        int bx = x + (rowH - BH)/2;
+                        SDL_Color bbg = g_settings.scrubPreview
+                                      ? SDL_Color{0,120,0,255}
+                                      : SDL_Color{35,35,35,255};
+                        SDL_Color bbr = g_settings.scrubPreview
+                                      ? SC_GREEN : SC_BRD_DIM;
+                        SDL_Rect box={bx,by,BH,BW};
+                        sDrawBox(renderer, box, bbg, bbr, 2);
+                    }
+                    break;
+
+                case SETTING_SPECTRUM_FFT:
+                    {
+                        char v[16];
+                        snprintf(v, sizeof(v), "%d", g_settings.spectrumFftSize);
+                        sRowValue(renderer, font, v, x, rowH, SC_GREEN_DIM, 30);
+                    }
+                    break;
+
+                case SETTING_SPECTRUM_BARS:
+                    {
+                        char v[16];
+                        snprintf(v, sizeof(v), "%d", g_settings.spectrumBars);
+                        sRowValue(renderer, font, v, x, rowH, SC_GREEN_DIM, 30);
+                    }
+                    break;
             }
         }
     }
@@ -6,6 +6,10 @@ enum SettingsItems
     SETTING_CROSSFADE_TIME,
     SETTING_REPLAYGAIN,
     SETTING_AUTOGAIN,
+    SETTING_RESAMPLER,
+    SETTING_SCRUBPREVIEW,
+    SETTING_SPECTRUM_FFT,
+    SETTING_SPECTRUM_BARS,
     SETTING_SAVESETTINGS,
     SETTING_BACK,
     SETTINGS_COUNT
@@ -18,12 +22,23 @@ enum ReplayGainMode
     REPLAYGAIN_ALBUM
 };
 
+enum ResampleQuality
+{
+    RESAMPLE_LOW = 0,
+    RESAMPLE_MEDIUM,
+    RESAMPLE_HIGH
+};
+
 struct PlayerSettings
 {
     bool crossfadeEnabled;
     float crossfadeSeconds;
     bool autoGainEnabled;
     ReplayGainMode replayGainMode;
+    ResampleQuality resampleQuality;
+    bool scrubPreview;      // play snippets while dragging the progress bar
+    int  spectrumFftSize;   // analyser FFT points, 512..8192
+    int  spectrumBars;      // analyser bars, 10..150 in steps of 10
 };
 
 
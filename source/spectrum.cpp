@@ -0,0 +1,270 @@
+#include "spectrum.h"
+#include "kiss_fftr.h"
+#include <switch.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SPECTRUM_NEON 1
+#elif defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define SPECTRUM_SSE 1
+#endif
+
+#define SPECTRUM_MIN_FREQ  20.0f
+#define SPECTRUM_SMOOTHING 0.18f   // per 60 Hz frame
+#define SPECTRUM_GAIN_DECAY 0.995f  // per bar, per 60 Hz frame
+
+/* -------------------------------------------------------
+   Engine state (UI thread)
+------------------------------------------------------- */
+struct SpectrumEngine
+{
+    int            sampleRate = 0;
+    int            fftSize    = 0;
+    int            bars       = 0;
+    SpectrumWindow window     = SPECTRUM_WINDOW_HANN;
+
+    kiss_fftr_cfg             cfg = nullptr;
+    std::vector<float>        coeffs;     // window, fftSize
+    std::vector<float>        windowed;   // fftSize
+    std::vector<kiss_fft_cpx> spectrum;   // fftSize / 2 + 1
+    std::vector<float>        mag;        // fftSize / 2 + 1
+
+    // Per bar, fixed until the next configure
+    std::vector<int>   bin0;      // first bin
+    std::vector<int>   binCount;  // bins summed
+    std::vector<float> boost;     // bass boost * 0.9
+
+    std::vector<float> smooth;    // smoothed output
+    float              autoGain = 1.0f;
+};
+
+static SpectrumEngine       g_se;
+static std::atomic<bool>    g_seResetPending{false};
+static SpectrumEngineStats  g_seStats;
+
+/* -------------------------------------------------------
+   Tables
+------------------------------------------------------- */
+static void buildWindow(std::vector<float>& w, int n, SpectrumWindow type)
+{
+    w.resize(n);
+    const double k = 2.0 * M_PI / (n - 1);
+    for (int i = 0; i < n; i++)
+    {
+        if (type == SPECTRUM_WINDOW_BLACKMAN)
+            w[i] = (float)(0.42 - 0.5 * cos(k * i) + 0.08 * cos(2.0 * k * i));
+        else
+            w[i] = (float)(0.5 - 0.5 * cos(k * i));
+    }
+}
+
+// Log-spaced bars from 20 Hz to Nyquist; each bar sums the bins from
+// its lower edge to its upper edge inclusive, and gets at least two
+static void buildBands(SpectrumEngine& e)
+{
+    const int   maxBin  = e.fftSize / 2 - 1;
+    const float maxFreq = e.sampleRate / 2.0f;
+    const float ratio   = maxFreq / SPECTRUM_MIN_FREQ;
+
+    e.bin0.resize(e.bars);
+    e.binCount.resize(e.bars);
+    e.boost.resize(e.bars);
+
+    for (int b = 0; b < e.bars; b++)
+    {
+        float f0 = SPECTRUM_MIN_FREQ * powf(ratio, (float)b / e.bars);
+        float f1 = SPECTRUM_MIN_FREQ * powf(ratio, (float)(b + 1) / e.bars);
+
+        int lo = (int)(f0 * e.fftSize / e.sampleRate);
+        int hi = (int)(f1 * e.fftSize / e.sampleRate);
+        if (lo < 0) lo = 0;
+        if (hi > maxBin) hi = maxBin;
+        if (hi <= lo) hi = lo + 1;
+
+        e.bin0[b]     = lo;
+        e.binCount[b] = hi - lo + 1;
+        e.boost[b]    = (1.0f + (float)(e.bars - b) / e.bars) * 0.9f;
+    }
+}
+
+void spectrumEngineConfigure(int sampleRate, int fftSize, int bars, SpectrumWindow window)
+{
+    int n = SPECTRUM_FFT_MIN;
+    while (n < fftSize && n < SPECTRUM_FFT_MAX) n <<= 1;
+    if (bars < 1) bars = 1;
+    if (bars > SPECTRUM_MAX_BARS) bars = SPECTRUM_MAX_BARS;
+    if (sampleRate <= 0) sampleRate = 48000;
+
+    SpectrumEngine& e = g_se;
+    if (e.cfg && e.sampleRate == sampleRate && e.fftSize == n &&
+        e.bars == bars && e.window == window)
+        return;
+
+    if (e.fftSize != n || !e.cfg)
+    {
+        if (e.cfg) kiss_fftr_free(e.cfg);
+        e.cfg = kiss_fftr_alloc(n, 0, nullptr, nullptr);
+        e.windowed.assign(n, 0.0f);
+        e.spectrum.resize(n / 2 + 1);
+        e.mag.assign(n / 2 + 1, 0.0f);
+    }
+    if (e.fftSize != n || e.window != window)
+        buildWindow(e.coeffs, n, window);
+
+    e.sampleRate = sampleRate;
+    e.fftSize    = n;
+    e.bars       = bars;
+    e.window     = window;
+    buildBands(e);
+    e.smooth.assign(bars, 0.0f);
+    e.autoGain = 1.0f;
+
+    printf("[SPECTRUM] %d-point FFT at %d Hz, %d bars, %s window\n", n, sampleRate, bars,
+           window == SPECTRUM_WINDOW_BLACKMAN ? "Blackman" : "Hann");
+}
+
+int spectrumEngineFftSize()
+{
+    return g_se.fftSize;
+}
+
+int spectrumEngineBars()
+{
+    return g_se.bars;
+}
+
+/* -------------------------------------------------------
+   Per-frame kernels
+------------------------------------------------------- */
+static void applyWindow(const float* in, const float* w, float* out, int n)
+{
+    int i = 0;
+#if defined(SPECTRUM_NEON)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(out + i, vmulq_f32(vld1q_f32(in + i), vld1q_f32(w + i)));
+#elif defined(SPECTRUM_SSE)
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), _mm_loadu_ps(w + i)));
+#endif
+    for (; i < n; i++)
+        out[i] = in[i] * w[i];
+}
+
+// |X[k]| for interleaved (re, im) pairs
+static void magnitudes(const kiss_fft_cpx* x, float* out, int n)
+{
+    const float* p = (const float*)x;
+    int i = 0;
+#if defined(SPECTRUM_NEON)
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4x2_t v = vld2q_f32(p + i * 2);
+        float32x4_t   s = vmlaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+        vst1q_f32(out + i, vsqrtq_f32(s));
+    }
+#elif defined(SPECTRUM_SSE)
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a  = _mm_loadu_ps(p + i * 2);       // r0 i0 r1 i1
+        __m128 b  = _mm_loadu_ps(p + i * 2 + 4);   // r2 i2 r3 i3
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 s  = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(s));
+    }
+#endif
+    for (; i < n; i++)
+        out[i] = sqrtf(p[i * 2] * p[i * 2] + p[i * 2 + 1] * p[i * 2 + 1]);
+}
+
+static float sumRange(const float* p, int n)
+{
+    int   i   = 0;
+    float sum = 0.0f;
+#if defined(SPECTRUM_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4)
+        acc = vaddq_f32(acc, vld1q_f32(p + i));
+    sum = vaddvq_f32(acc);
+#elif defined(SPECTRUM_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_loadu_ps(p + i));
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+/* -------------------------------------------------------
+   Run
+------------------------------------------------------- */
+void spectrumEngineRun(const float* samples, float* bars, int steps)
+{
+    SpectrumEngine& e = g_se;
+    if (!e.cfg || !samples || !bars) return;
+    if (steps < 1) steps = 1;
+
+    u64 t0 = svcGetSystemTick();
+
+    if (g_seResetPending.exchange(false))
+    {
+        e.smooth.assign(e.bars, 0.0f);
+        e.autoGain = 1.0f;
+    }
+
+    applyWindow(samples, e.coeffs.data(), e.windowed.data(), e.fftSize);
+    kiss_fftr(e.cfg, e.windowed.data(), e.spectrum.data());
+    magnitudes(e.spectrum.data(), e.mag.data(), e.fftSize / 2);
+
+    // `steps` 60 Hz frames of release and easing in one go
+    const float decay  = powf(SPECTRUM_GAIN_DECAY, (float)steps);
+    const float smooth = 1.0f - powf(1.0f - SPECTRUM_SMOOTHING, (float)steps);
+
+    for (int b = 0; b < e.bars; b++)
+    {
+        float avg = sumRange(&e.mag[e.bin0[b]], e.binCount[b]) / e.binCount[b];
+
+        avg = log10f(avg + 1.0f) * 0.9f;
+
+        // automatic gain control
+        if (avg > e.autoGain)
+            e.autoGain = avg;
+        else
+            e.autoGain *= decay;
+
+        avg /= (e.autoGain + 0.0001f);
+        if (avg > 1.0f) avg = 1.0f;
+        if (avg < 0.0f) avg = 0.0f;
+
+        avg *= e.boost[b];
+        if (avg > 1.0f) avg = 1.0f;
+
+        e.smooth[b] += (avg - e.smooth[b]) * smooth;
+        bars[b] = e.smooth[b];
+    }
+
+    g_seStats.runs++;
+    g_seStats.ticks += svcGetSystemTick() - t0;
+}
+
+void spectrumEngineReset()
+{
+    g_seResetPending.store(true);
+}
+
+SpectrumEngineStats spectrumEngineTakeStats()
+{
+    SpectrumEngineStats s = g_seStats;
+    g_seStats = SpectrumEngineStats{};
+    return s;
+}
@@ -1,5 +1,61 @@
 #pragma once
+#include <stdint.h>
 
-#define SPECTRUM_BARS 20
+/* -------------------------------------------------------
+   Spectrum engine
+   Turns a window of output samples into smoothed 0..1 bar
+   values. Everything that depends only on the sample
+   rate, FFT size, bar count or window shape — the window
+   coefficients, each bar's FFT bin range, the per-bar
+   weights — is built by spectrumEngineConfigure() when one
+   of those changes, so a frame is: window multiply, FFT,
+   magnitudes, one contiguous sum per bar (the multiply,
+   magnitude and sum loops are NEON/SSE with a scalar
+   tail), then gain and smoothing.
 
-extern float bandValues[SPECTRUM_BARS];
+   Bars are log-spaced from 20 Hz to Nyquist of the rate the
+   samples were taken at — the output rate, since the tap
+   sits after the resampler.
+------------------------------------------------------- */
+#define SPECTRUM_FFT_MIN     512
+#define SPECTRUM_FFT_MAX     8192
+#define SPECTRUM_FFT_DEFAULT 1024
+#define SPECTRUM_MAX_BARS    256   // bandValues is sized for this
+#define SPECTRUM_BARS_MIN    10    // one per EQ band, for auto-EQ
+#define SPECTRUM_BARS_STEP   10
+#define SPECTRUM_BARS_DEFAULT 20
+
+// Latest bar values, lowest frequency first; spectrumEngineBars() are live
+extern float bandValues[SPECTRUM_MAX_BARS];
+
+enum SpectrumWindow
+{
+    SPECTRUM_WINDOW_HANN = 0,
+    SPECTRUM_WINDOW_BLACKMAN
+};
+
+struct SpectrumEngineStats
+{
+    uint32_t runs  = 0;
+    uint64_t ticks = 0;   // spent in spectrumEngineRun()
+};
+
+// Rebuilds the tables if anything differs from the current setup.
+// fftSize is rounded to a power of two in [SPECTRUM_FFT_MIN, SPECTRUM_FFT_MAX].
+void spectrumEngineConfigure(int sampleRate, int fftSize, int bars, SpectrumWindow window);
+
+int spectrumEngineFftSize();
+int spectrumEngineBars();
+
+// Analyses the newest spectrumEngineFftSize() samples (mono,
+// oldest first) into bars[0..bars), lowest frequency first.
+// steps is the number of 60 Hz frames since the last run; smoothing
+// and gain release advance by that many, so they keep their speed
+// whatever the render rate.
+void spectrumEngineRun(const float* samples, float* bars, int steps);
+
+// Forget smoothing and gain history (new track, stop)
+void spectrumEngineReset();
+
+// Counters since the last call, then reset
+SpectrumEngineStats spectrumEngineTakeStats();
@@ -0,0 +1,203 @@
+#include "spectrum_view.h"
+#include <stdio.h>
+#include <atomic>
+#include <vector>
+
+#define SPECTRUM_BAR_GAP   1      // px between bars
+#define SPECTRUM_PEAK_W    2      // px, cap thickness
+#define SPECTRUM_PEAK_HOLD 18     // 60 Hz frames a cap stays put
+#define SPECTRUM_PEAK_GRAV 0.0025f // per 60 Hz frame
+
+/* -------------------------------------------------------
+   State
+------------------------------------------------------- */
+struct PeakCap
+{
+    float value = 0.0f;   // 0..1
+    float speed = 0.0f;
+    int   hold  = 0;
+};
+
+static SDL_Texture*            g_svRamp      = nullptr;
+static int                     g_svRampWidth = 0;
+static std::vector<PeakCap>    g_svPeaks;
+static std::vector<SDL_Vertex> g_svVerts;
+static std::vector<int>        g_svIndices;
+static std::atomic<bool>       g_svResetPending{false};
+static SpectrumViewStats       g_svStats;
+
+/* -------------------------------------------------------
+   Ramp texture
+------------------------------------------------------- */
+// Colour at fraction t of the bar length: green, through
+// yellow at 3/4, to red at the loud end
+static void rampColor(float t, uint8_t* rgba)
+{
+    if (t < 0.75f)
+    {
+        float k = t / 0.75f;
+        rgba[0] = (uint8_t)(k * 255);
+        rgba[1] = 255;
+    }
+    else
+    {
+        float k = (t - 0.75f) / 0.25f;
+        rgba[0] = 255;
+        rgba[1] = (uint8_t)((1.0f - k) * 255);
+    }
+    rgba[2] = 0;
+    rgba[3] = 255;
+}
+
+static bool bakeRamp(SDL_Renderer* renderer, int width)
+{
+    if (g_svRamp && g_svRampWidth == width) return true;
+    if (g_svRamp) SDL_DestroyTexture(g_svRamp);
+
+    g_svRamp = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                 SDL_TEXTUREACCESS_STATIC, width, 2);
+    if (!g_svRamp)
+    {
+        printf("[UI] Spectrum ramp texture failed: %s\n", SDL_GetError());
+        g_svRampWidth = 0;
+        return false;
+    }
+
+    std::vector<uint8_t> px((size_t)width * 2 * 4);
+    for (int x = 0; x < width; x++)
+    {
+        rampColor((float)x / width, &px[x * 4]);
+        uint8_t* w = &px[(width + x) * 4];
+        w[0] = w[1] = w[2] = w[3] = 255;
+    }
+    SDL_UpdateTexture(g_svRamp, nullptr, px.data(), width * 4);
+    SDL_SetTextureScaleMode(g_svRamp, SDL_ScaleModeNearest);   // one texel per pixel
+    g_svRampWidth = width;
+    return true;
+}
+
+/* -------------------------------------------------------
+   Draw
+------------------------------------------------------- */
+// One 60 Hz frame per step, so the caps move the same at any render rate
+static void updatePeak(PeakCap& p, float v, int steps)
+{
+    for (int s = 0; s < steps; s++)
+    {
+        if (v >= p.value)
+        {
+            p.value = v;
+            p.hold  = SPECTRUM_PEAK_HOLD;
+            p.speed = 0.0f;
+        }
+        else if (p.hold > 0)
+            p.hold--;
+        else
+        {
+            p.speed += SPECTRUM_PEAK_GRAV;
+            p.value -= p.speed;
+            if (p.value < 0.0f) p.value = 0.0f;
+        }
+    }
+}
+
+static void putQuad(SDL_Vertex* v, int* idx, int base,
+                    float x0, float y0, float x1, float y1,
+                    float s0, float s1, float t)
+{
+    const SDL_Color white = {255, 255, 255, 255};
+    v[0] = { {x0, y0}, white, {s0, t} };
+    v[1] = { {x1, y0}, white, {s1, t} };
+    v[2] = { {x1, y1}, white, {s1, t} };
+    v[3] = { {x0, y1}, white, {s0, t} };
+
+    idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+    idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+}
+
+void spectrumViewDraw(SDL_Renderer* renderer, SDL_Rect rect, const float* bands,
+                      int bandCount, int steps)
+{
+    if (!renderer || !bands || rect.w <= 0 || rect.h <= 0) return;
+    if (steps < 1) steps = 1;
+
+    if (bandCount > SPECTRUM_VIEW_MAX_BARS) bandCount = SPECTRUM_VIEW_MAX_BARS;
+    if (bandCount > rect.h / 2)             bandCount = rect.h / 2;
+    if (bandCount <= 0) return;
+
+    if (!bakeRamp(renderer, rect.w)) return;
+
+    if ((int)g_svPeaks.size() != bandCount || g_svResetPending.exchange(false))
+    {
+        g_svPeaks.assign(bandCount, PeakCap{});
+        g_svVerts.resize((size_t)bandCount * 2 * 4);     // bar + cap
+        g_svIndices.resize((size_t)bandCount * 2 * 6);
+    }
+
+    const int   barHeight = rect.h / bandCount;
+    const float invW      = 1.0f / rect.w;
+    const float rowRamp   = 0.25f;   // texel-row centres
+    const float rowWhite  = 0.75f;
+
+    int quads = 0;
+    for (int i = 0; i < bandCount; i++)
+    {
+        // Bass at the top: draw slot i (from the bottom) shows the
+        // highest band first
+        float value = bands[bandCount - 1 - i];
+        if (value < 0.0f) value = 0.0f;
+        if (value > 1.0f) value = 1.0f;
+
+        PeakCap& peak = g_svPeaks[i];
+        updatePeak(peak, value, steps);
+
+        int   filled = (int)(value * rect.w);
+        float y0     = (float)(rect.y + rect.h - (i + 1) * barHeight);
+        float y1     = y0 + barHeight - SPECTRUM_BAR_GAP;
+
+        if (filled > 0)
+        {
+            putQuad(&g_svVerts[quads * 4], &g_svIndices[quads * 6], quads * 4,
+                    (float)rect.x, y0, (float)(rect.x + filled), y1,
+                    0.0f, filled * invW, rowRamp);
+            quads++;
+            g_svStats.legacyCalls += 2 * filled;   // colour + 1 px fill per column
+        }
+
+        float px = (float)(rect.x + (int)(peak.value * rect.w));
+        putQuad(&g_svVerts[quads * 4], &g_svIndices[quads * 6], quads * 4,
+                px, y0, px + SPECTRUM_PEAK_W, y1,
+                0.0f, 1.0f, rowWhite);
+        quads++;
+        g_svStats.legacyCalls += 2;
+    }
+
+    SDL_RenderGeometry(renderer, g_svRamp, g_svVerts.data(), quads * 4,
+                       g_svIndices.data(), quads * 6);
+
+    g_svStats.frames++;
+    g_svStats.drawCalls++;
+    g_svStats.quads += quads;
+}
+
+/* -------------------------------------------------------
+   Lifecycle / stats
+------------------------------------------------------- */
+void spectrumViewReset()
+{
+    g_svResetPending.store(true);
+}
+
+void spectrumViewShutdown()
+{
+    if (g_svRamp) SDL_DestroyTexture(g_svRamp);
+    g_svRamp      = nullptr;
+    g_svRampWidth = 0;
+}
+
+SpectrumViewStats spectrumViewTakeStats()
+{
+    SpectrumViewStats s = g_svStats;
+    g_svStats = SpectrumViewStats{};
+    return s;
+}
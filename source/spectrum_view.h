@@ -0,0 +1,43 @@
+#pragma once
+#include <SDL.h>
+#include <stdint.h>
+
+/* -------------------------------------------------------
+   Spectrum analyser view
+   Draws the vertical bar analyser in one SDL_RenderGeometry
+   call. The colour ramp is baked once into a small texture
+   (row 0: the green→yellow→red gradient, one texel per
+   pixel of bar length; row 1: white for the peak caps), so
+   a bar is a single quad showing the first `filled` texels
+   of the ramp, and its cap is a quad on the white row.
+
+   Any bar count is accepted; the vertex buffers are sized
+   when the count changes, so a frame allocates nothing.
+   Peak caps (hold, then fall with gravity) live here too.
+------------------------------------------------------- */
+#define SPECTRUM_VIEW_MAX_BARS 256
+
+struct SpectrumViewStats
+{
+    uint32_t frames      = 0;
+    uint32_t drawCalls   = 0;   // SDL calls this view made
+    uint32_t quads       = 0;
+    uint32_t legacyCalls = 0;   // what the per-column fill loop would have made
+};
+
+// Clears the peak caps; safe from any thread (applied on the next draw)
+void spectrumViewReset();
+
+// Drops the ramp texture (before the renderer goes)
+void spectrumViewShutdown();
+
+// bands[0] is the lowest frequency and is drawn at the top.
+// Values are 0..1. bandCount may be anything up to
+// SPECTRUM_VIEW_MAX_BARS or rect.h / 2, whichever is smaller.
+// steps is the number of 60 Hz frames since the last draw; the
+// caps' hold and fall advance by that many.
+void spectrumViewDraw(SDL_Renderer* renderer, SDL_Rect rect, const float* bands,
+                      int bandCount, int steps);
+
+// Counters since the last call, then reset
+SpectrumViewStats spectrumViewTakeStats();
@@ -0,0 +1,310 @@
+#include "textatlas.h"
+#include <stdio.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+#define TEXTATLAS_PAD 1   // px between glyphs, so sampling never bleeds
+
+/* -------------------------------------------------------
+   Atlas state
+------------------------------------------------------- */
+struct AtlasGlyph
+{
+    int16_t x = 0, y = 0;   // in the atlas
+    int16_t w = 0, h = 0;   // 0 = nothing to draw (space, missing)
+    int16_t advance = 0;
+};
+
+struct GlyphAtlas
+{
+    TTF_Font*    font    = nullptr;
+    SDL_Texture* texture = nullptr;
+    int          height  = 0;   // TTF_FontHeight
+    int          shelfX  = 0;   // packing: current shelf and pen
+    int          shelfY  = 0;
+    int          shelfH  = 0;
+    std::unordered_map<uint32_t, AtlasGlyph> glyphs;
+};
+
+static GlyphAtlas     g_atlases[TEXTATLAS_MAX_FONTS];
+static int            g_atlasCount = 0;
+static TextAtlasStats g_taStats;
+
+// The prepared string, in string-box coordinates (u along the
+// text, v down from its top); reused so drawing allocates nothing
+struct StagedQuad
+{
+    float u, w, h;     // box: [u, u + w] x [0, h]
+    float s0, t0, s1, t1;
+};
+
+static std::vector<StagedQuad> g_staged;
+static GlyphAtlas*             g_stagedAtlas = nullptr;
+static std::vector<SDL_Vertex> g_verts;
+static std::vector<int>        g_indices;
+
+/* -------------------------------------------------------
+   UTF-8
+------------------------------------------------------- */
+// Next code point; malformed or truncated sequences come back
+// as the single byte, read as ISO-8859-1
+static uint32_t nextCodePoint(const unsigned char*& p)
+{
+    uint32_t c = *p++;
+    if (c < 0x80) return c;
+
+    int extra;
+    uint32_t cp, min;
+    if ((c & 0xE0) == 0xC0)      { extra = 1; cp = c & 0x1F; min = 0x80; }
+    else if ((c & 0xF0) == 0xE0) { extra = 2; cp = c & 0x0F; min = 0x800; }
+    else if ((c & 0xF8) == 0xF0) { extra = 3; cp = c & 0x07; min = 0x10000; }
+    else return c;
+
+    const unsigned char* q = p;
+    for (int i = 0; i < extra; i++)
+    {
+        if ((q[i] & 0xC0) != 0x80) return c;   // also stops at the terminator
+        cp = (cp << 6) | (q[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp < 0xE000)) return c;
+
+    p += extra;
+    return cp;
+}
+
+/* -------------------------------------------------------
+   Atlas
+------------------------------------------------------- */
+static void atlasClear(GlyphAtlas& a)
+{
+    a.glyphs.clear();
+    a.shelfX = a.shelfY = a.shelfH = 0;
+}
+
+static GlyphAtlas* atlasFor(SDL_Renderer* renderer, TTF_Font* font)
+{
+    for (int i = 0; i < g_atlasCount; i++)
+        if (g_atlases[i].font == font) return &g_atlases[i];
+
+    if (g_atlasCount == TEXTATLAS_MAX_FONTS)
+    {
+        printf("[TEXT] More than %d fonts; raise TEXTATLAS_MAX_FONTS\n", TEXTATLAS_MAX_FONTS);
+        return nullptr;
+    }
+
+    SDL_Texture* tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                         SDL_TEXTUREACCESS_STATIC,
+                                         TEXTATLAS_SIZE, TEXTATLAS_SIZE);
+    if (!tex)
+    {
+        printf("[TEXT] Atlas texture failed: %s\n", SDL_GetError());
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(tex, SDL_ScaleModeNearest);   // quads land on whole pixels
+
+    GlyphAtlas& a = g_atlases[g_atlasCount++];
+    a.font    = font;
+    a.texture = tex;
+    a.height  = TTF_FontHeight(font);
+    atlasClear(a);
+    return &a;
+}
+
+// Rasterises one glyph into the atlas. False only when the atlas is
+// full; a glyph the font can't render is stored as empty.
+static bool atlasAdd(GlyphAtlas& a, uint32_t cp, AtlasGlyph* out)
+{
+    AtlasGlyph g;
+
+    int minx, maxx, miny, maxy, advance;
+    if (TTF_GlyphMetrics32(a.font, cp, &minx, &maxx, &miny, &maxy, &advance) == 0)
+        g.advance = (int16_t)advance;
+
+    // White, so the vertex colour is the text colour. Solid keeps the
+    // crisp look the per-call TTF_RenderText_Solid path had.
+    SDL_Surface* s = nullptr;
+    if (cp != ' ')
+        s = TTF_RenderGlyph32_Solid(a.font, cp, SDL_Color{255, 255, 255, 255});
+
+    if (s && s->w > 0 && s->h > 0)
+    {
+        if (a.shelfX + s->w + TEXTATLAS_PAD > TEXTATLAS_SIZE)
+        {
+            a.shelfY += a.shelfH + TEXTATLAS_PAD;
+            a.shelfX  = 0;
+            a.shelfH  = 0;
+        }
+        if (a.shelfY + s->h > TEXTATLAS_SIZE || s->w > TEXTATLAS_SIZE)
+        {
+            SDL_FreeSurface(s);
+            return false;
+        }
+
+        // Solid surfaces are palettised with a colour key; converting
+        // to RGBA turns the key into alpha 0
+        SDL_Surface* rgba = SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_RGBA32, 0);
+        if (rgba)
+        {
+            SDL_Rect dst = { a.shelfX, a.shelfY, rgba->w, rgba->h };
+            SDL_UpdateTexture(a.texture, &dst, rgba->pixels, rgba->pitch);
+
+            g.x = (int16_t)dst.x;
+            g.y = (int16_t)dst.y;
+            g.w = (int16_t)dst.w;
+            g.h = (int16_t)dst.h;
+
+            a.shelfX += dst.w + TEXTATLAS_PAD;
+            if (dst.h > a.shelfH) a.shelfH = dst.h;
+            SDL_FreeSurface(rgba);
+        }
+    }
+    if (s) SDL_FreeSurface(s);
+
+    a.glyphs[cp] = g;
+    *out = g;
+    g_taStats.rasterised++;
+    return true;
+}
+
+static bool atlasGet(GlyphAtlas& a, uint32_t cp, AtlasGlyph* out)
+{
+    auto it = a.glyphs.find(cp);
+    if (it != a.glyphs.end()) { *out = it->second; return true; }
+    return atlasAdd(a, cp, out);
+}
+
+/* -------------------------------------------------------
+   Layout
+------------------------------------------------------- */
+// False if the atlas filled part way through
+static bool layoutString(GlyphAtlas& a, const char* text, int* width)
+{
+    g_staged.clear();
+
+    const unsigned char* p = (const unsigned char*)text;
+    const float inv = 1.0f / TEXTATLAS_SIZE;
+    uint32_t prev = 0;
+    int pen = 0;
+
+    while (*p)
+    {
+        uint32_t cp = nextCodePoint(p);
+        if (cp < 0x20) continue;
+        if (!TTF_GlyphIsProvided32(a.font, cp)) cp = '?';
+
+        if (prev) pen += TTF_GetFontKerningSizeGlyphs32(a.font, prev, cp);
+        prev = cp;
+
+        AtlasGlyph g;
+        if (!atlasGet(a, cp, &g)) return false;
+
+        if (g.w > 0)
+        {
+            StagedQuad q;
+            q.u  = (float)pen;
+            q.w  = (float)g.w;
+            q.h  = (float)g.h;
+            q.s0 = g.x * inv;
+            q.t0 = g.y * inv;
+            q.s1 = (g.x + g.w) * inv;
+            q.t1 = (g.y + g.h) * inv;
+            g_staged.push_back(q);
+        }
+        pen += g.advance;
+    }
+
+    *width = pen;
+    return true;
+}
+
+int textAtlasPrepare(SDL_Renderer* renderer, TTF_Font* font, const char* text)
+{
+    g_staged.clear();
+    g_stagedAtlas = nullptr;
+    if (!renderer || !font || !text) return 0;
+
+    GlyphAtlas* a = atlasFor(renderer, font);
+    if (!a) return 0;
+
+    int width = 0;
+    if (!layoutString(*a, text, &width))
+    {
+        // Full — start over with just what this string needs. Strings
+        // already drawn this frame keep their pixels: SDL flushes
+        // queued draws before it touches the texture.
+        atlasClear(*a);
+        g_taStats.resets++;
+        printf("[TEXT] Atlas for %d px font full; cleared\n", a->height);
+        if (!layoutString(*a, text, &width))
+        {
+            g_staged.clear();
+            return 0;
+        }
+    }
+
+    g_stagedAtlas = a;
+    return width;
+}
+
+/* -------------------------------------------------------
+   Draw
+------------------------------------------------------- */
+void textAtlasDraw(SDL_Renderer* renderer, int x, int y, SDL_Color color)
+{
+    if (!g_stagedAtlas || g_staged.empty()) return;
+
+    size_t n = g_staged.size();
+    g_verts.resize(n * 4);
+    g_indices.resize(n * 6);
+
+    // Rotating the box 90° clockwise about (x, y) maps box point
+    // (u, v) to screen (x - v, y + u)
+    const float ox = (float)x, oy = (float)y;
+    for (size_t i = 0; i < n; i++)
+    {
+        const StagedQuad& q = g_staged[i];
+        SDL_Vertex* v = &g_verts[i * 4];
+
+        v[0].position = { ox,       oy + q.u       };  v[0].tex_coord = { q.s0, q.t0 };
+        v[1].position = { ox,       oy + q.u + q.w };  v[1].tex_coord = { q.s1, q.t0 };
+        v[2].position = { ox - q.h, oy + q.u + q.w };  v[2].tex_coord = { q.s1, q.t1 };
+        v[3].position = { ox - q.h, oy + q.u       };  v[3].tex_coord = { q.s0, q.t1 };
+        for (int k = 0; k < 4; k++) v[k].color = color;
+
+        int* idx = &g_indices[i * 6];
+        int  b   = (int)(i * 4);
+        idx[0] = b; idx[1] = b + 1; idx[2] = b + 2;
+        idx[3] = b; idx[4] = b + 2; idx[5] = b + 3;
+    }
+
+    SDL_RenderGeometry(renderer, g_stagedAtlas->texture,
+                       g_verts.data(), (int)g_verts.size(),
+                       g_indices.data(), (int)g_indices.size());
+
+    g_taStats.strings++;
+    g_taStats.glyphs += (uint32_t)n;
+}
+
+/* -------------------------------------------------------
+   Lifecycle / stats
+------------------------------------------------------- */
+void textAtlasShutdown()
+{
+    for (int i = 0; i < g_atlasCount; i++)
+    {
+        if (g_atlases[i].texture) SDL_DestroyTexture(g_atlases[i].texture);
+        g_atlases[i] = GlyphAtlas{};
+    }
+    g_atlasCount  = 0;
+    g_stagedAtlas = nullptr;
+    g_staged.clear();
+}
+
+TextAtlasStats textAtlasTakeStats()
+{
+    TextAtlasStats s = g_taStats;
+    g_taStats = TextAtlasStats{};
+    return s;
+}
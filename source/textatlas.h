@@ -0,0 +1,47 @@
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+/* -------------------------------------------------------
+   Glyph-atlas text
+   Every (font, glyph) pair is rasterised once, in white,
+   into a packed atlas texture for that font. A string is
+   then one SDL_RenderGeometry call: a textured quad per
+   glyph, coloured through the vertex colour, with the 90°
+   rotation the skin needs done in the vertex positions.
+
+   Text is UTF-8 (tags and file names already are); a byte
+   that isn't part of a valid sequence is taken as
+   ISO-8859-1, so stray legacy text still shows.
+
+   The fonts are opened at a fixed size, so a TTF_Font*
+   identifies both face and size. When an atlas fills up it
+   is cleared and refilled from what is on screen.
+------------------------------------------------------- */
+#define TEXTATLAS_SIZE      1024   // atlas texture edge, px
+#define TEXTATLAS_MAX_FONTS 4
+
+struct TextAtlasStats
+{
+    uint32_t strings    = 0;   // strings drawn
+    uint32_t glyphs     = 0;   // quads drawn
+    uint32_t rasterised = 0;   // glyphs added to an atlas
+    uint32_t resets     = 0;   // atlases cleared because they were full
+};
+
+// Drop every atlas texture (before the renderer goes)
+void textAtlasShutdown();
+
+// Lays `text` out (adding any new glyphs to the atlas) and
+// keeps the quads for textAtlasDraw(). Returns the string's
+// width in px; its height is TTF_FontHeight(font).
+int textAtlasPrepare(SDL_Renderer* renderer, TTF_Font* font, const char* text);
+
+// Draws the prepared string reading top to bottom: the string
+// box is placed at (x, y) and rotated 90° clockwise about that
+// corner — the placement SDL_RenderCopyEx(..., 90.0, {0,0})
+// gives a rendered surface.
+void textAtlasDraw(SDL_Renderer* renderer, int x, int y, SDL_Color color);
+
+// Counters since the last call, then reset
+TextAtlasStats textAtlasTakeStats();
@@ -114,15 +114,18 @@ static void handlePanSlider(float fbY)
     playerSetPan(t * 2.0f - 1.0f);   // map 0..1 → -1..+1
 }
 
-// Progress bar: {1467, 64, 61, 982}
-// Indicator moves top→bottom for start→end of track
+// Progress bar — shared by the drag hit-test, the seek and the lift
+// that ends a scrub. Indicator moves top→bottom for start→end of track
+static const SDL_Rect g_progressBar = {1467, 64, 61, 982};
+
 static void handleProgressBar(float fbY)
 {
     if (!playerIsPlaying()) return;
-    const SDL_Rect bar = {1467, 64, 61, 982};
+    const SDL_Rect& bar = g_progressBar;
     float t = (fbY - bar.y) / (float)bar.h;
     t = clampf(t, 0.0f, 1.0f);
-    playerSeek(t * (float)playerGetTrackLength());
+    // Only moves the scrub target; the seek happens on lift
+    playerScrubTo(t * (float)playerGetTrackLength());
 }
 
 // EQ band sliders — bands 1-10 are in eqBand2..eqBand11
@@ -315,7 +318,6 @@ static void handlePlayerDrag(float fbX, float fbY, float startFbX, float startFb
 {
     const SDL_Rect volBar  = {1551, 421, 40, 264};
     const SDL_Rect panBar  = {1552, 698, 40, 145};
-    const SDL_Rect progBar = {1467,  64, 61, 982};
 
     // Determine which zone the drag started in
     if (rectContains(volBar, startFbX, startFbY))
@@ -328,7 +330,7 @@ static void handlePlayerDrag(float fbX, float fbY, float startFbX, float startFb
         handlePanSlider(fbY);
         return;
     }
-    if (rectContains(progBar, startFbX, startFbY))
+    if (rectContains(g_progressBar, startFbX, startFbY))
     {
         handleProgressBar(fbY);
         return;
@@ -365,6 +367,11 @@ void touchUpdate()
     g_touchCount = (int)g_touchState.count;
 }
 
+bool touchIsActive()
+{
+    return g_touchCount > 0;
+}
+
 bool touchHandleInput(bool hasFileBrowser, bool hasSettings)
 {
     bool consumed = false;
@@ -440,7 +447,11 @@ bool touchHandleInput(bool hasFileBrowser, bool hasSettings)
         }
         else
         {
-            // Finger lifted — was it a tap?
+            // Finger lifted — a progress-bar drag seeks now
+            if (rectContains(g_progressBar, g_touches[j].startFbX, g_touches[j].startFbY))
+                playerScrubEnd();
+
+            // Was it a tap?
             float dx = g_touches[j].fbX - g_touches[j].startFbX;
             float dy = g_touches[j].fbY - g_touches[j].startFbY;
             bool  isTap = (sqrtf(dx*dx + dy*dy) < TAP_THRESHOLD);
@@ -14,3 +14,6 @@ void touchUpdate();
 //   hasSettings    : settingsIsOpen()
 // Returns true if a touch event was consumed this frame.
 bool touchHandleInput(bool hasFileBrowser, bool hasSettings);
+
+// True while at least one finger is on the screen (after touchUpdate)
+bool touchIsActive();
@@ -0,0 +1,161 @@
+#include "tracktable.h"
+#include <stdio.h>
+#include <string.h>
+#include <string_view>
+#include <unordered_map>
+
+/* -------------------------------------------------------
+   Storage
+------------------------------------------------------- */
+struct TrackRecord
+{
+    const char*      path;   // interned, NUL-terminated
+    Mp3MetadataEntry meta;
+};
+
+// Paths are packed into large blocks instead of one heap
+// allocation per track. Blocks are never freed or moved.
+#define TRACK_ARENA_BYTES (64 * 1024)
+
+static TrackRecord* g_trackChunks[TRACK_MAX_CHUNKS] = {};
+static uint32_t     g_trackCount = 0;
+
+static char*  g_arenaBlock = nullptr;
+static size_t g_arenaUsed  = TRACK_ARENA_BYTES;
+
+static std::unordered_map<std::string_view, TrackId> g_trackIndex;
+
+static Mutex g_trackMutex;
+static bool  g_trackMutexInited = false;
+
+static void trackEnsureInited()
+{
+    if (!g_trackMutexInited)
+    {
+        mutexInit(&g_trackMutex);
+        g_trackIndex.reserve(4096);
+        g_trackMutexInited = true;
+    }
+}
+
+static inline TrackRecord* trackRecord(TrackId id)
+{
+    if (id >= __atomic_load_n(&g_trackCount, __ATOMIC_ACQUIRE)) return nullptr;
+    return &g_trackChunks[id / TRACK_CHUNK_SIZE][id % TRACK_CHUNK_SIZE];
+}
+
+static const char* internPath(const char* path, size_t len)
+{
+    char* p;
+    if (len + 1 > TRACK_ARENA_BYTES / 4)
+    {
+        // Oversized path — give it its own allocation, keep the block
+        p = new char[len + 1];
+    }
+    else
+    {
+        if (g_arenaUsed + len + 1 > TRACK_ARENA_BYTES)
+        {
+            g_arenaBlock = new char[TRACK_ARENA_BYTES];
+            g_arenaUsed  = 0;
+        }
+        p = g_arenaBlock + g_arenaUsed;
+        g_arenaUsed += len + 1;
+    }
+    memcpy(p, path, len);
+    p[len] = '\0';
+    return p;
+}
+
+/* -------------------------------------------------------
+   Public API
+------------------------------------------------------- */
+TrackId trackIntern(const char* path)
+{
+    if (!path) return TRACK_ID_NONE;
+    trackEnsureInited();
+
+    size_t len = strlen(path);
+
+    mutexLock(&g_trackMutex);
+
+    auto it = g_trackIndex.find(std::string_view(path, len));
+    if (it != g_trackIndex.end())
+    {
+        TrackId id = it->second;
+        mutexUnlock(&g_trackMutex);
+        return id;
+    }
+
+    TrackId id = g_trackCount;
+    uint32_t chunk = id / TRACK_CHUNK_SIZE;
+    if (chunk >= TRACK_MAX_CHUNKS)
+    {
+        mutexUnlock(&g_trackMutex);
+        printf("[TRACKS] Table full (%u tracks), ignoring %s\n", id, path);
+        return TRACK_ID_NONE;
+    }
+    if (!g_trackChunks[chunk])
+        g_trackChunks[chunk] = new TrackRecord[TRACK_CHUNK_SIZE]();
+
+    TrackRecord& r = g_trackChunks[chunk][id % TRACK_CHUNK_SIZE];
+    r.path = internPath(path, len);
+    r.meta = Mp3MetadataEntry{};
+
+    g_trackIndex.emplace(std::string_view(r.path, len), id);
+
+    // Publish only after the record is filled in
+    __atomic_store_n(&g_trackCount, id + 1, __ATOMIC_RELEASE);
+
+    mutexUnlock(&g_trackMutex);
+    return id;
+}
+
+TrackId trackFind(const char* path)
+{
+    if (!path || !g_trackMutexInited) return TRACK_ID_NONE;
+
+    mutexLock(&g_trackMutex);
+    auto it = g_trackIndex.find(std::string_view(path));
+    TrackId id = (it != g_trackIndex.end()) ? it->second : TRACK_ID_NONE;
+    mutexUnlock(&g_trackMutex);
+    return id;
+}
+
+int trackCount()
+{
+    return (int)__atomic_load_n(&g_trackCount, __ATOMIC_ACQUIRE);
+}
+
+const char* trackGetPath(TrackId id)
+{
+    TrackRecord* r = trackRecord(id);
+    return r ? r->path : nullptr;
+}
+
+const Mp3MetadataEntry* trackGetMetadata(TrackId id)
+{
+    TrackRecord* r = trackRecord(id);
+    return r ? &r->meta : nullptr;
+}
+
+bool trackCopyMetadata(TrackId id, Mp3MetadataEntry* out)
+{
+    TrackRecord* r = trackRecord(id);
+    if (!r || !out) return false;
+
+    mutexLock(&g_trackMutex);
+    *out = r->meta;
+    mutexUnlock(&g_trackMutex);
+    return true;
+}
+
+void trackSetMetadata(TrackId id, const Mp3MetadataEntry& meta)
+{
+    TrackRecord* r = trackRecord(id);
+    if (!r) return;
+
+    mutexLock(&g_trackMutex);
+    r->meta = meta;
+    mutexUnlock(&g_trackMutex);
+}
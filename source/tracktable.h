@@ -0,0 +1,44 @@
+#pragma once
+#include "mp3.h"      // Mp3MetadataEntry — shared by every format
+#include <stdint.h>
+
+/* -------------------------------------------------------
+   Track table
+   Every path the player has seen gets one record and a
+   stable 32-bit ID for the rest of the session. The path is
+   interned once, a hash index maps path -> ID, and each
+   record owns that track's metadata, so every lookup is
+   O(1) no matter how many tracks are loaded.
+
+   The playlist holds IDs, and the format scanners write
+   metadata by ID; there is no per-format metadata list to
+   search any more.
+
+   - Records live in fixed-size chunks that never move, so
+     a returned path or metadata pointer stays valid for
+     the session (the table is never shrunk).
+   - trackIntern/trackFind/trackSetMetadata are thread-safe.
+     Reads through trackGetMetadata are unlocked, same as
+     the per-format getters they replace; a scanner update
+     racing a render can at worst show one stale frame.
+------------------------------------------------------- */
+typedef uint32_t TrackId;
+
+#define TRACK_ID_NONE     0xFFFFFFFFu
+#define TRACK_CHUNK_SIZE  1024
+#define TRACK_MAX_CHUNKS  256     // 262,144 tracks
+
+// Return the ID for path, creating the record on first sight
+TrackId trackIntern(const char* path);
+
+// TRACK_ID_NONE if path was never interned
+TrackId trackFind(const char* path);
+
+int trackCount();
+
+const char*             trackGetPath(TrackId id);
+const Mp3MetadataEntry* trackGetMetadata(TrackId id);
+
+// Locked copy, for read-modify-write from a scanner
+bool trackCopyMetadata(TrackId id, Mp3MetadataEntry* out);
+void trackSetMetadata(TrackId id, const Mp3MetadataEntry& meta);
@@ -7,54 +7,41 @@
 #include "player.h"
 #include "playlist.h"
 #include "player_state.h"
+#include "settings_state.h"
+#include <switch.h>
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <SDL_image.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
-#include "kiss_fftr.h"
+#include <vector>
 #include "spectrum.h"
+#include "textatlas.h"
+#include "spectrum_view.h"
 
 
 #define FB_W 1920
 #define FB_H 1080
 
-#define FFT_SIZE 1024
-#define SPECTRUM_BARS 20
-
 #define EQ_BAR_WIDTH   244
 #define EQ_BAR_HEIGHT  21
 #define EQ_KNOB_W      37
 #define EQ_KNOB_H      37
 
-// Helper: try all four format metadata stores in order.
-// Use this everywhere instead of bare mp3GetTrackMetadata() so that
-// FLAC, OGG, and WAV tracks show correct info throughout the UI.
+// Helper: metadata for any format, by playlist index.
+// The track table holds MP3, FLAC, OGG and WAV alike, so this is
+// a single O(1) lookup rather than a search of four stores.
 static const Mp3MetadataEntry* getAnyTrackMetadata(int index)
 {
-    const Mp3MetadataEntry* md = mp3GetTrackMetadata(index);
-    if (!md) md = flacGetTrackMetadata(index);
-    if (!md) md = oggGetTrackMetadata(index);
-    if (!md) md = wavGetTrackMetadata(index);
-    return md;
+    return playlistGetMetadata(index);
 }
 
 bool autoEQEnabled = false;
 bool eqPreset3press = false;
 
-static kiss_fftr_cfg fftCfg = NULL;
-static kiss_fft_cpx fftOut[FFT_SIZE/2];
-static float fftMag[FFT_SIZE/2];
 
-float bandValues[SPECTRUM_BARS] = {0};
-static bool fftInitialized = false;
-float spectrumPeaks[SPECTRUM_BARS] = {0};
-float peakValues[SPECTRUM_BARS] = {0};
-int peakHold[SPECTRUM_BARS] = {0};
-static float bandSmooth[SPECTRUM_BARS] = {0.0f};
-static const float PEAK_FALL_SPEED = 2.0f;
-float spectrumFallSpeed[SPECTRUM_BARS] = {0.0f};
+float bandValues[SPECTRUM_MAX_BARS] = {0};
 
 static float eqGlowTime = 0.0f;
 
@@ -72,12 +59,16 @@ static int  uiPressTimer   = 0;
 
 static const int UI_PRESS_FRAMES = 6; // ~100ms at 60fps
 
+// Animations here count 60 Hz frames. The main loop renders slower
+// when little is moving (framepace.h), so each uiRender() advances
+// them by the 60 Hz frames that passed since the last one.
+static int g_uiSteps = 1;
+
 
 // --- Player feature flags ---
 extern bool playerIsShuffleEnabled();
 extern bool playerIsRepeatEnabled();
 
-extern float g_fftInput[FFT_SIZE];
 
 // --- Y positions of the 10 bands ---
 static const int eqCurveY[10] =
@@ -162,7 +153,12 @@ static void updateEQAnimation()
     for (int i = 0; i < 10; i++)
     {
         float target = g_equalizer.getBand(i + 1);
-        eqDisplayBands[i] += (target - eqDisplayBands[i]) * speed;
+        for (int s = 0; s < g_uiSteps; s++)
+            eqDisplayBands[i] += (target - eqDisplayBands[i]) * speed;
+
+        // Land exactly, so a settled curve stops changing
+        if (fabsf(target - eqDisplayBands[i]) < 0.005f)
+            eqDisplayBands[i] = target;
     }
 }
 
@@ -225,27 +221,37 @@ static void getEQColor(float db, Uint8 &r, Uint8 &g, Uint8 &b)
     }
 }
 // ------------------------------------------------------------
-// Main curve renderer
+// Curve geometry
+// The 12 control points depend only on the animated band
+// values. The spline drawn through them is baked into two
+// render targets — glow (outer + mid) and core — whenever the
+// points move; a frame then copies both, additively, with the
+// breathing pulse applied as a colour mod.
 // ------------------------------------------------------------
-static void drawEQCurve(SDL_Renderer* renderer)
-{
-    if (!renderer) return;
+#define EQ_CURVE_CENTER_X 1129
+#define EQ_CURVE_RANGE    54
 
-    const int centerX = 1129;
-    const int range   = 54;
+// Screen area the lines can reach: centre ± range, ± 5 px of glow
+static const SDL_Rect EQ_CURVE_AREA = {1064, 330, 130, 465};
 
-    // breathing animation
-    static float eqGlowTime = 0.0f;
-    eqGlowTime += 0.05f;
+static SDL_Texture* g_eqCurveGlow   = nullptr;
+static SDL_Texture* g_eqCurveCore   = nullptr;
+static bool         g_eqCurveFailed = false;   // no render targets: draw lines directly
+static bool         g_eqCurveValid  = false;
+static SDL_Point    g_eqCurveKey[12];
+static uint32_t     g_eqCurveBuilds = 0;
+
+static void eqCurvePoints(SDL_Point points[12])
+{
+    const int centerX = EQ_CURVE_CENTER_X;
+    const int range   = EQ_CURVE_RANGE;
 
-    int eqCurveY[10] =
+    static const int eqCurveY[10] =
     {
         346, 392, 439, 486, 534,
         581, 628, 675, 722, 769
     };
 
-    SDL_Point points[12];
-
     points[0]  = {centerX, 337};
     points[11] = {centerX, 780};
 
@@ -265,8 +271,15 @@ static void drawEQCurve(SDL_Renderer* renderer)
 
     // extend tail slightly
     points[10].y += 8;
+}
 
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
+// One layer of the spline, shifted by (dx, dy), colours scaled by
+// pulse. Blend mode is the caller's (additive).
+static void drawEQCurveLayer(SDL_Renderer* renderer, const SDL_Point points[12],
+                             bool glow, float pulse, int dx, int dy)
+{
+    const int centerX = EQ_CURVE_CENTER_X;
+    const int range   = EQ_CURVE_RANGE;
 
     bool firstPoint = true;
     SDL_Point prev = points[0];
@@ -285,77 +298,147 @@ static void drawEQCurve(SDL_Renderer* renderer)
             if (p.x < centerX - range) p.x = centerX - range;
             if (p.x > centerX + range) p.x = centerX + range;
 
-            float db = (float)(p.x - centerX) / range * 12.0f;
-            if (db > 12.0f) db = 12.0f;
-            if (db < -12.0f) db = -12.0f;
-
-            Uint8 r,g,b;
-            getEQColor(db,r,g,b);
-
-            // breathing glow
-            float pulseOuter = 0.6f + 0.4f * sinf(eqGlowTime);
-            float pulseInner = 0.8f + 0.2f * sinf(eqGlowTime * 1.3f);
-
-            Uint8 rOuter = (Uint8)(r * pulseOuter);
-            Uint8 gOuter = (Uint8)(g * pulseOuter);
-            Uint8 bOuter = (Uint8)(b * pulseOuter);
-
-            Uint8 rInner = (Uint8)(r * pulseInner);
-            Uint8 gInner = (Uint8)(g * pulseInner);
-            Uint8 bInner = (Uint8)(b * pulseInner);
+            p.x += dx;
+            p.y += dy;
 
             if (!firstPoint)
             {
-                // ===== THICK CONSISTENT LINE =====
+                float db = (float)(p.x - dx - centerX) / range * 12.0f;
+                if (db > 12.0f) db = 12.0f;
+                if (db < -12.0f) db = -12.0f;
+
+                Uint8 r,g,b;
+                getEQColor(db,r,g,b);
+
+                r = (Uint8)(r * pulse);
+                g = (Uint8)(g * pulse);
+                b = (Uint8)(b * pulse);
 
-                // outer glow (wide)
-                SDL_SetRenderDrawColor(renderer, rOuter, gOuter, bOuter, 25);
-                for (int w = -5; w <= 5; w++)
+                if (glow)
                 {
-                    SDL_RenderDrawLine(renderer,
-                        prev.x + w, prev.y,
-                        p.x + w,    p.y);
+                    // outer glow (wide)
+                    SDL_SetRenderDrawColor(renderer, r, g, b, 25);
+                    for (int w = -5; w <= 5; w++)
+                        SDL_RenderDrawLine(renderer, prev.x + w, prev.y, p.x + w, p.y);
+
+                    // mid glow
+                    SDL_SetRenderDrawColor(renderer, r, g, b, 70);
+                    for (int w = -3; w <= 3; w++)
+                        SDL_RenderDrawLine(renderer, prev.x + w, prev.y, p.x + w, p.y);
                 }
-
-                // mid glow
-                SDL_SetRenderDrawColor(renderer, rOuter, gOuter, bOuter, 70);
-                for (int w = -3; w <= 3; w++)
+                else
                 {
-                    SDL_RenderDrawLine(renderer,
-                        prev.x + w, prev.y,
-                        p.x + w,    p.y);
+                    // core (extra thick center)
+                    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
+                    SDL_RenderDrawLine(renderer, prev.x,     prev.y, p.x,     p.y);
+                    SDL_RenderDrawLine(renderer, prev.x - 1, prev.y, p.x - 1, p.y);
+                    SDL_RenderDrawLine(renderer, prev.x + 1, prev.y, p.x + 1, p.y);
                 }
-
-                // core (extra thick center)
-                SDL_SetRenderDrawColor(renderer, rInner, gInner, bInner, 255);
-
-                SDL_RenderDrawLine(renderer, prev.x,     prev.y, p.x,     p.y);
-                SDL_RenderDrawLine(renderer, prev.x - 1, prev.y, p.x - 1, p.y);
-                SDL_RenderDrawLine(renderer, prev.x + 1, prev.y, p.x + 1, p.y);
             }
 
             prev = p;
             firstPoint = false;
         }
     }
+}
 
+static SDL_Texture* eqCurveTarget(SDL_Renderer* renderer)
+{
+    SDL_Texture* t = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                       SDL_TEXTUREACCESS_TARGET,
+                                       EQ_CURVE_AREA.w, EQ_CURVE_AREA.h);
+    if (t) SDL_SetTextureBlendMode(t, SDL_BLENDMODE_ADD);
+    return t;
+}
+
+// Re-bakes both layers if the control points moved
+static bool eqCurveBake(SDL_Renderer* renderer, const SDL_Point points[12])
+{
+    if (g_eqCurveFailed) return false;
+
+    if (!g_eqCurveGlow || !g_eqCurveCore)
+    {
+        g_eqCurveGlow = eqCurveTarget(renderer);
+        g_eqCurveCore = eqCurveTarget(renderer);
+        if (!g_eqCurveGlow || !g_eqCurveCore)
+        {
+            printf("[UI] EQ curve target failed: %s; drawing it every frame\n", SDL_GetError());
+            if (g_eqCurveGlow) SDL_DestroyTexture(g_eqCurveGlow);
+            if (g_eqCurveCore) SDL_DestroyTexture(g_eqCurveCore);
+            g_eqCurveGlow = g_eqCurveCore = nullptr;
+            g_eqCurveFailed = true;
+            return false;
+        }
+        g_eqCurveValid = false;
+    }
+
+    if (g_eqCurveValid && memcmp(g_eqCurveKey, points, sizeof(g_eqCurveKey)) == 0)
+        return true;
+
+    // Opaque black: adding these layers adds exactly what the lines
+    // would have added to the screen
+    const int dx = -EQ_CURVE_AREA.x, dy = -EQ_CURVE_AREA.y;
+    SDL_Texture* layers[2] = { g_eqCurveGlow, g_eqCurveCore };
+    for (int l = 0; l < 2; l++)
+    {
+        SDL_SetRenderTarget(renderer, layers[l]);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
+        drawEQCurveLayer(renderer, points, l == 0, 1.0f, dx, dy);
+    }
+    SDL_SetRenderTarget(renderer, NULL);
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
+    memcpy(g_eqCurveKey, points, sizeof(g_eqCurveKey));
+    g_eqCurveValid = true;
+    g_eqCurveBuilds++;
+    return true;
+}
+
+// ------------------------------------------------------------
+// Main curve renderer
+// ------------------------------------------------------------
+static void drawEQCurve(SDL_Renderer* renderer)
+{
+    if (!renderer) return;
+
+    // breathing animation
+    static float eqGlowTime = 0.0f;
+    eqGlowTime += 0.05f * g_uiSteps;
+
+    float pulseOuter = 0.6f + 0.4f * sinf(eqGlowTime);
+    float pulseInner = 0.8f + 0.2f * sinf(eqGlowTime * 1.3f);
+
+    SDL_Point points[12];
+    eqCurvePoints(points);
+
+    if (eqCurveBake(renderer, points))
+    {
+        SDL_SetTextureColorMod(g_eqCurveGlow, (Uint8)(255 * pulseOuter),
+                               (Uint8)(255 * pulseOuter), (Uint8)(255 * pulseOuter));
+        SDL_SetTextureColorMod(g_eqCurveCore, (Uint8)(255 * pulseInner),
+                               (Uint8)(255 * pulseInner), (Uint8)(255 * pulseInner));
+        SDL_RenderCopy(renderer, g_eqCurveGlow, NULL, &EQ_CURVE_AREA);
+        SDL_RenderCopy(renderer, g_eqCurveCore, NULL, &EQ_CURVE_AREA);
+    }
+    else
+    {
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
+        drawEQCurveLayer(renderer, points, true,  pulseOuter, 0, 0);
+        drawEQCurveLayer(renderer, points, false, pulseInner, 0, 0);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    }
+
     // --- control dots ---
     SDL_SetRenderDrawColor(renderer,255,255,255,255);
 
+    SDL_Rect dots[10];
     for(int i=1;i<=10;i++)
-    {
-        SDL_Rect dot =
-        {
-            points[i].x-2,
-            points[i].y-2,
-            4,
-            4
-        };
+        dots[i - 1] = { points[i].x-2, points[i].y-2, 4, 4 };
 
-        SDL_RenderFillRect(renderer,&dot);
-    }
+    SDL_RenderFillRects(renderer, dots, 10);
 }
 
 
@@ -586,14 +669,8 @@ static void drawVolumeBar(SDL_Renderer* renderer,
 
 void spectrumReset()
 {
-    memset(g_fftInput, 0, sizeof(g_fftInput));
-  //  fftWritePos = 0;
-
-    for (int i = 0; i < SPECTRUM_BARS; i++)
-    {
-        bandSmooth[i] = 0.0f;
-        spectrumPeaks[i] = 0.0f;
-    }
+    spectrumEngineReset();
+    spectrumViewReset();
 }
 
 static void drawProgressBar(SDL_Renderer* renderer,
@@ -672,7 +749,7 @@ static void drawMonoStereo(SDL_Renderer* renderer, TTF_Font* font, const Mp3Meta
 
     // --- Smooth glow animation using sine wave ---
     static float glowTime = 0.0f;
-    glowTime += 0.05f;   // speed of glow (lower = slower pulse)
+    glowTime += 0.05f * g_uiSteps;   // speed of glow (lower = slower pulse)
 
     float glowWave = (sinf(glowTime) + 1.0f) * 0.5f;  // 0 → 1 smoothly
 
@@ -700,160 +777,23 @@ static void drawMonoStereo(SDL_Renderer* renderer, TTF_Font* font, const Mp3Meta
     drawVerticalText(renderer, font, "Stereo", stereoRect, stereoColor);
 }
 
-void uiInitFFT()
-{
-    if (!fftCfg)
-        fftCfg = kiss_fftr_alloc(FFT_SIZE, 0, NULL, NULL);
-}
-
-
-
+// Reconfigures only when the output rate or the FFT size or bar count setting moved
 static void computeSpectrum()
 {
-    kiss_fftr(fftCfg, g_fftInput, fftOut);
-
-    for (int i = 0; i < FFT_SIZE/2; i++)
-    {
-        float real = fftOut[i].r;
-        float imag = fftOut[i].i;
-
-        fftMag[i] = sqrtf(real*real + imag*imag);
-    }
-
-    const float SMOOTHING = 0.18f;
-
-    const float sampleRate = 44100.0f;
-    const float minFreq = 20.0f;
-    const float maxFreq = sampleRate / 2.0f;
-
-    static float autoGain = 1.0f;
-
-    for (int b = 0; b < SPECTRUM_BARS; b++)
-    {
-        float t0 = (float)b / SPECTRUM_BARS;
-        float t1 = (float)(b + 1) / SPECTRUM_BARS;
-
-        float f0 = minFreq * powf(maxFreq / minFreq, t0);
-        float f1 = minFreq * powf(maxFreq / minFreq, t1);
-
-        int bin0 = (int)(f0 * FFT_SIZE / sampleRate);
-        int bin1 = (int)(f1 * FFT_SIZE / sampleRate);
-
-        if (bin0 < 0) bin0 = 0;
-        if (bin1 >= FFT_SIZE/2) bin1 = FFT_SIZE/2 - 1;
-        if (bin1 <= bin0) bin1 = bin0 + 1;
-
-        float sum = 0.0f;
-        int count = 0;
-
-        for (int i = bin0; i <= bin1; i++)
-        {
-            sum += fftMag[i];
-            count++;
-        }
-
-        float avg = (count > 0) ? sum / count : 0.0f;
-
-        avg = log10f(avg + 1.0f) * 0.9f;
-
-        // automatic gain control
-        if (avg > autoGain)
-            autoGain = avg;
-        else
-            autoGain *= 0.995f;
-
-        avg /= (autoGain + 0.0001f);
-
-        if (avg > 1.0f) avg = 1.0f;
-        if (avg < 0.0f) avg = 0.0f;
-
-        // bass boost
-        float bassBoost = 1.0f + (float)(SPECTRUM_BARS - b) / SPECTRUM_BARS;
-        avg *= bassBoost * 0.9f;
-
-        if (avg > 1.0f) avg = 1.0f;
-
-        // smoothing
-        bandSmooth[b] += (avg - bandSmooth[b]) * SMOOTHING;
-
-        bandValues[b] = bandSmooth[b];
-    }
-}
-
-static void drawWinampSpectrumVertical(SDL_Renderer* renderer, SDL_Rect rect, const float* bands)
-{
-    if (!renderer || !bands) return;
-
-    int barHeight  = rect.h / SPECTRUM_BARS;
-    int barSpacing = 1;
-
-    for (int i = 0; i < SPECTRUM_BARS; i++)
-    {
-        // Flip frequency order (bass at top)
-        int bandIndex = SPECTRUM_BARS - 1 - i;
-
-        float value = bands[bandIndex];
-        if (value < 0.0f) value = 0.0f;
-        if (value > 1.0f) value = 1.0f;
+    static std::vector<float> window;
 
-        int filledWidth = (int)(value * rect.w);
+    spectrumEngineConfigure(playerGetOutputSampleRate(), g_settings.spectrumFftSize,
+                            g_settings.spectrumBars, SPECTRUM_WINDOW_HANN);
 
-        int y = rect.y + rect.h - (i + 1) * barHeight;
+    // The window ending at what's audible now; the previous one
+    // stays if the tap has nothing for us
+    int n = spectrumEngineFftSize();
+    if ((int)window.size() != n) window.assign(n, 0.0f);
+    playerReadAnalysisWindow(window.data(), n);
 
-        /* ---- Draw colored bar with gradient ---- */
-        for (int x = 0; x < filledWidth; x++)
-        {
-            float t = (float)x / rect.w;   // 0 = quiet side, 1 = loud edge
-
-            SDL_Color color;
-
-            if (t < 0.75f)   // mostly green zone
-            {
-                float k = t / 0.75f;
-                color.r = (Uint8)(k * 255);
-                color.g = 255;
-                color.b = 0;
-            }
-            else             // red only near the peak
-            {
-                float k = (t - 0.75f) / 0.25f;
-                color.r = 255;
-                color.g = (Uint8)((1.0f - k) * 255);
-                color.b = 0;
-            }
-
-            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
-
-            SDL_Rect slice = { rect.x + x, y, 1, barHeight - barSpacing };
-            SDL_RenderFillRect(renderer, &slice);
-        }
-
-        /* ---- Peak cap handling ---- */
-        float targetPeak = value * rect.w;
-
-        if (targetPeak > spectrumPeaks[i])
-            spectrumPeaks[i] = targetPeak;
-        else
-        {
-            spectrumPeaks[i] -= PEAK_FALL_SPEED;
-            if (spectrumPeaks[i] < 0) spectrumPeaks[i] = 0;
-        }
-
-        SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-
-        SDL_Rect peakRect = {
-            rect.x + (int)spectrumPeaks[i],
-            y,
-            2,
-            barHeight - barSpacing
-        };
-
-        SDL_RenderFillRect(renderer, &peakRect);
-    }
+    spectrumEngineRun(window.data(), bandValues, g_uiSteps);
 }
 
-
-
 static void getScrollingText(const char* fullText, char* out, size_t outSize)
 {
     const int visibleChars   = 37;
@@ -879,36 +819,39 @@ static void getScrollingText(const char* fullText, char* out, size_t outSize)
         return;
     }
 
-    // Handle pause at edges
-    if (scrollPause > 0)
+    for (int step = 0; step < g_uiSteps; step++)
     {
-        scrollPause--;
-    }
-    else
-    {
-        scrollTimer++;
-        if (scrollTimer >= scrollSpeed)
+        // Handle pause at edges
+        if (scrollPause > 0)
+        {
+            scrollPause--;
+        }
+        else
         {
-            scrollTimer = 0;
+            scrollTimer++;
+            if (scrollTimer >= scrollSpeed)
+            {
+                scrollTimer = 0;
 
-            if (scrollForward)
-                scrollOffset++;
-            else
-                scrollOffset--;
+                if (scrollForward)
+                    scrollOffset++;
+                else
+                    scrollOffset--;
 
-            // Hit right end
-            if (scrollOffset >= len - visibleChars)
-            {
-                scrollOffset = len - visibleChars;
-                scrollForward = false;
-                scrollPause = pauseDuration;
-            }
-            // Hit left end
-            else if (scrollOffset <= 0)
-            {
-                scrollOffset = 0;
-                scrollForward = true;
-                scrollPause = pauseDuration;
+                // Hit right end
+                if (scrollOffset >= len - visibleChars)
+                {
+                    scrollOffset = len - visibleChars;
+                    scrollForward = false;
+                    scrollPause = pauseDuration;
+                }
+                // Hit left end
+                else if (scrollOffset <= 0)
+                {
+                    scrollOffset = 0;
+                    scrollForward = true;
+                    scrollPause = pauseDuration;
+                }
             }
         }
     }
@@ -949,15 +892,14 @@ void drawVerticalText(SDL_Renderer* renderer,
 {
     if (!font || !text) return;
 
-    SDL_Surface* s = TTF_RenderText_Solid(font, text, color);
-    if (!s) return;
-
-    SDL_Texture* t = SDL_CreateTextureFromSurface(renderer, s);
-    if (!t) { SDL_FreeSurface(s); return; }
+    // Glyphs come from the font's atlas; nothing is rasterised here
+    // once a string's characters have been seen
+    int textW = textAtlasPrepare(renderer, font, text);
+    if (textW <= 0) return;
 
     SDL_Rect dst;
-    dst.w = s->w;
-    dst.h = s->h;
+    dst.w = textW;
+    dst.h = TTF_FontHeight(font);
 
     // Horizontal position (after rotation)
     dst.x = rect.x + rect.w - dst.h + paddingX;
@@ -978,11 +920,8 @@ void drawVerticalText(SDL_Renderer* renderer,
             break;
     }
 
-    SDL_Point center = {0, 0};
-    SDL_RenderCopyEx(renderer, t, NULL, &dst, 90.0, &center, SDL_FLIP_NONE);
-
-    SDL_DestroyTexture(t);
-    SDL_FreeSurface(s);
+    // Rotated 90° about dst's top-left corner, as before
+    textAtlasDraw(renderer, dst.x, dst.y, color);
 }
 
 // Backward-compatible wrapper (old calls still work)
@@ -1085,21 +1024,33 @@ static const SDL_Rect EQ_BAR_SRC[28] =
     { 96, 846, 244, 21}
 };
 
+// Which bar sprite and where the knob goes for a slider at db;
+// the two numbers are everything a slider's pixels depend on
+static void eqSliderSprite(float db, const SDL_Rect& track, int* level, int* knobX)
+{
+    float t = (db + 12.0f) / 24.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+
+    int l = (int)(t * 27.0f + 0.5f);
+    if (l < 0) l = 0;
+    if (l > 27) l = 27;
+    *level = l;
+
+    // movement based on UI size, NOT texture size
+    const int knobW = 37;
+    int travel = track.w - knobW;
+    *knobX = track.x + (int)(t * travel);
+}
+
 static void drawPreampSlider(SDL_Renderer* renderer,
                              SDL_Texture* texEQ,
                              const SDL_Rect& track)
 {
     if (!renderer || !texEQ) return;
 
-    float db = g_equalizer.getPreamp();
-
-    float t = (db + 12.0f) / 24.0f;
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-
-    int level = (int)(t * 27.0f + 0.5f);
-    if (level < 0) level = 0;
-    if (level > 27) level = 27;
+    int level, knobX;
+    eqSliderSprite(g_equalizer.getPreamp(), track, &level, &knobX);
 
     SDL_Rect srcBar = EQ_BAR_SRC[level];
 
@@ -1119,10 +1070,6 @@ static void drawPreampSlider(SDL_Renderer* renderer,
     // --- KNOB ---
     SDL_Rect srcKnob = { 564, 3, 37, 37 };
 
-    // movement based on UI size, NOT texture size
-    int travel = track.w - srcKnob.w;
-    int knobX  = track.x + (int)(t * travel);
-
     SDL_Rect dstKnob = {
         knobX,
         track.y + (track.h - srcKnob.h) / 2, // center vertically
@@ -1140,15 +1087,8 @@ static void drawEQBandSlider(SDL_Renderer* renderer,
 {
     if (!renderer || !texEQ) return;
 
-    float db = g_equalizer.getBand(bandIndex);
-
-    float t = (db + 12.0f) / 24.0f;
-    if (t < 0.0f) t = 0.0f;
-    if (t > 1.0f) t = 1.0f;
-
-    int level = (int)(t * 27.0f + 0.5f);
-    if (level < 0) level = 0;
-    if (level > 27) level = 27;
+    int level, knobX;
+    eqSliderSprite(g_equalizer.getBand(bandIndex), track, &level, &knobX);
 
     SDL_Rect srcBar = EQ_BAR_SRC[level];
 
@@ -1168,9 +1108,6 @@ static void drawEQBandSlider(SDL_Renderer* renderer,
     // --- KNOB ---
     SDL_Rect srcKnob = { 564, 3, 37, 37 };
 
-    int travel = track.w - srcKnob.w;
-    int knobX  = track.x + (int)(t * travel);
-
     SDL_Rect dstKnob = {
         knobX,
         track.y + (track.h - srcKnob.h) / 2,
@@ -1183,20 +1120,409 @@ static void drawEQBandSlider(SDL_Renderer* renderer,
 
 
 
+/* -------------------------------------------------------
+   Retained base layer
+   The skin and every widget that only changes when player
+   state does (transport, shuffle/repeat, EQ buttons and
+   sliders, volume, pan, playlist slider and buttons) are
+   composited into one screen-sized render target. Each
+   widget keeps a key of the state it was last drawn with —
+   its dirty flag — so a frame where nothing moved is a
+   single copy of the target. When a key changes, only that
+   widget's bounds are rebuilt: skin first, then every base
+   widget touching the bounds, clipped to them, so a
+   neighbour that overlaps keeps its pixels.
+
+   The progress indicator, EQ curve, spectrum, text and the
+   playlist are drawn over it every frame.
+------------------------------------------------------- */
+struct UiTextures
+{
+    SDL_Texture* skin;
+    SDL_Texture* volume;
+    SDL_Texture* pan;
+    SDL_Texture* playlistKnob;
+    SDL_Texture* cbuttons;
+    SDL_Texture* shufrep;
+    SDL_Texture* eqmain;
+};
+
+enum BaseWidget
+{
+    BASE_CBUTTONS,
+    BASE_SHUFREP,
+    BASE_EQ_BUTTONS,
+    BASE_EQ_SLIDERS,
+    BASE_PLAYLIST_SLIDER,
+    BASE_VOLUME,
+    BASE_PAN,
+    BASE_PLAYLIST_BUTTONS,
+    BASE_WIDGET_COUNT
+};
+
+struct BaseWidgetInfo
+{
+    SDL_Rect bounds;      // everything the widget can touch
+    int      drawCalls;   // SDL copies/fills per draw
+};
+
+// Knobs overhang their tracks by a few px; the bounds include that
+static const BaseWidgetInfo g_baseInfo[BASE_WIDGET_COUNT] =
+{
+    { {1340,  60, 100, 562},  6 },   // prev .. eject
+    { {1357, 642,  72, 298},  2 },   // shuffle + repeat
+    { {1112,  53,  73, 968},  3 },   // EQ on, auto, presets
+    { { 730,  86, 340, 904}, 22 },   // preamp + 10 bands, bar + knob each
+    { { 208,1030, 326,  30},  1 },
+    { {1552, 421,  44, 264},  2 },
+    { {1558, 694,  40, 154},  2 },
+    { {  70,  42, 100, 951},  5 },
+};
+
+static const SDL_Rect prevButton    = {1340,  60,100, 90};
+static const SDL_Rect playButton    = {1340, 151,100, 90};
+static const SDL_Rect pauseButton   = {1340, 242,100, 90};
+static const SDL_Rect stopButton    = {1340, 332,100, 90};
+static const SDL_Rect nextButton    = {1340, 426,100, 90};
+static const SDL_Rect ejectButton   = {1340, 532,100, 90};
+static const SDL_Rect shuffleButton = {1357, 642, 72,182};
+static const SDL_Rect repeatButton  = {1357, 825, 72,115};
+
+static const SDL_Rect eqPreset1     = {1112,  53, 73,104};
+static const SDL_Rect eqPreset2     = {1112, 153, 73,131};
+static const SDL_Rect eqPreset3     = {1112, 851, 73,170};
+
+// [0] is the preamp, [1..10] the bands
+static const SDL_Rect eqBandRects[11] =
+{
+    {730,   90,340, 33},
+    {730,  315,340, 33},
+    {730,  387,340, 33},
+    {730,  457,340, 33},
+    {730,  532,340, 33},
+    {730,  603,340, 33},
+    {730,  671,340, 33},
+    {730,  743,340, 33},
+    {730,  813,340, 33},
+    {730,  885,340, 33},
+    {730,  953,340, 33},
+};
+
+static const SDL_Rect volumeBarRect = {1552, 421, 40, 264}; // adjust to your skin
+static const SDL_Rect panSlider     = {1558, 698,40,145};
+
+static const SDL_Rect addPlaylist   = {70,  42,100,100};
+static const SDL_Rect rmPlaylist    = {70, 158,100,100};
+static const SDL_Rect selPlaylist   = {70, 270,100,100};
+static const SDL_Rect miscPlaylist  = {70, 383,100,100};
+static const SDL_Rect ListOptions   = {70, 893,100,100};
+
+static SDL_Texture*  g_base          = nullptr;
+static bool          g_baseValid     = false;
+static bool          g_baseFailed    = false;   // no render targets: draw directly
+static uint32_t      g_baseKeys[BASE_WIDGET_COUNT];
+static UiRenderStats g_uiStats;
+
+static uint32_t keyMix(uint32_t h, uint32_t v)
+{
+    return (h ^ v) * 16777619u;   // FNV-1a step
+}
+
+static uint32_t keyMixFloat(uint32_t h, float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return keyMix(h, v);
+}
+
+// Everything the widget's look depends on
+static uint32_t baseWidgetKey(int widget)
+{
+    uint32_t h = 2166136261u;
+
+    switch (widget)
+    {
+        case BASE_CBUTTONS:
+        {
+            bool isPlaying = playerIsPlaying();
+            bool isPaused  = playerIsPaused();
+            h = keyMix(h, uiPrevPressed);
+            h = keyMix(h, uiPlayPressed || (isPlaying && !isPaused));
+            h = keyMix(h, uiPausePressed || isPaused);
+            h = keyMix(h, uiNextPressed);
+            break;
+        }
+        case BASE_SHUFREP:
+            h = keyMix(h, playerIsShuffleEnabled());
+            h = keyMix(h, (uint32_t)g_state.repeat);
+            break;
+
+        case BASE_EQ_BUTTONS:
+            h = keyMix(h, g_equalizer.isEnabled());
+            h = keyMix(h, autoEQEnabled);
+            h = keyMix(h, eqPreset3press);
+            break;
+
+        case BASE_EQ_SLIDERS:
+        {
+            // Sprite positions, worked out again only when the EQ
+            // version moves; a band change too small to shift a knob
+            // by a pixel leaves the sliders clean
+            static uint32_t version = ~0u;
+            static uint32_t sprites = 0;
+            if (g_equalizer.getVersion() != version)
+            {
+                version = g_equalizer.getVersion();
+                sprites = 2166136261u;
+                for (int b = 0; b <= 10; b++)
+                {
+                    int level, knobX;
+                    float db = b ? g_equalizer.getBand(b) : g_equalizer.getPreamp();
+                    eqSliderSprite(db, eqBandRects[b], &level, &knobX);
+                    sprites = keyMix(keyMix(sprites, level), knobX);
+                }
+            }
+            h = keyMix(h, sprites);
+            break;
+        }
+
+        case BASE_PLAYLIST_SLIDER:
+            h = keyMix(h, (uint32_t)playlistGetCount());
+            h = keyMix(h, (uint32_t)playlistGetScroll());
+            h = keyMix(h, (uint32_t)playlistGetMaxVisible());
+            break;
+
+        case BASE_VOLUME:
+            h = keyMixFloat(h, playerGetVolume());
+            break;
+
+        case BASE_PAN:
+            h = keyMixFloat(h, playerGetPan());
+            break;
+
+        default:   // playlist buttons never change
+            break;
+    }
+    return h;
+}
+
+static void drawBaseWidget(SDL_Renderer* renderer, const UiTextures& t, int widget)
+{
+    switch (widget)
+    {
+        case BASE_CBUTTONS:
+        {
+            bool isPlaying = playerIsPlaying();
+            bool isPaused  = playerIsPaused();
+
+            DrawCButton(renderer, t.cbuttons, BTN_PREV,  prevButton,  uiPrevPressed);
+            DrawCButton(renderer, t.cbuttons, BTN_PLAY,  playButton,  uiPlayPressed || (isPlaying && !isPaused));
+            DrawCButton(renderer, t.cbuttons, BTN_PAUSE, pauseButton, uiPausePressed || isPaused);
+            DrawCButton(renderer, t.cbuttons, BTN_STOP,  stopButton,  false);
+            DrawCButton(renderer, t.cbuttons, BTN_NEXT,  nextButton,  uiNextPressed);
+            DrawCButton(renderer, t.cbuttons, BTN_EJECT, ejectButton, false);
+            break;
+        }
+        case BASE_SHUFREP:
+            // Winamp: button only looks "pressed" on state change frame
+            DrawShuf(renderer, t.shufrep, shuf_src, shuffleButton,
+                     playerIsShuffleEnabled(), false);
+            DrawRepeat(renderer, t.shufrep, rep_src, repeatButton);
+            break;
+
+        case BASE_EQ_BUTTONS:
+            drawEQPresetButton(renderer, t.eqmain, eqPreset1, g_equalizer.isEnabled(), 1);
+            drawEQPresetButton(renderer, t.eqmain, eqPreset2, autoEQEnabled, 2);
+            drawEQPresetButton(renderer, t.eqmain, eqPreset3, eqPreset3press, 3);
+            break;
+
+        case BASE_EQ_SLIDERS:
+            for (int b = 1; b <= 10; b++)
+                drawEQBandSlider(renderer, t.eqmain, b, eqBandRects[b]);
+            drawPreampSlider(renderer, t.eqmain, eqBandRects[0]);
+            break;
+
+        case BASE_PLAYLIST_SLIDER:
+            drawPlaylistSlider(renderer, t.playlistKnob);
+            break;
+
+        case BASE_VOLUME:
+            drawVolumeBar(renderer, t.volume, volumeBarRect);
+            break;
+
+        case BASE_PAN:
+            drawPanSlider(renderer, t.pan, panSlider);
+            break;
+
+        case BASE_PLAYLIST_BUTTONS:
+            drawRect(renderer, addPlaylist, 150,150,0,150);
+            drawRect(renderer, rmPlaylist, 0,150,150,150);
+            drawRect(renderer, selPlaylist, 150,150,0,150);
+            drawRect(renderer, miscPlaylist, 0,150,150,150);
+            drawRect(renderer, ListOptions, 150,150,0,150);
+            break;
+    }
+}
+
+static int baseDirectDrawCalls()
+{
+    int n = 1;   // skin
+    for (int w = 0; w < BASE_WIDGET_COUNT; w++)
+        n += g_baseInfo[w].drawCalls;
+    return n;
+}
+
+static void drawSkin(SDL_Renderer* renderer, SDL_Texture* skin)
+{
+    if (!skin) return;
+    SDL_Rect dst = {0,0,FB_W,FB_H};
+    SDL_RenderCopy(renderer, skin, NULL, &dst);
+}
+
+static bool baseLayerCreate(SDL_Renderer* renderer)
+{
+    g_base = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                               SDL_TEXTUREACCESS_TARGET, FB_W, FB_H);
+    if (!g_base)
+    {
+        printf("[UI] Base layer target failed: %s; drawing the skin every frame\n",
+               SDL_GetError());
+        g_baseFailed = true;
+        return false;
+    }
+    SDL_SetTextureBlendMode(g_base, SDL_BLENDMODE_NONE);   // opaque, covers the screen
+    g_baseValid = false;
+    return true;
+}
+
+// Brings the base layer up to date and copies it to the screen
+static void baseLayerDraw(SDL_Renderer* renderer, const UiTextures& t)
+{
+    const int direct = baseDirectDrawCalls();
+    g_uiStats.frames++;
+    g_uiStats.directDraws += direct;
+
+    if (!g_base && (g_baseFailed || !baseLayerCreate(renderer)))
+    {
+        drawSkin(renderer, t.skin);
+        for (int w = 0; w < BASE_WIDGET_COUNT; w++)
+            drawBaseWidget(renderer, t, w);
+        g_uiStats.baseDraws += direct;
+        return;
+    }
+
+    uint32_t keys[BASE_WIDGET_COUNT];
+    bool dirty[BASE_WIDGET_COUNT];
+    bool anyDirty = !g_baseValid;
+    for (int w = 0; w < BASE_WIDGET_COUNT; w++)
+    {
+        keys[w]  = baseWidgetKey(w);
+        dirty[w] = keys[w] != g_baseKeys[w];
+        anyDirty |= dirty[w];
+    }
+
+    if (anyDirty)
+    {
+        SDL_SetRenderTarget(renderer, g_base);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+
+        if (!g_baseValid)
+        {
+            SDL_RenderClear(renderer);
+            drawSkin(renderer, t.skin);
+            for (int w = 0; w < BASE_WIDGET_COUNT; w++)
+                drawBaseWidget(renderer, t, w);
+            g_uiStats.baseRebuilds++;
+            g_uiStats.baseDraws += direct;
+            g_baseValid = true;
+        }
+        else
+        {
+            for (int w = 0; w < BASE_WIDGET_COUNT; w++)
+            {
+                if (!dirty[w]) continue;
+
+                const SDL_Rect& clip = g_baseInfo[w].bounds;
+                SDL_RenderSetClipRect(renderer, &clip);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+                SDL_RenderFillRect(renderer, &clip);
+                drawSkin(renderer, t.skin);
+                g_uiStats.baseDraws += 2;
+
+                for (int n = 0; n < BASE_WIDGET_COUNT; n++)
+                {
+                    if (!SDL_HasIntersection(&clip, &g_baseInfo[n].bounds)) continue;
+                    drawBaseWidget(renderer, t, n);
+                    g_uiStats.baseDraws += g_baseInfo[n].drawCalls;
+                }
+                g_uiStats.regionRedraws++;
+            }
+            SDL_RenderSetClipRect(renderer, NULL);
+        }
+
+        SDL_SetRenderTarget(renderer, NULL);
+        memcpy(g_baseKeys, keys, sizeof(g_baseKeys));
+    }
+
+    SDL_RenderCopy(renderer, g_base, NULL, NULL);
+    g_uiStats.baseDraws++;
+}
+
+void uiShutdown()
+{
+    if (g_eqCurveGlow) SDL_DestroyTexture(g_eqCurveGlow);
+    if (g_eqCurveCore) SDL_DestroyTexture(g_eqCurveCore);
+    g_eqCurveGlow   = g_eqCurveCore = nullptr;
+    g_eqCurveValid  = false;
+    g_eqCurveFailed = false;
+
+    if (g_base) SDL_DestroyTexture(g_base);
+    g_base       = nullptr;
+    g_baseValid  = false;
+    g_baseFailed = false;
+}
+
+UiRenderStats uiTakeRenderStats()
+{
+    UiRenderStats s = g_uiStats;
+    s.eqCurveBuilds = g_eqCurveBuilds;
+    g_uiStats = UiRenderStats{};
+    g_eqCurveBuilds = 0;
+    return s;
+}
+
+
+// 60 Hz frames since the previous call, rounded, at least 1
+static int uiFrameSteps()
+{
+    static u64 last  = 0;
+    static s64 carry = 0;
+    const s64 frame  = 19200000 / 60;
+
+    u64 now = svcGetSystemTick();
+    if (!last) { last = now; return 1; }
+
+    carry += (s64)(now - last);
+    last   = now;
+
+    s64 steps = (carry + frame / 2) / frame;
+    if (steps < 1)  steps = 1;
+    if (steps > 60) { steps = 60; carry = 0; }   // back from the background
+    else carry -= steps * frame;
+    return (int)steps;
+}
+
 // --- Render full UI ---
 void uiRender(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontBig, SDL_Texture* skin, SDL_Texture* texProgIndicator, SDL_Texture* texVolume, SDL_Texture* texPan,  SDL_Texture* texPlaylistKnob, SDL_Texture* texCbuttons, SDL_Texture* texSHUFREP,  SDL_Texture* texEQMAIN,const char* songText)
 {
-  if (!fftInitialized)
-  {
-      uiInitFFT();
-      fftInitialized = true;
-  }
+  g_uiSteps = uiFrameSteps();
 
   if (uiPressTimer > 0)
   {
-      uiPressTimer--;
-      if (uiPressTimer == 0)
+      uiPressTimer -= g_uiSteps;
+      if (uiPressTimer <= 0)
       {
+          uiPressTimer   = 0;
           uiPrevPressed  = false;
           uiNextPressed  = false;
           uiPlayPressed  = false;
@@ -1208,15 +1534,10 @@ void uiRender(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontBig, SDL_Tex
     int elapsed = playerGetElapsedSeconds();
     snprintf(liveTime, sizeof(liveTime), "%02d:%02d", elapsed / 60, elapsed % 60);
 
-    // Clear screen
-    SDL_RenderClear(renderer);
-
-    // Draw skin background
-    if (skin)
-    {
-        SDL_Rect dst = {0,0,FB_W,FB_H};
-        SDL_RenderCopy(renderer, skin, NULL, &dst);
-    }
+    // Skin and static widgets, from the retained layer
+    UiTextures tex = { skin, texVolume, texPan, texPlaylistKnob,
+                       texCbuttons, texSHUFREP, texEQMAIN };
+    baseLayerDraw(renderer, tex);
 
     SDL_Rect progBar        = {1467,  64,  61, 982};
     SDL_Rect progIndicatorR = {1469,  577, 62, 113};
@@ -1229,49 +1550,6 @@ void uiRender(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontBig, SDL_Tex
     SDL_Rect kHzInfo       = {1639, 600, 57, 55};
 //    SDL_Rect playlistFiles = {215,   50,310,950};
 
-    SDL_Rect prevButton    = {1340,  60,100, 90};
-    SDL_Rect playButton    = {1340, 151,100, 90};
-    SDL_Rect pauseButton   = {1340, 242,100, 90};
-    SDL_Rect stopButton    = {1340, 332,100, 90};
-    SDL_Rect nextButton    = {1340, 426,100, 90};
-    SDL_Rect ejectButton   = {1340, 532,100, 90};
-    SDL_Rect shuffleButton = {1357, 642, 72,182};
-    SDL_Rect repeatButton  = {1357, 825, 72,115};
-
-    bool isPlaying = playerIsPlaying();
-    bool isPaused  = playerIsPaused();   // add this getter if missing
-
-    DrawCButton(renderer, texCbuttons, BTN_PREV,  prevButton,  uiPrevPressed);
-    DrawCButton(renderer, texCbuttons, BTN_PLAY,  playButton,  uiPlayPressed || (isPlaying && !isPaused));
-    DrawCButton(renderer, texCbuttons, BTN_PAUSE, pauseButton, uiPausePressed || isPaused);
-    DrawCButton(renderer, texCbuttons, BTN_STOP,  stopButton,  false);
-    DrawCButton(renderer, texCbuttons, BTN_NEXT,  nextButton,  uiNextPressed);
-    DrawCButton(renderer, texCbuttons, BTN_EJECT, ejectButton, false);
-
-    // --- Shuffle / Repeat ---
-    bool shuffleEnabled = playerIsShuffleEnabled();
-    bool repeatEnabled  = playerIsRepeatEnabled();
-
-    // Winamp: button only looks "pressed" on state change frame
-    bool shufflePressed = false;
-    bool repeatPressed  = false;
-
-    DrawShuf(
-        renderer,
-        texSHUFREP,
-        shuf_src,
-        shuffleButton,
-        shuffleEnabled,
-        shufflePressed
-    );
-
-    DrawRepeat(
-        renderer,
-        texSHUFREP,
-        rep_src,
-        repeatButton
-    );
-
     SDL_Rect monoRect   = {1670, 835, 30, 90};
     SDL_Rect stereoRect = {1670, 940, 30, 90};
 
@@ -1280,101 +1558,13 @@ void uiRender(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontBig, SDL_Tex
 
     renderEQCurve(renderer);
 
-    SDL_Rect eqBand1       = {730,   90,340, 33}; //preamp
-    SDL_Rect eqBand2       = {730,  315,340, 33};
-    SDL_Rect eqBand3       = {730,  387,340, 33};
-    SDL_Rect eqBand4       = {730,  457,340, 33};
-    SDL_Rect eqBand5       = {730,  532,340, 33};
-    SDL_Rect eqBand6       = {730,  603,340, 33};
-    SDL_Rect eqBand7       = {730,  671,340, 33};
-    SDL_Rect eqBand8       = {730,  743,340, 33};
-    SDL_Rect eqBand9       = {730,  813,340, 33};
-    SDL_Rect eqBand10      = {730,  885,340, 33};
-    SDL_Rect eqBand11      = {730,  953,340, 33};
-
-    SDL_Rect eqPreset1     = {1112,  53, 73,104};
-    SDL_Rect eqPreset2     = {1112, 153, 73,131};
-    SDL_Rect eqPreset3     = {1112, 851, 73,170};
-
-    drawPlaylistSlider(renderer, texPlaylistKnob);
-
-    drawEQBandSlider(renderer, texEQMAIN, 1, eqBand2);
-    drawEQBandSlider(renderer, texEQMAIN, 2, eqBand3);
-    drawEQBandSlider(renderer, texEQMAIN, 3, eqBand4);
-    drawEQBandSlider(renderer, texEQMAIN, 4, eqBand5);
-    drawEQBandSlider(renderer, texEQMAIN, 5, eqBand6);
-    drawEQBandSlider(renderer, texEQMAIN, 6, eqBand7);
-    drawEQBandSlider(renderer, texEQMAIN, 7, eqBand8);
-    drawEQBandSlider(renderer, texEQMAIN, 8, eqBand9);
-    drawEQBandSlider(renderer, texEQMAIN, 9, eqBand10);
-    drawEQBandSlider(renderer, texEQMAIN, 10, eqBand11);
-
-    drawPreampSlider(renderer, texEQMAIN, eqBand1);
-
-
-    SDL_Rect volumeBarRect = { 1552, 421, 40, 264 }; // adjust to your skin
-
-    drawVolumeBar(renderer, texVolume, volumeBarRect);
-
-
-    SDL_Rect panSlider     = {1558, 698,40,145};
-
-    SDL_Rect addPlaylist   = {70,  42,100,100};
-    SDL_Rect rmPlaylist    = {70, 158,100,100};
-    SDL_Rect selPlaylist   = {70, 270,100,100};
-    SDL_Rect miscPlaylist  = {70, 383,100,100};
-    SDL_Rect ListOptions   = {70, 893,100,100};
     SDL_Rect Duration      = {45, 765,50,100};
     SDL_Rect TotPylDurat   = {109, 512,63, 358};
 
-    drawEQPresetButton(renderer, texEQMAIN, eqPreset1, g_equalizer.isEnabled(), 1);
-    drawEQPresetButton(renderer, texEQMAIN, eqPreset2, autoEQEnabled, 2);
-    drawEQPresetButton(renderer, texEQMAIN, eqPreset3, eqPreset3press, 3);
-
-
-    drawPanSlider(renderer, texPan, panSlider);
-
-    drawRect(renderer, addPlaylist, 150,150,0,150);
-    drawRect(renderer, rmPlaylist, 0,150,150,150);
-    drawRect(renderer, selPlaylist, 150,150,0,150);
-    drawRect(renderer, miscPlaylist, 0,150,150,150);
-    drawRect(renderer, ListOptions, 150,150,0,150);
-
     computeSpectrum();
 
     SDL_Rect spectrumRect = {1592, 90, 93, 306};
-    drawWinampSpectrumVertical(renderer, spectrumRect, bandValues);
-
-    for (int i = 0; i < SPECTRUM_BARS; i++)
-    {
-        float v = bandValues[i];
-
-        if (v >= spectrumPeaks[i])
-        {
-            spectrumPeaks[i] = v;
-
-            peakHold[i] = 18;
-
-            spectrumFallSpeed[i] = 0.0f;
-        }
-        else
-        {
-            if (peakHold[i] > 0)
-            {
-                peakHold[i]--;
-            }
-            else
-            {
-                // gravity acceleration
-                spectrumFallSpeed[i] += 0.0025f;
-
-                spectrumPeaks[i] -= spectrumFallSpeed[i];
-
-                if (spectrumPeaks[i] < 0)
-                    spectrumPeaks[i] = 0;
-            }
-        }
-    }
+    spectrumViewDraw(renderer, spectrumRect, bandValues, spectrumEngineBars(), g_uiSteps);
 
     SDL_Color green = {0, 255, 0, 255};
 
@@ -1408,7 +1598,7 @@ if (currentTrackIndex >= 0)
 
             // --- Subtle glow animation ---
             static float infoGlowTime = 0.0f;
-            infoGlowTime += 0.04f;  // slower than mono/stereo
+            infoGlowTime += 0.04f * g_uiSteps;  // slower than mono/stereo
 
             float glowWave = (sinf(infoGlowTime) + 1.0f) * 0.5f;  // 0–1
 
@@ -1467,9 +1657,4 @@ if (currentTrackIndex >= 0)
                       25,      // horizontal padding
                       10,      // top padding
                       ALIGN_TOP);
-
-
-    // --- Playlist ---
-    renderPlaylist(renderer, font);
-
 }
@@ -1,11 +1,29 @@
 #pragma once
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include <stdint.h>
 
 void spectrumReset();
 
 void drawRect(SDL_Renderer* renderer, SDL_Rect r, Uint8 rC, Uint8 gC, Uint8 bC, Uint8 aC);
 
+// Counters for the retained base layer (skin + static widgets)
+struct UiRenderStats
+{
+    uint32_t frames        = 0;
+    uint32_t baseRebuilds  = 0;   // full recomposites of the layer
+    uint32_t regionRedraws = 0;   // dirty widget regions redrawn into it
+    uint32_t baseDraws     = 0;   // SDL draw calls spent on skin + widgets
+    uint32_t directDraws   = 0;   // what drawing them to the screen would cost
+    uint32_t eqCurveBuilds = 0;   // EQ curve layers re-baked
+};
+
+// Counters since the last call, then reset
+UiRenderStats uiTakeRenderStats();
+
+// Drops the base layer and EQ curve targets (before the renderer goes)
+void uiShutdown();
+
 void uiRender(SDL_Renderer* renderer, TTF_Font* font, TTF_Font* fontBig, SDL_Texture* skin, SDL_Texture* texProgIndicator, SDL_Texture* texVolume, SDL_Texture* texPan, SDL_Texture* texPlaylistKnob, SDL_Texture* texCbuttons, SDL_Texture* texSHUFREP, SDL_Texture* texEQMAIN,const char* songText);
 
 
@@ -1,6 +1,9 @@
 #include "wav.h"
 #include "playlist.h"
 #include "player.h"
+#include "metacache.h"
+#include "scanpool.h"
+#include "readahead.h"
 #include <switch.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,86 +12,34 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <math.h>
+#ifndef __SWITCH__
+#include <sys/mman.h>
+#endif
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
-/* -------------------------------------------------------
-   Cache
-------------------------------------------------------- */
-#define WAV_CACHE_VERSION  1
-#define WAV_CACHE_PATH     "sdmc:/config/winamp/wav_cache.bin"
-#define WAV_CACHE_TMP_PATH "sdmc:/config/winamp/wav_cache.bin.tmp"
-
-struct WavCacheHeader { uint32_t magic; uint32_t version; };
-struct WavCacheEntry  { char path[512]; time_t mtime; Mp3MetadataEntry meta; };
-
-static std::unordered_map<std::string, WavCacheEntry> g_wavCache;
-static bool g_wavCacheLoaded = false;
-
 /* -------------------------------------------------------
    Scanner state
 ------------------------------------------------------- */
-static Thread  g_wavThread;
-static bool    g_wavThreadRunning = false;
-static Mutex   g_wavMetaMutex;
-static Mutex   g_wavScanMutex;
-static bool    g_wavMutexInited   = false;
 static char    g_wavLoadedFolder[512] = {0};
-
-struct WavScanJob { std::string path; int localIndex; int generation; };
-
-static std::vector<WavScanJob>         g_wavScanQueue;
-static std::unordered_set<std::string> g_wavScanQueued;
-static std::vector<RuntimeMetadata>    g_wavPlaylistMeta;
-static int                             g_wavScanGeneration = 0;
-
-/* -------------------------------------------------------
-   Helpers
-------------------------------------------------------- */
-static void wavEnsureMutexInited()
-{
-    if (!g_wavMutexInited)
-    {
-        mutexInit(&g_wavMetaMutex);
-        mutexInit(&g_wavScanMutex);
-        g_wavMutexInited = true;
-    }
-}
-
-static bool wavCacheValid(const WavCacheEntry& e)
-{
-    struct stat st;
-    if (stat(e.path, &st) != 0) return false;
-    return st.st_mtime == e.mtime;
-}
-
-static bool wavPlaylistHasPath(const char* path)
-{
-    for (auto& m : g_wavPlaylistMeta)
-        if (strcmp(m.path, path) == 0) return true;
-    return false;
-}
-
-static void ensureCacheDir()
-{
-    mkdir("sdmc:/config",        0777);
-    mkdir("sdmc:/config/winamp", 0777);
-}
+static int     g_wavTrackCount = 0;
 
 /* -------------------------------------------------------
    RIFF/WAV header parser
    Handles the common subset of WAV:
      - PCM (format 1)  — 8, 16, 24, 32-bit
-     - IEEE float (format 3) — 32-bit
+     - IEEE float (format 3) — 32, 64-bit
      - WAVE_FORMAT_EXTENSIBLE (format 0xFFFE) — falls back to sub-format
+     - RF64 (>4 GB) — 64-bit data size taken from the ds64 chunk
    Skips unknown chunks so files with metadata chunks (LIST,
    id3 , bext, etc.) parse correctly.
 ------------------------------------------------------- */
 static uint16_t readU16LE(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
 static uint32_t readU32LE(const uint8_t* p) { return (uint32_t)(p[0] | (p[1]<<8) | (p[2]<<16) | (p[3]<<24)); }
+static uint64_t readU64LE(const uint8_t* p) { return (uint64_t)readU32LE(p) | ((uint64_t)readU32LE(p + 4) << 32); }
 
 static bool parseWavHeader(FILE* f, WavDecoder* wd)
 {
@@ -99,8 +50,10 @@ static bool parseWavHeader(FILE* f, WavDecoder* wd)
         memcmp(riff,     "RF64", 4) != 0)        return false;
     if (memcmp(riff + 8, "WAVE", 4) != 0)        return false;
 
-    bool fmtFound  = false;
-    bool dataFound = false;
+    bool     rf64      = (memcmp(riff, "RF64", 4) == 0);
+    uint64_t ds64Data  = 0;
+    bool     fmtFound  = false;
+    bool     dataFound = false;
 
     // Walk chunks until we have both fmt and data
     while (!dataFound)
@@ -133,16 +86,35 @@ static bool parseWavHeader(FILE* f, WavDecoder* wd)
 
             fmtFound = true;
         }
+        else if (memcmp(id, "ds64", 4) == 0 && rf64)
+        {
+            // riffSize:8, dataSize:8, sampleCount:8, table...
+            uint8_t ds[24] = {0};
+            size_t toRead = size < sizeof(ds) ? size : sizeof(ds);
+            if (fread(ds, 1, toRead, f) != toRead) return false;
+            if (size > toRead) fseek(f, (long)(size - toRead + (size & 1)), SEEK_CUR);
+            if (toRead >= 16) ds64Data = readU64LE(ds + 8);
+        }
         else if (memcmp(id, "data", 4) == 0)
         {
             if (!fmtFound) return false;
-            wd->dataOffset = ftell(f);
-            wd->dataBytes  = size;
+            wd->dataOffset = (uint64_t)ftell(f);
+
+            uint64_t size64 = size;
+            if (rf64 && size == 0xFFFFFFFF) size64 = ds64Data;
+
+            // Streamed/aborted recordings often carry a bogus size —
+            // never trust it past the end of the file.
+            struct stat st;
+            if (fstat(fileno(f), &st) == 0 &&
+                wd->dataOffset + size64 > (uint64_t)st.st_size)
+                size64 = (uint64_t)st.st_size - wd->dataOffset;
+            wd->dataBytes = size64;
 
             uint32_t bytesPerFrame =
                 (wd->bitsPerSample / 8) * wd->channels;
             wd->totalSamples =
-                (bytesPerFrame > 0) ? (size / bytesPerFrame) : 0;
+                (bytesPerFrame > 0) ? (size64 / bytesPerFrame) : 0;
 
             dataFound = true;
             // leave file pointer at start of audio data
@@ -269,209 +241,249 @@ static void readWavMetadata(const char* path, Mp3MetadataEntry& entry)
 }
 
 /* -------------------------------------------------------
-   Cache I/O
+   Scan job (runs on the scanner pool)
 ------------------------------------------------------- */
-void wavLoadCache(const char* /*folderKey*/)
+void wavScanJob(const ScanJob& job)
 {
-    if (g_wavCacheLoaded) return;
-    ensureCacheDir();
-
-    FILE* f = fopen(WAV_CACHE_PATH, "rb");
-    if (!f) { g_wavCacheLoaded = true; return; }
+    // Skip the currently playing track
+    if (playerIsPlaying() &&
+        playlistGetTrackId(playlistGetCurrentIndex()) == job.id)
+        return;
 
-    WavCacheHeader h{};
-    if (fread(&h, sizeof(h), 1, f) != 1 ||
-        h.magic   != 0x57415643 ||  // 'WAVC'
-        h.version != WAV_CACHE_VERSION)
-    { fclose(f); g_wavCacheLoaded = true; return; }
+    const char* path = trackGetPath(job.id);
+    if (!path) return;
 
-    WavCacheEntry e;
-    while (fread(&e, sizeof(e), 1, f) == 1)
-        if (wavCacheValid(e))
-            g_wavCache[e.path] = e;
+    Mp3MetadataEntry entry{};
+    readWavMetadata(path, entry);
 
-    fclose(f);
-    g_wavCacheLoaded = true;
+    if (scanJobCanceled(job)) return;
+    trackSetMetadata(job.id, entry);
+    metaCachePut(path, entry);
 }
 
-static void wavAppendCache(const char* path, const Mp3MetadataEntry& meta)
+/* -------------------------------------------------------
+   Public metadata / playlist API
+------------------------------------------------------- */
+bool wavIsFolderLoaded(const char* path)
 {
-    if (!path || strncmp(path, "romfs:/", 7) == 0) return;
-    if (strstr(path, ".tmp")) return;
+    return path && strcmp(g_wavLoadedFolder, path) == 0;
+}
 
-    struct stat st;
-    if (stat(path, &st) != 0) return;
-
-    static time_t lastWrite = 0;
-    time_t now = time(nullptr);
-    if (now - lastWrite < 1) return;
-    lastWrite = now;
-
-    WavCacheEntry& e = g_wavCache[path];
-    strncpy(e.path, path, sizeof(e.path) - 1);
-    e.path[sizeof(e.path)-1] = '\0';
-    e.meta  = meta;
-    e.mtime = st.st_mtime;
-
-    FILE* f = fopen(WAV_CACHE_TMP_PATH, "wb");
-    if (!f) return;
-
-    WavCacheHeader h{ 0x57415643, WAV_CACHE_VERSION };
-    if (fwrite(&h, sizeof(h), 1, f) != 1) goto fail;
-    for (auto& [_, entry] : g_wavCache)
-        if (fwrite(&entry, sizeof(entry), 1, f) != 1) goto fail;
-
-    fflush(f); fsync(fileno(f)); fclose(f);
-    remove(WAV_CACHE_PATH);
-    rename(WAV_CACHE_TMP_PATH, WAV_CACHE_PATH);
-    return;
-fail:
-    fclose(f); remove(WAV_CACHE_TMP_PATH);
+void wavSetLoadedFolder(const char* path)
+{
+    if (!path) return;
+    strncpy(g_wavLoadedFolder, path, sizeof(g_wavLoadedFolder) - 1);
+    g_wavLoadedFolder[sizeof(g_wavLoadedFolder)-1] = '\0';
 }
 
-/* -------------------------------------------------------
-   Background scanner
-------------------------------------------------------- */
-static void wavScanThread(void*)
+void wavClearMetadata()
 {
-    while (g_wavThreadRunning)
-    {
-        WavScanJob job;
+    g_wavTrackCount = 0;   // metadata itself stays in the track table
+}
 
-        mutexLock(&g_wavScanMutex);
-        if (g_wavScanQueue.empty())
-        {
-            mutexUnlock(&g_wavScanMutex);
-            svcSleepThread(50'000'000);
-            continue;
-        }
-        job = g_wavScanQueue.front();
-        g_wavScanQueue.erase(g_wavScanQueue.begin());
-        mutexUnlock(&g_wavScanMutex);
+bool wavAddToPlaylist(const char* path)
+{
+    if (!path) return false;
 
-        mutexLock(&g_wavScanMutex);
-        bool canceled = (job.generation != g_wavScanGeneration);
-        mutexUnlock(&g_wavScanMutex);
-        if (canceled) continue;
+    TrackId id = playlistAdd(path);
+    if (id == TRACK_ID_NONE) return false;   // already in the playlist
+    g_wavTrackCount++;
 
-        if (playerIsPlaying())
-        {
-            const char* playing = playlistGetTrack(playlistGetCurrentIndex());
-            if (playing && job.path == playing) continue;
-        }
+    Mp3MetadataEntry meta{};
+    strncpy(meta.title, "Scanning...", sizeof(meta.title) - 1);
+    trackSetMetadata(id, meta);
 
-        Mp3MetadataEntry entry{};
-        readWavMetadata(job.path.c_str(), entry);
+    Mp3MetadataEntry cached;
+    if (metaCacheLookup(path, &cached))
+    {
+        trackSetMetadata(id, cached);
+        printf("[WAV] Cache hit: %s\n", path);
+        return true;
+    }
 
-        mutexLock(&g_wavMetaMutex);
-        if (job.localIndex < (int)g_wavPlaylistMeta.size())
-            g_wavPlaylistMeta[job.localIndex].meta = entry;
-        mutexUnlock(&g_wavMetaMutex);
+    scanPoolSubmit(id, SCAN_JOB_WAV, scanPoolToken());
 
-        wavAppendCache(job.path.c_str(), entry);
-    }
+    return true;
 }
 
+int wavGetPlaylistCount() { return g_wavTrackCount; }
+
+/* =======================================================
+   DECODER
+======================================================= */
+
 /* -------------------------------------------------------
-   Public metadata / playlist API
+   Format converters
+   One instantiation per (sample width, int/float, channel
+   layout). The load is inlined and, for mono and stereo,
+   the frame stride is a compile-time constant, so each loop
+   is a straight load/scale/store the compiler vectorises.
+   Layout 0 is the runtime-stride fallback for >2 channels
+   (the first two are played).
 ------------------------------------------------------- */
-bool wavIsFolderLoaded(const char* path)
+template <int Bits, bool IsFloat> struct WavSample;
+
+template <> struct WavSample<8, false>
+{   // WAV 8-bit is unsigned
+    static inline float load(const uint8_t* p) { return ((int)p[0] - 128) * (1.0f / 128.0f); }
+};
+template <> struct WavSample<16, false>
 {
-    return path && strcmp(g_wavLoadedFolder, path) == 0;
-}
+    static inline float load(const uint8_t* p) { int16_t v; memcpy(&v, p, 2); return v * (1.0f / 32768.0f); }
+};
+template <> struct WavSample<24, false>
+{
+    static inline float load(const uint8_t* p)
+    {
+        int32_t v = (int32_t)(p[0] | (p[1] << 8) | ((int8_t)p[2] << 16));
+        return v * (1.0f / 8388608.0f);
+    }
+};
+template <> struct WavSample<32, false>
+{
+    static inline float load(const uint8_t* p) { int32_t v; memcpy(&v, p, 4); return (float)v * (1.0f / 2147483648.0f); }
+};
+template <> struct WavSample<32, true>
+{
+    static inline float load(const uint8_t* p) { float v; memcpy(&v, p, 4); return v; }
+};
+template <> struct WavSample<64, true>
+{
+    static inline float load(const uint8_t* p) { double v; memcpy(&v, p, 8); return (float)v; }
+};
 
-void wavSetLoadedFolder(const char* path)
+template <int Bits, bool IsFloat, int Channels>
+static void wavConvert(const uint8_t* src, float* out, int frames, uint32_t stride)
 {
-    if (!path) return;
-    strncpy(g_wavLoadedFolder, path, sizeof(g_wavLoadedFolder) - 1);
-    g_wavLoadedFolder[sizeof(g_wavLoadedFolder)-1] = '\0';
+    constexpr uint32_t BYTES = Bits / 8;
+    constexpr uint32_t R_OFF = (Channels == 1) ? 0 : BYTES; // mono → L = R
+    const uint32_t step = Channels ? BYTES * Channels : stride;
+
+    for (int i = 0; i < frames; i++)
+    {
+        const uint8_t* p = src + (size_t)i * step;
+        out[i * 2]     = WavSample<Bits, IsFloat>::load(p);
+        out[i * 2 + 1] = WavSample<Bits, IsFloat>::load(p + R_OFF);
+    }
 }
 
-void wavCancelAllScans()
+template <int Bits, bool IsFloat>
+static WavConvertFn wavPickLayout(uint32_t channels)
 {
-    wavEnsureMutexInited();
-    mutexLock(&g_wavScanMutex);
-    g_wavScanQueue.clear();
-    g_wavScanQueued.clear();
-    g_wavScanGeneration++;
-    mutexUnlock(&g_wavScanMutex);
+    if (channels == 1) return wavConvert<Bits, IsFloat, 1>;
+    if (channels == 2) return wavConvert<Bits, IsFloat, 2>;
+    return wavConvert<Bits, IsFloat, 0>;
 }
 
-void wavStartBackgroundScanner()
+// nullptr → format not supported
+static WavConvertFn wavPickConverter(const WavDecoder* wd)
 {
-    wavEnsureMutexInited();
-    g_wavThreadRunning = true;
-    threadCreate(&g_wavThread, wavScanThread, nullptr, nullptr, 0x4000, 0x2B, -2);
-    threadStart(&g_wavThread);
+    if (wd->audioFormat == 3)
+    {
+        if (wd->bitsPerSample == 32) return wavPickLayout<32, true>(wd->channels);
+        if (wd->bitsPerSample == 64) return wavPickLayout<64, true>(wd->channels);
+        return nullptr;
+    }
+    switch (wd->bitsPerSample)
+    {
+        case 8:  return wavPickLayout<8,  false>(wd->channels);
+        case 16: return wavPickLayout<16, false>(wd->channels);
+        case 24: return wavPickLayout<24, false>(wd->channels);
+        case 32: return wavPickLayout<32, false>(wd->channels);
+        default: return nullptr;
+    }
 }
 
-void wavStopBackgroundScanner()
+/* -------------------------------------------------------
+   Streaming engine
+   Off-Switch the whole file is mmap'd and reads are just
+   pointer arithmetic. On Switch (no mmap in libnx) the data
+   chunk comes through the shared read-ahead service, staged
+   in WAV_STAGING_BYTES blocks that each hold a whole number
+   of frames.
+------------------------------------------------------- */
+#define WAV_STAGING_BYTES (64 * 1024)
+#define WAV_BLOCK_ALIGN   4096
+
+static bool wavEngineInit(WavDecoder* wd, const char* path)
 {
-    if (!g_wavThreadRunning) return;
-    g_wavThreadRunning = false;
-    threadWaitForExit(&g_wavThread);
-    threadClose(&g_wavThread);
+#ifndef __SWITCH__
+    struct stat st;
+    if (fstat(fileno(wd->file), &st) == 0 && st.st_size > 0)
+    {
+        void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                       fileno(wd->file), 0);
+        if (m != MAP_FAILED)
+        {
+            madvise(m, (size_t)st.st_size, MADV_SEQUENTIAL);
+            wd->map      = (const uint8_t*)m;
+            wd->mapBytes = (size_t)st.st_size;
+            return true;
+        }
+    }
+#endif
+    size_t frames  = WAV_STAGING_BYTES / wd->bytesPerFrame;
+    if (frames == 0) frames = 1;
+    wd->blockBytes = frames * wd->bytesPerFrame;
+
+    size_t alloc = (wd->blockBytes + WAV_BLOCK_ALIGN - 1) & ~(size_t)(WAV_BLOCK_ALIGN - 1);
+    wd->block = (uint8_t*)aligned_alloc(WAV_BLOCK_ALIGN, alloc);
+    if (!wd->block) return false;
+
+    wd->io = readAheadOpen(path);
+    if (!wd->io) return false;
+    return readAheadSeek(wd->io, (int64_t)wd->dataOffset, SEEK_SET);
 }
 
-void wavClearMetadata()
+static void wavEngineFree(WavDecoder* wd)
 {
-    wavEnsureMutexInited();
-    mutexLock(&g_wavMetaMutex);
-    g_wavPlaylistMeta.clear();
-    mutexUnlock(&g_wavMetaMutex);
+#ifndef __SWITCH__
+    if (wd->map) munmap((void*)wd->map, wd->mapBytes);
+#endif
+    wd->map = nullptr;
+    free(wd->block);
+    wd->block = nullptr;
+    readAheadClose(wd->io);
+    wd->io = nullptr;
 }
 
-bool wavAddToPlaylist(const char* path)
+// Point at up to `frames` contiguous source frames at the read position.
+// Returns how many are available there (0 = short file / read error).
+static size_t wavAcquire(WavDecoder* wd, size_t frames, const uint8_t** src)
 {
-    if (!path) return false;
-    wavEnsureMutexInited();
-    if (wavPlaylistHasPath(path)) return false;
-
-    playlistAdd(path);
-    int localIndex = (int)g_wavPlaylistMeta.size();
+    const uint32_t bpf = wd->bytesPerFrame;
 
-    Mp3MetadataEntry meta{};
-    strncpy(meta.title, "Scanning...", sizeof(meta.title) - 1);
-
-    RuntimeMetadata r{};
-    strncpy(r.path, path, sizeof(r.path) - 1);
-    r.path[sizeof(r.path)-1] = '\0';
-    r.meta = meta;
-    g_wavPlaylistMeta.push_back(r);
-
-    auto it = g_wavCache.find(path);
-    if (it != g_wavCache.end() && wavCacheValid(it->second))
+    if (wd->map)
     {
-        mutexLock(&g_wavMetaMutex);
-        g_wavPlaylistMeta[localIndex].meta = it->second.meta;
-        mutexUnlock(&g_wavMetaMutex);
-        printf("[WAV] Cache hit: %s\n", path);
-        return true;
+        *src = wd->map + wd->dataOffset + wd->samplesRead * bpf;
+        return frames; // caller clamps to totalSamples, which fits the map
     }
 
-    mutexLock(&g_wavScanMutex);
-    if (g_wavScanQueued.insert(path).second)
-        g_wavScanQueue.push_back({ path, localIndex, g_wavScanGeneration });
-    mutexUnlock(&g_wavScanMutex);
+    if (wd->blockPos >= wd->blockLen)
+    {
+        uint64_t left = (wd->totalSamples - wd->samplesRead) * bpf;
+        size_t   want = (size_t)std::min<uint64_t>(wd->blockBytes, left);
+        size_t   got  = readAheadRead(wd->io, wd->block, want);
 
-    return true;
-}
+        // Keep the stream position frame-aligned if the read came up short
+        size_t partial = got % bpf;
+        if (partial) readAheadSeek(wd->io, -(int64_t)partial, SEEK_CUR);
 
-const Mp3MetadataEntry* wavGetTrackMetadata(int globalIndex)
-{
-    if (globalIndex < 0 || globalIndex >= playlistGetCount()) return nullptr;
-    const char* path = playlistGetTrack(globalIndex);
-    if (!path) return nullptr;
-    for (auto& r : g_wavPlaylistMeta)
-        if (strcmp(r.path, path) == 0) return &r.meta;
-    return nullptr;
-}
+        wd->blockLen = got - partial;
+        wd->blockPos = 0;
+        if (wd->blockLen == 0) return 0;
+    }
 
-int wavGetPlaylistCount() { return (int)g_wavPlaylistMeta.size(); }
+    size_t avail = (wd->blockLen - wd->blockPos) / bpf;
+    size_t n     = std::min(frames, avail);
+    *src = wd->block + wd->blockPos;
+    wd->blockPos += n * bpf;
+    return n;
+}
 
-/* =======================================================
-   DECODER
-======================================================= */
+/* -------------------------------------------------------
+   Lifecycle
+------------------------------------------------------- */
 WavDecoder* wavOpen(const char* path)
 {
     FILE* f = fopen(path, "rb");
@@ -487,158 +499,109 @@ WavDecoder* wavOpen(const char* path)
         return nullptr;
     }
 
-    // Validate: only PCM (1) and IEEE float (3) supported
-    if (wd->audioFormat != 1 && wd->audioFormat != 3)
+    if (wd->channels == 0 || wd->sampleRate == 0 || wd->bitsPerSample == 0)
     {
-        printf("[WAV] Unsupported audio format: %u in %s\n", wd->audioFormat, path);
         fclose(f);
         delete wd;
         return nullptr;
     }
 
-    if (wd->channels == 0 || wd->sampleRate == 0 || wd->bitsPerSample == 0)
+    // Validate: PCM (1) 8/16/24/32-bit and IEEE float (3) 32/64-bit
+    wd->convert = (wd->audioFormat == 1 || wd->audioFormat == 3)
+                  ? wavPickConverter(wd) : nullptr;
+    if (!wd->convert)
     {
+        printf("[WAV] Unsupported audio format: %u (%u-bit) in %s\n",
+               wd->audioFormat, wd->bitsPerSample, path);
         fclose(f);
         delete wd;
         return nullptr;
     }
 
-    // Seek to start of audio data (parseWavHeader leaves us there already,
-    // but store the offset so wavSeek can jump back)
-    wd->dataOffset = ftell(f);
+    wd->bytesPerFrame = (wd->bitsPerSample / 8) * wd->channels;
 
+    if (!wavEngineInit(wd, path))
+    {
+        wavClose(wd);
+        return nullptr;
+    }
+
+    // Only the header parser needed stdio (a mapping outlives its fd)
+    fclose(wd->file);
+    wd->file = nullptr;
     return wd;
 }
 
 void wavClose(WavDecoder* wd)
 {
     if (!wd) return;
+    wavEngineFree(wd);
     if (wd->file) fclose(wd->file);
     delete wd;
 }
 
 /* -------------------------------------------------------
-   Convert one source frame to stereo int16_t output.
-   src points to the start of one interleaved PCM frame
-   in the native format. Returns two samples: [left, right].
+   Decoding
 ------------------------------------------------------- */
-static void convertFrame(const uint8_t* src,
-                         uint32_t channels,
-                         uint32_t bitsPerSample,
-                         uint32_t audioFormat,
-                         int16_t& outL, int16_t& outR)
-{
-    auto sampleToI16 = [&](const uint8_t* p) -> int16_t
-    {
-        if (audioFormat == 3 && bitsPerSample == 32)
-        {
-            // IEEE float 32-bit
-            float v;
-            memcpy(&v, p, 4);
-            if (v >  1.0f) v =  1.0f;
-            if (v < -1.0f) v = -1.0f;
-            return (int16_t)(v * 32767.0f);
-        }
-        switch (bitsPerSample)
-        {
-            case 8:  // WAV 8-bit is unsigned
-                return (int16_t)((int)(p[0]) - 128) << 8;
-            case 16:
-                return (int16_t)(p[0] | (p[1] << 8));
-            case 24:
-            {
-                int32_t v = (int32_t)(p[0] | (p[1] << 8) | ((int8_t)p[2] << 16));
-                return (int16_t)(v >> 8);
-            }
-            case 32:
-            {
-                int32_t v;
-                memcpy(&v, p, 4);
-                return (int16_t)(v >> 16);
-            }
-            default:
-                return 0;
-        }
-    };
-
-    uint32_t bytesPerSample = bitsPerSample / 8;
-    outL = sampleToI16(src);
-    outR = (channels > 1) ? sampleToI16(src + bytesPerSample) : outL;
-}
-
 WavReadResult wavRead(WavDecoder* wd,
                       unsigned char* buffer,
                       size_t         bufBytes,
                       size_t*        bytesRead)
 {
     *bytesRead = 0;
-    if (!wd || !wd->file || wd->eof) return WAV_READ_DONE;
+    if (!wd || (!wd->map && !wd->io) || wd->eof) return WAV_READ_DONE;
 
-    // How many output stereo int16 frames fit in buffer?
-    int outFramesMax  = (int)(bufBytes / (sizeof(int16_t) * 2));
+    // How many output stereo float frames fit in buffer?
+    size_t outFramesMax = bufBytes / (sizeof(float) * 2);
     if (outFramesMax == 0) return WAV_READ_OK;
 
-    uint32_t srcBytesPerFrame = (wd->bitsPerSample / 8) * wd->channels;
-    if (srcBytesPerFrame == 0) return WAV_READ_ERR;
-
-    // How many source frames are left in the data chunk?
-    uint64_t framesLeft = (wd->totalSamples > wd->samplesRead)
-                          ? (wd->totalSamples - wd->samplesRead) : 0;
-    int framesToRead = (int)std::min((uint64_t)outFramesMax, framesLeft);
-
-    if (framesToRead == 0)
-    {
-        wd->eof = true;
-        return WAV_READ_DONE;
-    }
-
-    // Read raw source bytes
-    std::vector<uint8_t> srcBuf((size_t)framesToRead * srcBytesPerFrame);
-    size_t got = fread(srcBuf.data(), 1, srcBuf.size(), wd->file);
-    int framesGot = (int)(got / srcBytesPerFrame);
+    float* out  = (float*)buffer;
+    size_t done = 0;
 
-    if (framesGot == 0)
+    while (done < outFramesMax && wd->samplesRead < wd->totalSamples)
     {
-        wd->eof = true;
-        return WAV_READ_DONE;
-    }
+        size_t want = (size_t)std::min<uint64_t>(outFramesMax - done,
+                                                 wd->totalSamples - wd->samplesRead);
+        const uint8_t* src = nullptr;
+        size_t got = wavAcquire(wd, want, &src);
+        if (got == 0)
+        {
+            // File shorter than its header claims — end here
+            wd->totalSamples = wd->samplesRead;
+            break;
+        }
 
-    // Convert to stereo int16_t in output buffer
-    int16_t* out = (int16_t*)buffer;
-    for (int i = 0; i < framesGot; i++)
-    {
-        int16_t l, r;
-        convertFrame(srcBuf.data() + i * srcBytesPerFrame,
-                     wd->channels, wd->bitsPerSample, wd->audioFormat,
-                     l, r);
-        out[i * 2]     = l;
-        out[i * 2 + 1] = r;
+        wd->convert(src, out + done * 2, (int)got, wd->bytesPerFrame);
+        done            += got;
+        wd->samplesRead += got;
     }
 
-    wd->samplesRead += framesGot;
-    *bytesRead = (size_t)(framesGot * sizeof(int16_t) * 2);
+    *bytesRead = done * sizeof(float) * 2;
 
     if (wd->samplesRead >= wd->totalSamples)
-    {
         wd->eof = true;
-        return WAV_READ_DONE;
-    }
 
+    if (done == 0 && wd->eof) return WAV_READ_DONE;
     return WAV_READ_OK;
 }
 
+/* -------------------------------------------------------
+   Seeking
+------------------------------------------------------- */
 bool wavSeek(WavDecoder* wd, uint64_t targetSample)
 {
-    if (!wd || !wd->file) return false;
-
-    uint32_t bytesPerFrame = (wd->bitsPerSample / 8) * wd->channels;
-    if (bytesPerFrame == 0) return false;
+    if (!wd || (!wd->map && !wd->io) || wd->bytesPerFrame == 0) return false;
 
     if (targetSample > wd->totalSamples)
         targetSample = wd->totalSamples;
 
-    long offset = wd->dataOffset + (long)(targetSample * bytesPerFrame);
-    if (fseek(wd->file, offset, SEEK_SET) != 0) return false;
+    if (!wd->map)
+    {
+        uint64_t offset = wd->dataOffset + targetSample * wd->bytesPerFrame;
+        if (!readAheadSeek(wd->io, (int64_t)offset, SEEK_SET)) return false;
+        wd->blockLen = 0; // read-ahead block is stale
+        wd->blockPos = 0;
+    }
 
     wd->samplesRead = targetSample;
     wd->eof         = (targetSample >= wd->totalSamples);
@@ -4,13 +4,18 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "readahead.h"
 
 /* -------------------------------------------------------
    WAV decoder handle
    Parses the RIFF/WAV header and streams raw PCM data,
-   converting 8/16/24/32-bit mono/stereo to int16_t stereo.
+   converting 8/16/24/32-bit int and 32/64-bit float PCM
+   (mono, stereo or multichannel) to float32 stereo.
    No library needed — WAV is uncompressed raw PCM.
 ------------------------------------------------------- */
+// Converts `frames` source frames (`stride` bytes apart) to float32 stereo
+typedef void (*WavConvertFn)(const uint8_t* src, float* out, int frames, uint32_t stride);
+
 struct WavDecoder
 {
     FILE*    file         = nullptr;
@@ -20,9 +25,21 @@ struct WavDecoder
     uint32_t audioFormat  = 0;  // 1 = PCM, 3 = IEEE float
     uint64_t totalSamples = 0;  // PCM frames
     uint64_t samplesRead  = 0;
-    long     dataOffset   = 0;  // file offset to first audio byte
-    uint32_t dataBytes    = 0;  // total bytes in data chunk
+    uint64_t dataOffset   = 0;  // file offset to first audio byte
+    uint64_t dataBytes    = 0;  // total bytes in data chunk (RF64: from ds64)
     bool     eof          = false;
+
+    // Streaming engine — either the whole file is mapped, or data is
+    // pulled from the read-ahead service into a staging block (wav.cpp)
+    WavConvertFn   convert       = nullptr;
+    uint32_t       bytesPerFrame = 0;
+    const uint8_t* map           = nullptr;
+    size_t         mapBytes      = 0;
+    ReadAheadStream* io          = nullptr;
+    uint8_t*       block         = nullptr;
+    size_t         blockBytes    = 0;   // capacity, whole frames
+    size_t         blockLen      = 0;   // valid bytes
+    size_t         blockPos      = 0;   // consumed bytes
 };
 
 /* -------------------------------------------------------
@@ -51,14 +68,10 @@ bool wavSeek(WavDecoder* wd, uint64_t targetSample);
 ------------------------------------------------------- */
 bool wavIsFolderLoaded(const char* path);
 void wavSetLoadedFolder(const char* path);
-void wavCancelAllScans();
 
-void wavStartBackgroundScanner();
-void wavStopBackgroundScanner();
+// Scanning runs on the shared scanner pool (scanpool.h)
 
 bool wavAddToPlaylist(const char* path);
 void wavClearMetadata();
-void wavLoadCache(const char* folderKey);
 
-const Mp3MetadataEntry* wavGetTrackMetadata(int globalIndex);
-int                     wavGetPlaylistCount();
+int wavGetPlaylistCount();   // per-track metadata: playlistGetMetadata()
@@ -0,0 +1,177 @@
+#include "biquad.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC 1
+#endif
+
+/* -------------------------------------------------------
+   BiquadBank::processBlock against the scalar cascade the
+   EQ used before (one Biquad per band and channel, run
+   sample by sample). All ten bands are boosted or cut so
+   neither path can skip a flat band. Checks both produce
+   the same output, then reports the best of several runs
+   in ns per stereo frame (and TSC cycles on x86).
+------------------------------------------------------- */
+#define BENCH_RATE    48000.0f
+#define BENCH_Q       1.0f
+#define BENCH_BLOCK   1024       // stereo frames per call, as the decoder hands them over
+#define BENCH_BLOCKS  2048
+#define BENCH_RUNS    5
+
+static const float kFreq[BiquadBank::MAX_BANDS] =
+    { 60, 170, 310, 600, 1000, 3000, 6000, 12000, 14000, 16000 };
+static const float kGain[BiquadBank::MAX_BANDS] =
+    { 6, 4, -3, 2, -5, 3, 1.5f, -2, 4, -6 };
+
+struct Timing
+{
+    double ns;
+    double cycles;
+};
+
+static uint64_t cycleCount()
+{
+#if defined(BENCH_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void fillNoise(std::vector<float>& v)
+{
+    uint32_t s = 0x2545f491u;
+    for (float& x : v)
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        x = (s & 0xffff) / 65535.0f - 0.5f;
+    }
+}
+
+/* -------------------------------------------------------
+   Scalar reference
+------------------------------------------------------- */
+struct ScalarEq
+{
+    Biquad left[BiquadBank::MAX_BANDS];
+    Biquad right[BiquadBank::MAX_BANDS];
+
+    void setup()
+    {
+        for (int b = 0; b < BiquadBank::MAX_BANDS; b++)
+        {
+            left[b].setupPeaking(BENCH_RATE, kFreq[b], BENCH_Q, kGain[b]);
+            right[b].setupPeaking(BENCH_RATE, kFreq[b], BENCH_Q, kGain[b]);
+        }
+    }
+
+    void process(float* s, int frames)
+    {
+        for (int f = 0; f < frames; f++)
+        {
+            float l = s[f * 2];
+            float r = s[f * 2 + 1];
+            for (int b = 0; b < BiquadBank::MAX_BANDS; b++)
+            {
+                l = left[b].process(l);
+                r = right[b].process(r);
+            }
+            s[f * 2]     = l;
+            s[f * 2 + 1] = r;
+        }
+    }
+};
+
+static void setupBank(BiquadBank& bank)
+{
+    for (int b = 0; b < BiquadBank::MAX_BANDS; b++)
+        bank.setBand(b, BENCH_RATE, kFreq[b], BENCH_Q, kGain[b]);
+    bank.repack();
+}
+
+/* -------------------------------------------------------
+   Timing
+------------------------------------------------------- */
+template <typename Fn>
+static Timing timeBest(const std::vector<float>& input, Fn process)
+{
+    std::vector<float> buf(input.size());
+    Timing best = { 1e30, 1e30 };
+    const double frames = (double)BENCH_BLOCK * BENCH_BLOCKS;
+
+    for (int run = 0; run < BENCH_RUNS; run++)
+    {
+        buf = input;
+        auto     t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = cycleCount();
+
+        for (int i = 0; i < BENCH_BLOCKS; i++)
+            process(buf.data() + (size_t)i * BENCH_BLOCK * 2, BENCH_BLOCK);
+
+        uint64_t c1 = cycleCount();
+        double   ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+
+        if (ns / frames < best.ns)
+            best = { ns / frames, (c1 - c0) / frames };
+    }
+    return best;
+}
+
+int main()
+{
+    std::vector<float> input((size_t)BENCH_BLOCK * BENCH_BLOCKS * 2);
+    fillNoise(input);
+
+    // Same output first
+    {
+        ScalarEq   ref;
+        BiquadBank bank;
+        ref.setup();
+        setupBank(bank);
+
+        std::vector<float> a = input, b = input;
+        for (int i = 0; i < BENCH_BLOCKS; i++)
+        {
+            ref.process(a.data() + (size_t)i * BENCH_BLOCK * 2, BENCH_BLOCK);
+            bank.processBlock(b.data() + (size_t)i * BENCH_BLOCK * 2, BENCH_BLOCK);
+        }
+
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < a.size(); i++)
+            maxDiff = fmaxf(maxDiff, fabsf(a[i] - b[i]));
+
+        if (maxDiff > 1e-4f)
+        {
+            printf("[EQ] FAIL: bank differs from the scalar cascade by %g\n", maxDiff);
+            return 1;
+        }
+        printf("[EQ] bank matches scalar cascade (max diff %g)\n", maxDiff);
+    }
+
+    ScalarEq ref;
+    ref.setup();
+    Timing scalar = timeBest(input, [&](float* s, int n) { ref.process(s, n); });
+
+    BiquadBank bank;
+    setupBank(bank);
+    Timing simd = timeBest(input, [&](float* s, int n) { bank.processBlock(s, n); });
+
+    printf("[EQ] 10 bands, %d-frame blocks: scalar %.2f ns/frame", BENCH_BLOCK, scalar.ns);
+#if defined(BENCH_TSC)
+    printf(" (%.1f cycles)", scalar.cycles);
+#endif
+    printf(", bank %.2f ns/frame", simd.ns);
+#if defined(BENCH_TSC)
+    printf(" (%.1f cycles)", simd.cycles);
+#endif
+    printf(", %.2fx\n", scalar.ns / simd.ns);
+    return 0;
+}
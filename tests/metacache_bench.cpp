@@ -0,0 +1,146 @@
+#include "metacache.h"
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+
+/* -------------------------------------------------------
+   Load and append cost of the metadata journal at 50k
+   entries. Works in a scratch directory with a local
+   "sdmc:" folder, so the journal lands at the same
+   relative path it has on the console.
+
+   The first run puts one entry per track (batched appends
+   as in a folder scan) and flushes, then runs itself again
+   as "load", which loads the journal cold and looks every
+   track up.
+------------------------------------------------------- */
+#define BENCH_TRACKS  50000
+#define BENCH_DIR     "metacache_bench_data"
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static void trackPath(char* out, size_t size, int i)
+{
+    snprintf(out, size, "tracks/%02d/track %05d.mp3", i % 100, i);
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*)
+{
+    return remove(path);
+}
+
+static long fileSize(const char* path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static int loadPhase()
+{
+    auto t0 = Clock::now();
+    metaCacheLoad();
+    double loadMs = msSince(t0);
+
+    char path[64];
+    int  hits = 0;
+    t0 = Clock::now();
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        trackPath(path, sizeof(path), i);
+        Mp3MetadataEntry m;
+        if (metaCacheLookup(path, &m) && m.durationSeconds == i)
+            hits++;
+    }
+    double lookupMs = msSince(t0);
+
+    if (hits != BENCH_TRACKS)
+    {
+        printf("[CACHE] FAIL: %d of %d entries found after reload\n", hits, BENCH_TRACKS);
+        return 1;
+    }
+    printf("[CACHE] cold load %.1f ms (%.0f KB journal), %d lookups %.1f ms (%.2f us each, stat included)\n",
+           loadMs, fileSize(METACACHE_PATH) / 1024.0, BENCH_TRACKS, lookupMs,
+           lookupMs * 1000.0 / BENCH_TRACKS);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    // The cache loads once per process, so the load is timed in a new one
+    if (argc > 1 && strcmp(argv[1], "load") == 0)
+        return loadPhase();
+
+    char self[PATH_MAX];
+    if (!realpath(argv[0], self))
+    {
+        printf("[CACHE] FAIL: can't resolve %s\n", argv[0]);
+        return 1;
+    }
+
+    nftw(BENCH_DIR, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    if (mkdir(BENCH_DIR, 0777) != 0 || chdir(BENCH_DIR) != 0)
+    {
+        printf("[CACHE] FAIL: can't create %s\n", BENCH_DIR);
+        return 1;
+    }
+    mkdir("sdmc:", 0777);
+    mkdir("tracks", 0777);
+
+    char path[64];
+    for (int d = 0; d < 100; d++)
+    {
+        snprintf(path, sizeof(path), "tracks/%02d", d);
+        mkdir(path, 0777);
+    }
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        trackPath(path, sizeof(path), i);
+        int fd = open(path, O_CREAT | O_WRONLY, 0666);
+        if (fd >= 0) close(fd);
+    }
+
+    metaCacheLoad();
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        trackPath(path, sizeof(path), i);
+        Mp3MetadataEntry m{};
+        snprintf(m.title,  sizeof(m.title),  "Track %d", i);
+        snprintf(m.artist, sizeof(m.artist), "Artist %d", i / 500);
+        m.durationSeconds = i;
+        metaCachePut(path, m);
+    }
+    metaCacheFlush();
+    double putMs = msSince(t0);
+
+    printf("[CACHE] %d puts + flushes %.1f ms (%.2f us each, stat and fsync included)\n",
+           BENCH_TRACKS, putMs, putMs * 1000.0 / BENCH_TRACKS);
+    fflush(stdout);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execl(self, self, "load", (char*)nullptr);
+        _exit(127);
+    }
+
+    int status = 1;
+    if (pid > 0) waitpid(pid, &status, 0);
+
+    if (chdir("..") == 0)
+        nftw(BENCH_DIR, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
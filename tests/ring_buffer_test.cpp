@@ -0,0 +1,160 @@
+#include "ring_buffer.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+/* -------------------------------------------------------
+   Two-thread stress test and throughput loop for
+   RingBuffer. The producer writes a running counter in
+   chunks of varying size, the consumer reads (or peeks and
+   skips) chunks of other sizes and checks every value
+   arrives once and in order. The buffer is kept small so
+   both memcpy spans and the wrap are hit constantly.
+------------------------------------------------------- */
+#define STRESS_ELEMENTS  3000000u
+#define STRESS_CAPACITY  1000        // rounds up to 1024
+#define STRESS_MAX_CHUNK 700
+
+#define BENCH_SAMPLES    (64u * 1024 * 1024)
+#define BENCH_CAPACITY   (16 * 1024)
+#define BENCH_CHUNK      1024        // stereo frames of a typical decode block
+
+// xorshift32, so both threads get cheap, reproducible chunk sizes
+static uint32_t nextRand(uint32_t& s)
+{
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+/* -------------------------------------------------------
+   Stress
+------------------------------------------------------- */
+static bool stressTest()
+{
+    RingBuffer<uint32_t> rb;
+    if (!rb.init(STRESS_CAPACITY))
+    {
+        printf("[RING] init failed\n");
+        return false;
+    }
+
+    std::atomic<bool> failed{false};
+
+    std::thread producer([&]()
+    {
+        uint32_t seed = 0x12345678u;
+        uint32_t chunk[STRESS_MAX_CHUNK];
+        uint32_t next = 0;
+
+        while (next < STRESS_ELEMENTS && !failed.load(std::memory_order_relaxed))
+        {
+            uint32_t want = 1 + nextRand(seed) % STRESS_MAX_CHUNK;
+            if (want > STRESS_ELEMENTS - next) want = STRESS_ELEMENTS - next;
+            for (uint32_t i = 0; i < want; i++)
+                chunk[i] = next + i;
+
+            size_t n = rb.write(chunk, want);
+            if (n == 0) std::this_thread::yield();
+            next += (uint32_t)n;
+        }
+    });
+
+    uint32_t seed     = 0x9e3779b9u;
+    uint32_t expected = 0;
+    uint32_t chunk[STRESS_MAX_CHUNK];
+
+    while (expected < STRESS_ELEMENTS)
+    {
+        uint32_t want = 1 + nextRand(seed) % STRESS_MAX_CHUNK;
+        bool     peek = (nextRand(seed) & 3) == 0;
+
+        size_t n = peek ? rb.peek(chunk, want) : rb.read(chunk, want);
+        if (n == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            if (chunk[i] != expected + i)
+            {
+                printf("[RING] FAIL: element %u is %u\n", (unsigned)(expected + i), chunk[i]);
+                failed = true;
+                break;
+            }
+        }
+        if (failed) break;
+
+        if (peek && rb.skip(n) != n)
+        {
+            printf("[RING] FAIL: skip after peek dropped less than was peeked\n");
+            failed = true;
+            break;
+        }
+        expected += (uint32_t)n;
+    }
+
+    producer.join();
+
+    if (!failed && rb.availableRead() != 0)
+    {
+        printf("[RING] FAIL: %zu elements left over\n", rb.availableRead());
+        failed = true;
+    }
+
+    if (!failed)
+        printf("[RING] stress: %u elements through %zu slots, in order\n",
+               STRESS_ELEMENTS, rb.capacity());
+    return !failed;
+}
+
+/* -------------------------------------------------------
+   Throughput
+------------------------------------------------------- */
+static void throughput()
+{
+    RingBuffer<float> rb(BENCH_CAPACITY);
+    std::vector<float> src(BENCH_CHUNK, 0.5f);
+    std::vector<float> dst(BENCH_CHUNK);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&]()
+    {
+        size_t sent = 0;
+        while (sent < BENCH_SAMPLES)
+        {
+            size_t n = rb.write(src.data(), std::min<size_t>(BENCH_CHUNK, BENCH_SAMPLES - sent));
+            if (n == 0) std::this_thread::yield();
+            sent += n;
+        }
+    });
+
+    size_t got = 0;
+    while (got < BENCH_SAMPLES)
+    {
+        size_t n = rb.read(dst.data(), BENCH_CHUNK);
+        if (n == 0) std::this_thread::yield();
+        got += n;
+    }
+    producer.join();
+
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("[RING] throughput: %u floats in %zu-float chunks, %.1f Mfloat/s (%.0f MB/s)\n",
+           BENCH_SAMPLES, (size_t)BENCH_CHUNK, BENCH_SAMPLES / sec / 1e6,
+           BENCH_SAMPLES * sizeof(float) / sec / 1e6);
+}
+
+int main()
+{
+    if (!stressTest())
+        return 1;
+    throughput();
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include "spectrum.h"
+#include "kiss_fftr.h"
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+/* -------------------------------------------------------
+   The spectrum engine against the routine it replaced
+   (copied below from the old ui.cpp computeSpectrum, with
+   the FFT size made a parameter): no window, a scalar
+   magnitude loop, and both bin edges of every bar worked
+   out with powf on every frame. Both run the same input at
+   each FFT size from 512 to 8192 and report the best of
+   several runs in us per frame,
+   with the bare FFT's share alongside so the rest of the
+   work can be compared on its own.
+------------------------------------------------------- */
+#define BENCH_RATE   48000
+#define BENCH_BARS   20
+#define BENCH_FRAMES 2000
+#define BENCH_RUNS   5
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile float g_sink;   // keeps the results alive
+
+/* -------------------------------------------------------
+   Old routine
+------------------------------------------------------- */
+struct OldSpectrum
+{
+    int                       fftSize;
+    kiss_fftr_cfg             cfg;
+    std::vector<kiss_fft_cpx> fftOut;
+    std::vector<float>        fftMag;
+    float                     bandSmooth[BENCH_BARS] = {};
+    float                     autoGain = 1.0f;
+
+    explicit OldSpectrum(int n)
+        : fftSize(n), cfg(kiss_fftr_alloc(n, 0, nullptr, nullptr)),
+          fftOut(n / 2 + 1), fftMag(n / 2) {}
+    ~OldSpectrum() { kiss_fftr_free(cfg); }
+
+    void run(const float* input, float* bandValues)
+    {
+        kiss_fftr(cfg, input, fftOut.data());
+
+        for (int i = 0; i < fftSize / 2; i++)
+        {
+            float real = fftOut[i].r;
+            float imag = fftOut[i].i;
+
+            fftMag[i] = sqrtf(real * real + imag * imag);
+        }
+
+        const float SMOOTHING = 0.18f;
+
+        const float sampleRate = (float)BENCH_RATE;
+        const float minFreq = 20.0f;
+        const float maxFreq = sampleRate / 2.0f;
+
+        for (int b = 0; b < BENCH_BARS; b++)
+        {
+            float t0 = (float)b / BENCH_BARS;
+            float t1 = (float)(b + 1) / BENCH_BARS;
+
+            float f0 = minFreq * powf(maxFreq / minFreq, t0);
+            float f1 = minFreq * powf(maxFreq / minFreq, t1);
+
+            int bin0 = (int)(f0 * fftSize / sampleRate);
+            int bin1 = (int)(f1 * fftSize / sampleRate);
+
+            if (bin0 < 0) bin0 = 0;
+            if (bin1 >= fftSize / 2) bin1 = fftSize / 2 - 1;
+            if (bin1 <= bin0) bin1 = bin0 + 1;
+
+            float sum = 0.0f;
+            int count = 0;
+
+            for (int i = bin0; i <= bin1; i++)
+            {
+                sum += fftMag[i];
+                count++;
+            }
+
+            float avg = (count > 0) ? sum / count : 0.0f;
+
+            avg = log10f(avg + 1.0f) * 0.9f;
+
+            if (avg > autoGain)
+                autoGain = avg;
+            else
+                autoGain *= 0.995f;
+
+            avg /= (autoGain + 0.0001f);
+
+            if (avg > 1.0f) avg = 1.0f;
+            if (avg < 0.0f) avg = 0.0f;
+
+            float bassBoost = 1.0f + (float)(BENCH_BARS - b) / BENCH_BARS;
+            avg *= bassBoost * 0.9f;
+
+            if (avg > 1.0f) avg = 1.0f;
+
+            bandSmooth[b] += (avg - bandSmooth[b]) * SMOOTHING;
+
+            bandValues[b] = bandSmooth[b];
+        }
+    }
+};
+
+/* -------------------------------------------------------
+   Bench
+------------------------------------------------------- */
+template <typename Fn>
+static double usPerFrame(const std::vector<float>& signal, int n, Fn run)
+{
+    const int hop = BENCH_RATE / 60;   // one rendered frame of audio
+    float bars[BENCH_BARS];
+
+    double best = 1e30;
+    for (int r = 0; r < BENCH_RUNS; r++)
+    {
+        auto t0 = Clock::now();
+        for (int f = 0; f < BENCH_FRAMES; f++)
+        {
+            size_t start = ((size_t)f * hop) % (signal.size() - n);
+            run(signal.data() + start, bars);
+        }
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        if (us < best) best = us;
+    }
+
+    g_sink = bars[0];
+    return best / BENCH_FRAMES;
+}
+
+int main()
+{
+    // A few seconds of two tones over low noise, mono
+    std::vector<float> signal(BENCH_RATE * 4);
+    uint32_t s = 1;
+    for (size_t i = 0; i < signal.size(); i++)
+    {
+        s = s * 1664525u + 1013904223u;
+        float noise = ((s >> 9) / 8388608.0f - 1.0f) * 0.02f;
+        signal[i] = 0.4f * sinf(2.0f * (float)M_PI * 110.0f  * i / BENCH_RATE) +
+                    0.2f * sinf(2.0f * (float)M_PI * 3520.0f * i / BENCH_RATE) + noise;
+    }
+
+    for (int n = SPECTRUM_FFT_MIN; n <= SPECTRUM_FFT_MAX; n <<= 1)
+    {
+        kiss_fftr_cfg             cfg = kiss_fftr_alloc(n, 0, nullptr, nullptr);
+        std::vector<kiss_fft_cpx> out(n / 2 + 1);
+        double fftUs = usPerFrame(signal, n, [&](const float* in, float* bars)
+        {
+            kiss_fftr(cfg, in, out.data());
+            bars[0] = out[1].r;
+        });
+        kiss_fftr_free(cfg);
+
+        OldSpectrum old(n);
+        double oldUs = usPerFrame(signal, n, [&](const float* in, float* bars) { old.run(in, bars); });
+
+        spectrumEngineConfigure(BENCH_RATE, n, BENCH_BARS, SPECTRUM_WINDOW_HANN);
+        double newUs = usPerFrame(signal, n, [&](const float* in, float* bars) { spectrumEngineRun(in, bars, 1); });
+
+        printf("[SPECTRUM] %4d-point, %d bars: old %.2f us/frame, engine %.2f us/frame (%.2fx); "
+               "FFT alone %.2f, rest %.2f -> %.2f us\n",
+               n, BENCH_BARS, oldUs, newUs, oldUs / newUs, fftUs, oldUs - fftUs, newUs - fftUs);
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+/* -------------------------------------------------------
+   Just enough of libnx for the host tests: integer types,
+   Mutex and the 19.2 MHz system tick.
+------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+
+typedef pthread_mutex_t Mutex;
+
+static inline void mutexInit(Mutex* m)   { pthread_mutex_init(m, nullptr); }
+static inline void mutexLock(Mutex* m)   { pthread_mutex_lock(m); }
+static inline void mutexUnlock(Mutex* m) { pthread_mutex_unlock(m); }
+
+static inline u64 svcGetSystemTick(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 19200000ULL + (u64)ts.tv_nsec * 192ULL / 10000ULL;
+}
@@ -0,0 +1,144 @@
+#include "tracktable.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* -------------------------------------------------------
+   Imports 50k tracks into the track table the way
+   playlistAdd does (intern, then a per-ID duplicate flag),
+   imports them all again as duplicates, then times one
+   rendered frame's lookups while scrolling through the
+   list: path and metadata for each visible playlist row
+   plus the now-playing line.
+
+   For scale, the same frame is timed against the lookup it
+   replaced: a strcmp walk through a vector of
+   path + metadata records.
+------------------------------------------------------- */
+#define BENCH_TRACKS       50000
+#define BENCH_VISIBLE_ROWS 4        // playlist.cpp MAX_VISIBLE_TRACKS
+#define BENCH_FRAMES       200000
+#define BENCH_OLD_FRAMES   500
+
+typedef std::chrono::steady_clock Clock;
+
+static volatile size_t g_sink;   // keeps the lookups from being optimised out
+
+static double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static void makePath(char* out, size_t size, int i)
+{
+    snprintf(out, size, "sdmc:/music/Artist %03d/Album %02d/%02d - Track number %d.mp3",
+             i / 500, (i / 20) % 25, i % 20, i);
+}
+
+struct OldEntry
+{
+    std::string      path;
+    Mp3MetadataEntry meta;
+};
+
+static const Mp3MetadataEntry* oldLookup(const std::vector<OldEntry>& list, const char* path)
+{
+    for (const OldEntry& e : list)
+        if (strcmp(e.path.c_str(), path) == 0)
+            return &e.meta;
+    return nullptr;
+}
+
+int main()
+{
+    std::vector<TrackId> playlist;
+    std::vector<uint8_t> inPlaylist;
+    char path[256];
+
+    // Import
+    auto t0 = Clock::now();
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        makePath(path, sizeof(path), i);
+        TrackId id = trackIntern(path);
+        if (id >= inPlaylist.size()) inPlaylist.resize(id + 1024, 0);
+        if (inPlaylist[id]) continue;
+        inPlaylist[id] = 1;
+        playlist.push_back(id);
+    }
+    double importMs = msSince(t0);
+
+    // Same folder again: every path is a duplicate
+    t0 = Clock::now();
+    int dupes = 0;
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        makePath(path, sizeof(path), i);
+        TrackId id = trackIntern(path);
+        if (id < inPlaylist.size() && inPlaylist[id]) dupes++;
+    }
+    double reimportMs = msSince(t0);
+
+    if ((int)playlist.size() != BENCH_TRACKS || dupes != BENCH_TRACKS || trackCount() != BENCH_TRACKS)
+    {
+        printf("[TRACKS] FAIL: %zu in playlist, %d duplicates, %d in table\n",
+               playlist.size(), dupes, trackCount());
+        return 1;
+    }
+
+    for (int i = 0; i < BENCH_TRACKS; i++)
+    {
+        Mp3MetadataEntry m{};
+        snprintf(m.title, sizeof(m.title), "Track %d", i);
+        m.durationSeconds = 180 + i % 120;
+        trackSetMetadata(playlist[i], m);
+    }
+
+    // One frame: visible rows + now playing, scrolling a row per frame
+    size_t sink    = 0;
+    int    playing = BENCH_TRACKS / 2;
+    t0 = Clock::now();
+    for (int f = 0; f < BENCH_FRAMES; f++)
+    {
+        int scroll = (int)(((unsigned)f * 7919u) % (BENCH_TRACKS - BENCH_VISIBLE_ROWS));
+        for (int r = 0; r < BENCH_VISIBLE_ROWS; r++)
+        {
+            TrackId id = playlist[scroll + r];
+            const char*             p  = trackGetPath(id);
+            const Mp3MetadataEntry* md = trackGetMetadata(id);
+            sink += (size_t)p[0] + (size_t)md->durationSeconds;
+        }
+        sink += (size_t)trackGetMetadata(playlist[playing])->durationSeconds;
+    }
+    double frameUs = msSince(t0) * 1000.0 / BENCH_FRAMES;
+
+    // The old per-format vector, searched by path
+    std::vector<OldEntry> old;
+    old.reserve(BENCH_TRACKS);
+    for (int i = 0; i < BENCH_TRACKS; i++)
+        old.push_back({ trackGetPath(playlist[i]), *trackGetMetadata(playlist[i]) });
+
+    t0 = Clock::now();
+    for (int f = 0; f < BENCH_OLD_FRAMES; f++)
+    {
+        int scroll = (int)(((unsigned)f * 7919u) % (BENCH_TRACKS - BENCH_VISIBLE_ROWS));
+        for (int r = 0; r < BENCH_VISIBLE_ROWS; r++)
+        {
+            const Mp3MetadataEntry* md = oldLookup(old, old[scroll + r].path.c_str());
+            sink += md ? (size_t)md->durationSeconds : 0;
+        }
+        const Mp3MetadataEntry* md = oldLookup(old, old[playing].path.c_str());
+        sink += md ? (size_t)md->durationSeconds : 0;
+    }
+    double oldFrameUs = msSince(t0) * 1000.0 / BENCH_OLD_FRAMES;
+
+    g_sink = sink;
+
+    printf("[TRACKS] %d tracks: import %.1f ms, re-import (all duplicates) %.1f ms\n",
+           BENCH_TRACKS, importMs, reimportMs);
+    printf("[TRACKS] frame lookups (%d rows + now playing): %.3f us, linear scan was %.1f us\n",
+           BENCH_VISIBLE_ROWS, frameUs, oldFrameUs);
+    return 0;
+}